@@ -42,6 +42,25 @@
 //          Added Modbus status to JSON string
 // 20250802 Fixed MQTT status message topic and disconnect timing
 // 20260223 Added support for Seeed Studio XIAO ESP32S3 & Wio-SX1262
+// 20261017 Replaced bit-serial digest by table-driven lfsr_digest16<gen, key>()
+//          Replaced de-whitening and digest check by in-place FrameCodec::decode()
+//          RX_TIMEOUT and TRANSMITTER_ID can be overridden (e.g. by host build)
+//          Added trace points (see ENABLE_TRACE in growatt_cfg.h)
+//          Replaced verbose hex dump in getMessage() by log_message()
+//          Added timing telemetry (port 3) published to MQTT topic "timing"
+//          Transmitter ID reduced to 24 bits (header byte 2 is the port)
+//          Added heap/stack diagnostics published to MQTT topics "diag" (receiver)
+//          and "diag/transmitter" (port 4)
+//          Added data of multiple inverters (frame index > 0) published to MQTT topic "data/<index>"
+//          Added family specific data (port 2), merged into the inverter's data
+//          Added inverter settings (port 5) published to MQTT topic "config" (retained)
+//          Added port 1 payload format v2 (scaled integers, see PAYLOAD_FORMAT in growatt_cfg.h)
+//          Added port 1 payload format v3 (keyframe and deltas), keyframes kept per transmitter ID
+//          Family specific data decoded by the family byte instead of GROWATT_FAMILY
+//          Frame length from the header (frames are no longer padded)
+//          Keyframes (payload format 3) acknowledged to the transmitter (port 6)
+//          Acknowledgements of all keyframe slots checked against FrameCodec::PayloadSize
+//          Payload length checked per port and format before decoding
 //
 // ToDo:
 // -
@@ -54,16 +73,26 @@
 #include <ArduinoJson.h>
 #include <MQTT.h>
 #include <growatt_cfg.h>
+#include <FrameCodec.h>
+#include <PayloadCodec.h>
 #include <utils/utils.h>
+#include <utils/trace.h>
+#include <utils/timing.h>
+#include <utils/diag.h>
 #include "gw_receiver.h"
 
 #define SLEEP_INTERVAL 300      // sleep interval in seconds
 #define SLEEP_INTERVAL_SHORT 10 // sleep interval in seconds if receive failed
+#if !defined(RX_TIMEOUT)
 #define RX_TIMEOUT 180000       // sensor receive timeout [ms]
-#define TRANSMITTER_ID 0        // 32-bit transmitter ID; 0 - allow any ID
-#define MSG_BUF_SIZE 36         // last byte of preamble + digest (2 Bytes) + tx_id (4 Bytes)
-                                // + payload (29 Bytes)
-#define MQTT_PAYLOAD_SIZE 256   // define the payload size for MQTT messages
+#endif
+#if !defined(TRANSMITTER_ID)
+#define TRANSMITTER_ID 0        // 24-bit transmitter ID; 0 - allow any ID
+#endif
+#define RX_FOLLOWUP_TIMEOUT 1000 // wait for telemetry frames following a data frame [ms]
+#define MSG_BUF_SIZE FrameCodec::CaptureSize // last byte of sync word + header + max. payload
+#define MQTT_PAYLOAD_SIZE 512   // define the payload size for MQTT messages (incl. topic)
+#define KEYFRAME_SLOTS 8        // keyframes (payload format 3) of <n> transmitter ID/inverter pairs
 #define TIMEZONE 1              // UTC + TIMEZONE
 // Enter your time zone (https://remotemonitoringsystems.ca/time-zone-abbreviations.php)
 const char *TZ_INFO = "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00";
@@ -158,8 +187,66 @@ String Hostname = String(HOSTNAME);
 String mqttPubStatus = "status";
 String mqttPubData = "data";
 String mqttPubRssi = "rssi";
+String mqttPubTiming = "timing";
+String mqttPubDiag = "diag";
+String mqttPubTxDiag = "diag/transmitter";
+String mqttPubConfig = "config";
+
+static char jsonData[GROWATT_MAX_INVERTERS][MQTT_PAYLOAD_SIZE]; // inverter data by frame index
+static char *json = jsonData[0]; // last decoded inverter data
+static char jsonTiming[MQTT_PAYLOAD_SIZE];
+static bool timingValid = false; // jsonTiming contains timing telemetry
+static DiagRecord txDiag;        // transmitter's heap/stack diagnostics
+static bool txDiagValid = false; // txDiag is valid
+static uint8_t rxPort;           // port of last decoded frame
+static uint8_t rxIndex;          // inverter index of last decoded frame
+static uint16_t rxInverters;     // inverter indices received in this cycle (bit n: index n)
+static char jsonConfig[GROWATT_MAX_INVERTERS][MQTT_PAYLOAD_SIZE]; // inverter settings by frame index
+static uint16_t rxConfigs;       // inverter settings received in this cycle (bit n: index n)
+
+// Keyframe (reference values of payload format 3 delta frames, kept across deep sleep)
+struct KeyFrame
+{
+    uint32_t id;   // transmitter ID
+    uint8_t index; // inverter index
+    bool valid;
+    uint8_t key;   // sequence number of the keyframe
+    uint8_t seq;   // sequence number of the last frame
+    bool ack;      // received in this wake cycle, not acknowledged yet
+    int32_t raw[PayloadCodec::NumValues];
+};
+RTC_DATA_ATTR static KeyFrame keyFrames[KEYFRAME_SLOTS];
+static_assert(2 * KEYFRAME_SLOTS <= FrameCodec::PayloadSize, "Acknowledgements of KEYFRAME_SLOTS keyframes exceed FrameCodec::PayloadSize");
+RTC_DATA_ATTR static uint8_t keyFrameNext; // slot replaced by the next new transmitter ID/inverter pair
 
-static char json[MQTT_PAYLOAD_SIZE];
+/*!
+ * \brief Find keyframe of transmitter ID/inverter pair
+ *
+ * \param id transmitter ID
+ * \param index inverter index
+ * \param create replace the oldest slot if not found
+ *
+ * \returns keyframe or nullptr
+ */
+static KeyFrame *findKeyFrame(uint32_t id, uint8_t index, bool create)
+{
+    for (KeyFrame &k : keyFrames)
+    {
+        if (k.valid && k.id == id && k.index == index)
+        {
+            return &k;
+        }
+    }
+    if (!create)
+    {
+        return nullptr;
+    }
+    KeyFrame *k = &keyFrames[keyFrameNext];
+    keyFrameNext = (keyFrameNext + 1) % KEYFRAME_SLOTS;
+    k->id = id;
+    k->index = index;
+    return k;
+}
 
 // Generate WiFi network instance
 #if defined(USE_WIFI)
@@ -458,55 +545,388 @@ int16_t setupRadio()
     return state;
 }
 
-DecodeStatus decodeMessage(const uint8_t *msg, uint8_t msgSize)
+/*!
+ * \brief Check payload length before decoding
+ *
+ * Frames are not padded, so the capture buffer contains stale or random
+ * bytes after a short payload.
+ *
+ * \param size payload length (FrameCodec::getLength())
+ * \param expected payload size of the port/format
+ *
+ * \returns true if the payload is long enough
+ */
+bool checkLength(uint8_t size, uint8_t expected)
+{
+    if (size < expected)
+    {
+        log_d("Payload too short: %u of %u bytes", size, expected);
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Decode timing telemetry payload to jsonTiming
+ *
+ * Payload format must match AppLayer::getTimingPayload()
+ *
+ * \param payload payload
+ * \param size payload length
+ *
+ * \returns DECODE_OK or DECODE_INVALID (payload too short)
+ */
+DecodeStatus decodeTiming(const uint8_t *payload, uint8_t size)
+{
+    if (!checkLength(size, 2 + 4 * TIMING_NUM_PHASES))
+    {
+        return DECODE_INVALID;
+    }
+
+    // Phase names in order of TimingPhase (utils/timing.h);
+    // "<phase>": avg. duration [ms], "<phase>_max": max. duration [ms]
+    static const char *const phases[TIMING_NUM_PHASES] = {
+        "init", "read", "modbus", "radio", "tx", "awake"};
+    char key[24];
+    int offset = 0;
+
+    JsonDocument doc;
+    doc["cycles"] = payload[offset++];
+    doc["retries"] = payload[offset++];
+    for (int i = 0; i < TIMING_NUM_PHASES; i++)
+    {
+        doc[phases[i]] = payload[offset] | (payload[offset + 1] << 8);
+        snprintf(key, sizeof(key), "%s_max", phases[i]);
+        doc[key] = payload[offset + 2] | (payload[offset + 3] << 8);
+        offset += 4;
+    }
+
+    serializeJson(doc, jsonTiming, sizeof(jsonTiming));
+    timingValid = true;
+    log_i("Decoded timing JSON: %s", jsonTiming);
+
+    return DECODE_OK;
+}
+
+/*!
+ * \brief Decode heap/stack diagnostics payload to txDiag
+ *
+ * Payload format must match AppLayer::getDiagPayload()
+ *
+ * \param payload payload
+ * \param size payload length
+ *
+ * \returns DECODE_OK or DECODE_INVALID (payload too short)
+ */
+DecodeStatus decodeDiag(const uint8_t *payload, uint8_t size)
+{
+    if (!checkLength(size, 2 + 5 * sizeof(uint32_t)))
+    {
+        return DECODE_INVALID;
+    }
+
+    auto getUint32 = [payload](int offset) -> uint32_t
+    {
+        return payload[offset] | (payload[offset + 1] << 8) | (payload[offset + 2] << 16) |
+               ((uint32_t)payload[offset + 3] << 24);
+    };
+
+    txDiag.cycles = payload[0];
+    txDiag.minPoint = payload[1];
+    txDiag.freeHeap = getUint32(2);
+    txDiag.minFreeHeap = getUint32(6);
+    txDiag.minMaxAlloc = getUint32(10);
+    txDiag.minStackFree = getUint32(14);
+    txDiag.staticRam = getUint32(18);
+    txDiagValid = true;
+
+    return DECODE_OK;
+}
+
+/*!
+ * \brief Decode family specific payload and append it to the inverter's data
+ *
+ * Payload format must match AppLayer::getFamilyPayload(); the decoder is
+ * selected by the family byte, i.e. by the transmitter's GROWATT_FAMILY
+ *
+ * \param payload payload
+ * \param size payload length
+ *
+ * \returns DECODE_OK, DECODE_SKIP (no data frame of this inverter received
+ *          or unknown family) or DECODE_INVALID (payload too short)
+ */
+DecodeStatus decodeFamily(const uint8_t *payload, uint8_t size)
 {
-    // | preamble | byte0  | byte1  | byte2   | byte3   | byte4   | byte5   | byte6 | ... | byteN |
-    // | -------- |--------|--------|---------|---------|---------|---------|-------|-----|-------|
-    // |          | digest | digest | chip_id | chip_id | chip_id | chip_id |    <- payload ->    |
-    // |          | [15:8] |  [7:0] | [31:24] | [23:16] |  [15:8] |   [7:0] |     (uplinkSize)    |
-    // |          | <------------- whitening ---------------------------------------------------> |
+    if (rxIndex >= GROWATT_MAX_INVERTERS || !(rxInverters & (1 << rxIndex)))
+    {
+        log_d("No data frame of inverter %u", rxIndex);
+        return DECODE_SKIP;
+    }
+
+    if (!checkLength(size, 2))
+    {
+        return DECODE_INVALID;
+    }
+    int offset = 0;
+    uint8_t family = payload[offset++];
+    if (family != GW_FAMILY_MOD && family != GW_FAMILY_SPH)
+    {
+        log_d("Unknown family: %u", family);
+        return DECODE_SKIP;
+    }
+    // [family][result] + MOD: 2 x uint16_t, SPH: 2 x float, uint16_t, uint8_t
+    if (!checkLength(size, (family == GW_FAMILY_MOD) ? 2 + 4 : 2 + 11))
+    {
+        return DECODE_INVALID;
+    }
 
-    // data de-whitening
-    uint8_t msgw[MSG_BUF_SIZE];
-    for (unsigned i = 0; i < msgSize; ++i)
+    JsonDocument doc;
+    uint8_t result = payload[offset++];
+    if (result == 0 && family == GW_FAMILY_MOD)
     {
-        msgw[i] = msg[i] ^ 0xaa;
+        doc["gridvoltage2"] = (payload[offset] | (payload[offset + 1] << 8)) / 10.0;
+        offset += 2;
+        doc["gridvoltage3"] = (payload[offset] | (payload[offset + 1] << 8)) / 10.0;
+        offset += 2;
     }
+    else if (result == 0 && family == GW_FAMILY_SPH)
+    {
+        float value;
+        memcpy(&value, &payload[offset], sizeof(float));
+        doc["dischargepower"] = value;
+        offset += sizeof(float);
+        memcpy(&value, &payload[offset], sizeof(float));
+        doc["chargepower"] = value;
+        offset += sizeof(float);
+        doc["batteryvoltage"] = (payload[offset] | (payload[offset + 1] << 8)) / 10.0;
+        offset += 2;
+        doc["soc"] = payload[offset++];
+    }
+
+    // Append the members to the inverter's JSON object
+    char members[MQTT_PAYLOAD_SIZE];
+    size_t membersLen = serializeJson(doc, members, sizeof(members));
+    char *data = jsonData[rxIndex];
+    size_t len = strlen(data);
+    if (membersLen > 2 && len > 2 && len + membersLen - 1 < MQTT_PAYLOAD_SIZE)
+    {
+        data[len - 1] = ',';
+        strcpy(&data[len], &members[1]);
+    }
+    log_i("Decoded JSON: %s", data);
+
+    return DECODE_OK;
+}
+
+/*!
+ * \brief Decode inverter settings payload to jsonConfig
+ *
+ * Payload format must match AppLayer::getConfigPayload()
+ *
+ * \param payload payload
+ * \param size payload length
+ *
+ * \returns DECODE_OK, DECODE_SKIP (inverter index out of range) or
+ *          DECODE_INVALID (payload too short)
+ */
+DecodeStatus decodeConfig(const uint8_t *payload, uint8_t size)
+{
+    if (rxIndex >= GROWATT_MAX_INVERTERS)
+    {
+        log_d("Inverter index %u exceeds GROWATT_MAX_INVERTERS", rxIndex);
+        return DECODE_SKIP;
+    }
+    // serial (10), firmware (6), control firmware (6), maxpower (float), voltnormal (uint16_t)
+    if (!checkLength(size, 28))
+    {
+        return DECODE_INVALID;
+    }
+
+    // Fixed size string, padded with spaces or NUL
+    auto getString = [payload](char *str, int offset, int size)
+    {
+        int len = 0;
+        while (len < size && payload[offset + len])
+        {
+            str[len] = payload[offset + len];
+            len++;
+        }
+        while (len > 0 && str[len - 1] == ' ')
+        {
+            len--;
+        }
+        str[len] = '\0';
+    };
+
+    JsonDocument doc;
+    char serial[11];
+    char firmware[7];
+    char controlfirmware[7];
+    float maxpower;
+    getString(serial, 0, 10);
+    getString(firmware, 10, 6);
+    getString(controlfirmware, 16, 6);
+    doc["serial"] = serial;
+    doc["firmware"] = firmware;
+    doc["controlfirmware"] = controlfirmware;
+    memcpy(&maxpower, &payload[22], sizeof(float));
+    doc["maxpower"] = maxpower;
+    doc["voltnormal"] = (payload[26] | (payload[27] << 8)) / 10.0;
+
+    serializeJson(doc, jsonConfig[rxIndex], MQTT_PAYLOAD_SIZE);
+    rxConfigs |= 1 << rxIndex;
+    log_i("Decoded settings JSON: %s", jsonConfig[rxIndex]);
 
-    // LFSR-16 digest, generator 0x8005 key 0xba95 final xor 0x6df1
-    int chkdgst = (msgw[0] << 8) | msgw[1];
-    int digest = lfsr_digest16(&msgw[2], msgSize - 2, 0x8005, 0xba95);
-    if ((chkdgst ^ digest) != 0x6df1)
+    return DECODE_OK;
+}
+
+DecodeStatus decodeMessage(uint8_t *msg, uint8_t msgSize)
+{
+    // | preamble | byte0  | byte1  | byte2   | byte3   | byte4   | byte5   | byte6   | byte7 | ... | byteN |
+    // | -------- |--------|--------|---------|---------|---------|---------|---------|-------|-----|-------|
+    // |          | digest | digest | payload | index/  | chip_id | chip_id | chip_id |    <- payload ->    |
+    // |          | [15:8] |  [7:0] | length  | port    | [23:16] |  [15:8] |   [7:0] |     (uplinkSize)    |
+    // |          | <------------- whitening -------------------------------------------------------------> |
+
+    // In-place de-whitening and LFSR-16 digest check; bytes following the frame are ignored
+    msgSize = FrameCodec::decode(msg, msgSize);
+    if (!msgSize)
     {
-        log_d("Digest check failed - [%04X] vs [%04X] (%04X)", chkdgst, digest, chkdgst ^ digest);
         return DECODE_DIG_ERR;
     }
 
 #if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
-    log_message("De-whitened Data", msgw, msgSize);
+    log_message("De-whitened Data", msg, msgSize);
 #endif
 
+    uint32_t transmitter_id = FrameCodec::getId(msg);
+    int offset = FrameCodec::HeaderSize;
+    uint8_t length = FrameCodec::getLength(msg);
+    log_i("Transmitter ID: %06lX", transmitter_id);
+
+    if (TRANSMITTER_ID != 0 && TRANSMITTER_ID != transmitter_id)
+    {
+        log_i("Transmitter ID mismatch: expected %06lX, got %06lX", TRANSMITTER_ID, transmitter_id);
+        return DECODE_INVALID;
+    }
+
+    rxPort = FrameCodec::getPort(msg);
+    rxIndex = FrameCodec::getIndex(msg);
+    if (rxPort == FrameCodec::PortTiming)
+    {
+        return decodeTiming(&msg[offset], length);
+    }
+    else if (rxPort == FrameCodec::PortDiag)
+    {
+        return decodeDiag(&msg[offset], length);
+    }
+    else if (rxPort == FrameCodec::PortFamily)
+    {
+        return decodeFamily(&msg[offset], length);
+    }
+    else if (rxPort == FrameCodec::PortConfig)
+    {
+        return decodeConfig(&msg[offset], length);
+    }
+    else if (rxPort != FrameCodec::PortData)
+    {
+        log_d("Unknown port: %u", rxPort);
+        return DECODE_SKIP;
+    }
+    else if (rxIndex >= GROWATT_MAX_INVERTERS)
+    {
+        log_d("Inverter index %u exceeds GROWATT_MAX_INVERTERS", rxIndex);
+        return DECODE_SKIP;
+    }
+    json = jsonData[rxIndex];
+
     // --- DECODE PAYLOAD TO STRUCT ---
     // Payload format must match getPayloadStage2() in AppLayer.cpp
     // For port == 1:
     // [uint8_t result][uint8_t status][uint8_t faultcode][float energytoday][float energytotal]
     // [float totalworktime][float outputpower][float gridvoltage][float gridfrequency]
+    // Formats v2/v3 (values as scaled integers, see AppLayer::getPayloadStage2() and PayloadCodec.h):
+    // [uint8_t 0xA2][uint8_t result][values]
+    // [uint8_t 0xA3][uint8_t seq][values] (keyframe)
+    // [uint8_t 0xA4][uint8_t seq][uint8_t keyframe seq][uint8_t length][delta encoding]
 
-    int offset = 2; // skip digest bytes
-    uint32_t transmitter_id = 0;
-    for (int i = 0; i < 4; i++)
+    if (!checkLength(length, 1))
     {
-        transmitter_id |= (msgw[offset++] << (24 - i * 8));
+        return DECODE_INVALID;
     }
-    log_i("Transmitter ID: %08lX", transmitter_id);
+    uint8_t format = msg[offset];
+    uint8_t result = 0;
+    int32_t raw[PayloadCodec::NumValues];
+    bool scaled = false;
 
-    if (TRANSMITTER_ID != 0 && TRANSMITTER_ID != transmitter_id)
+    if (format == FrameCodec::FormatV2)
     {
-        log_i("Transmitter ID mismatch: expected %08lX, got %08lX", TRANSMITTER_ID, transmitter_id);
-        return DECODE_INVALID;
+        if (!checkLength(length, 2))
+        {
+            return DECODE_INVALID;
+        }
+        result = msg[offset + 1];
+        if (result == 0)
+        {
+            if (!checkLength(length, 2 + PayloadCodec::AbsoluteSize))
+            {
+                return DECODE_INVALID;
+            }
+            PayloadCodec::readAbsolute(&msg[offset + 2], raw);
+            scaled = true;
+        }
+    }
+    else if (format == FrameCodec::FormatKey)
+    {
+        if (!checkLength(length, 2 + PayloadCodec::AbsoluteSize))
+        {
+            return DECODE_INVALID;
+        }
+        KeyFrame *key = findKeyFrame(transmitter_id, rxIndex, true);
+        key->key = key->seq = msg[offset + 1];
+        PayloadCodec::readAbsolute(&msg[offset + 2], key->raw);
+        key->valid = true;
+        key->ack = true;
+        memcpy(raw, key->raw, sizeof(raw));
+        scaled = true;
     }
+    else if (format == FrameCodec::FormatDelta)
+    {
+        if (!checkLength(length, 4))
+        {
+            return DECODE_INVALID;
+        }
+        uint8_t seq = msg[offset + 1];
+        uint8_t keySeq = msg[offset + 2];
+        uint8_t size = msg[offset + 3];
+        KeyFrame *key = findKeyFrame(transmitter_id, rxIndex, false);
 
-    uint8_t result = msgw[offset++];
+        if (!key || key->key != keySeq)
+        {
+            log_d("Keyframe %u of frame %u not received", keySeq, seq);
+            return DECODE_SKIP;
+        }
+        if ((4 + size > length) ||
+            (PayloadCodec::readDelta(&msg[offset + 4], size, key->raw, raw) != size))
+        {
+            return DECODE_INVALID;
+        }
+        if ((uint8_t)(seq - key->seq) != 1)
+        {
+            log_d("%u frame(s) lost", (uint8_t)(seq - key->seq - 1));
+        }
+        key->seq = seq;
+        scaled = true;
+    }
+    else
+    {
+        // Format v1: [result][status][faultcode][6 x float][tempinverter]
+        result = msg[offset++];
+        if ((result == 0) && !checkLength(length, 1 + 2 + 6 * sizeof(float) + 2))
+        {
+            return DECODE_INVALID;
+        }
+    }
     if (result != 0)
     {
         log_e("Modbus error: %u", result);
@@ -515,27 +935,42 @@ DecodeStatus decodeMessage(const uint8_t *msg, uint8_t msgSize)
     JsonDocument doc;
     doc["modbus"] = result;
 
-    if (result == 0)
+    if (scaled)
+    {
+        modbusdata.status = raw[PayloadCodec::Status];
+        modbusdata.faultcode = raw[PayloadCodec::FaultCode];
+        modbusdata.energytoday = PayloadCodec::toPhysical(PayloadCodec::EnergyToday, raw[PayloadCodec::EnergyToday]);
+        modbusdata.energytotal = PayloadCodec::toPhysical(PayloadCodec::EnergyTotal, raw[PayloadCodec::EnergyTotal]);
+        modbusdata.totalworktime = PayloadCodec::toPhysical(PayloadCodec::TotalWorkTime, raw[PayloadCodec::TotalWorkTime]);
+        modbusdata.outputpower = PayloadCodec::toPhysical(PayloadCodec::OutputPower, raw[PayloadCodec::OutputPower]);
+        modbusdata.gridvoltage = PayloadCodec::toPhysical(PayloadCodec::GridVoltage, raw[PayloadCodec::GridVoltage]);
+        modbusdata.gridfrequency = PayloadCodec::toPhysical(PayloadCodec::GridFrequency, raw[PayloadCodec::GridFrequency]);
+        modbusdata.tempinverter = PayloadCodec::toPhysical(PayloadCodec::TempInverter, raw[PayloadCodec::TempInverter]);
+    }
+    else if (result == 0)
     {
-        modbusdata.status = msgw[offset++];
-        modbusdata.faultcode = msgw[offset++];
+        modbusdata.status = msg[offset++];
+        modbusdata.faultcode = msg[offset++];
 
-        memcpy(&modbusdata.energytoday, &msgw[offset], sizeof(float));
+        memcpy(&modbusdata.energytoday, &msg[offset], sizeof(float));
         offset += sizeof(float);
-        memcpy(&modbusdata.energytotal, &msgw[offset], sizeof(float));
+        memcpy(&modbusdata.energytotal, &msg[offset], sizeof(float));
         offset += sizeof(float);
-        memcpy(&modbusdata.totalworktime, &msgw[offset], sizeof(float));
+        memcpy(&modbusdata.totalworktime, &msg[offset], sizeof(float));
         offset += sizeof(float);
-        memcpy(&modbusdata.outputpower, &msgw[offset], sizeof(float));
+        memcpy(&modbusdata.outputpower, &msg[offset], sizeof(float));
         offset += sizeof(float);
-        memcpy(&modbusdata.gridvoltage, &msgw[offset], sizeof(float));
+        memcpy(&modbusdata.gridvoltage, &msg[offset], sizeof(float));
         offset += sizeof(float);
-        memcpy(&modbusdata.gridfrequency, &msgw[offset], sizeof(float));
+        memcpy(&modbusdata.gridfrequency, &msg[offset], sizeof(float));
         offset += sizeof(float);
         // Decode tempinverter (2 bytes, two's complement)
-        int16_t encodedTemp = (msgw[offset] << 8) | msgw[offset+1]; // Combine high and low bytes
+        int16_t encodedTemp = (msg[offset] << 8) | msg[offset+1]; // Combine high and low bytes
         modbusdata.tempinverter = encodedTemp / 100.0;              // Reverse scaling by dividing by 100
+    }
 
+    if (result == 0)
+    {
         // --- Convert modbusdata to JSON ---
         doc["status"] = modbusdata.status;
         doc["faultcode"] = modbusdata.faultcode;
@@ -548,7 +983,8 @@ DecodeStatus decodeMessage(const uint8_t *msg, uint8_t msgSize)
         doc["tempinverter"] = modbusdata.tempinverter;
     }
 
-    serializeJson(doc, json, sizeof(json));
+    serializeJson(doc, json, MQTT_PAYLOAD_SIZE);
+    diag_sample(DIAG_DECODE);
     log_i("Decoded JSON: %s", json);
 
     return DECODE_OK;
@@ -574,17 +1010,13 @@ DecodeStatus getMessage(void)
             if (recvData[0] == 0xD4)
             {
 #if CORE_DEBUG_LEVEL == ARDUHAL_LOG_LEVEL_VERBOSE
-                char buf[128];
-                *buf = '\0';
-                for (size_t i = 0; i < sizeof(recvData); i++)
-                {
-                    sprintf(&buf[strlen(buf)], "%02X ", recvData[i]);
-                }
-                log_v("%s Data: %s", TRANSCEIVER_CHIP, buf);
+                log_message(TRANSCEIVER_CHIP " Data", recvData, sizeof(recvData));
 #endif
+                TRACE_DATA(TRACE_RX_FRAME, recvData, sizeof(recvData));
                 log_d("%s R [%02X] RSSI: %0.1f", TRANSCEIVER_CHIP, recvData[0], rssi);
 
                 decode_res = decodeMessage(&recvData[1], sizeof(recvData) - 1);
+                TRACE_VAL(TRACE_DECODE, (uint8_t)decode_res);
             } // if (recvData[0] == 0xD4)
         } // if (state == RADIOLIB_ERR_NONE)
         else if (state == RADIOLIB_ERR_RX_TIMEOUT)
@@ -601,10 +1033,54 @@ DecodeStatus getMessage(void)
     return decode_res;
 }
 
+/*!
+ * \brief Acknowledge the keyframes received in this wake cycle (payload format 3)
+ *
+ * One FrameCodec::PortAck frame per transmitter ID, sent with the receive
+ * settings (sync word, fixed packet length), so the transmitter receives it
+ * like the receiver. Payload format see AppLayer::decodeDownlink().
+ */
+void sendAcks(void)
+{
+    for (KeyFrame &k : keyFrames)
+    {
+        if (!k.ack)
+        {
+            continue;
+        }
+
+        // Last sync word byte (see setSyncWord() in setupRadio()), frame
+        uint8_t buf[MSG_BUF_SIZE] = {0xD4};
+        uint8_t *payload = &buf[1 + FrameCodec::HeaderSize];
+        uint8_t size = 0;
+        uint32_t id = k.id;
+        for (KeyFrame &a : keyFrames)
+        {
+            if (a.ack && (a.id == id))
+            {
+                payload[size++] = a.index;
+                payload[size++] = a.key;
+                a.ack = false;
+            }
+        }
+        FrameCodec::encode(&buf[1], FrameCodec::PortAck, id, size);
+
+        log_d("%s Acknowledging %u keyframe(s) of %06lX", TRANSCEIVER_CHIP, size / 2, id);
+        int state = radio.transmit(buf, sizeof(buf));
+        if (state != RADIOLIB_ERR_NONE)
+        {
+            log_d("%s Transmit failed: [%d]", TRANSCEIVER_CHIP, state);
+        }
+    }
+}
+
 bool getData(uint32_t timeout, void (*func)())
 {
-    const uint32_t timestamp = millis();
+    uint32_t timestamp = millis();
+    bool dataValid = false;
 
+    rxInverters = 0;
+    rxConfigs = 0;
     radio.startReceive();
 
     while ((millis() - timestamp) < timeout)
@@ -617,12 +1093,19 @@ bool getData(uint32_t timeout, void (*func)())
             (*func)();
         }
 
-        if (decode_status == DECODE_OK)
+        if (decode_status == DECODE_OK && rxPort == FrameCodec::PortData)
         {
-            radio.standby();
-            return true;
+            if (rxInverters & (1 << rxIndex))
+            {
+                break;
+            }
+            // Further inverters' data and telemetry frames are sent immediately after the first data frame
+            rxInverters |= 1 << rxIndex;
+            dataValid = true;
+            timestamp = millis();
+            timeout = RX_FOLLOWUP_TIMEOUT;
         } // if (decode_status == DECODE_OK)
-        else
+        else if (decode_status != DECODE_OK)
         {
             if (decode_status == DECODE_DIG_ERR)
             {
@@ -635,23 +1118,29 @@ bool getData(uint32_t timeout, void (*func)())
         }
     } //  while ((millis() - timestamp) < timeout)
 
-    // Timeout
+    // The transmitter listens after its last frame
+    sendAcks();
     radio.standby();
-    return false;
+    return dataValid;
 }
 
 void setup()
 {
     // Initialize Serial for debugging
     Serial.begin(115200);
+    TRACE_BEGIN();
+    diag_begin();
 
     setupRadio();
+    diag_sample(DIAG_RADIO);
 
     bool valid = getData(RX_TIMEOUT, NULL);
     if (!valid)
     {
         log_e("Failed to get data within timeout.");
         log_i("Sleeping for %d s\n", SLEEP_INTERVAL_SHORT);
+        TRACE_VAL(TRACE_SLEEP, (uint32_t)SLEEP_INTERVAL_SHORT);
+        TRACE_DUMP(Serial);
         ESP.deepSleep(SLEEP_INTERVAL_SHORT * 1000000L);
     }
 
@@ -683,14 +1172,54 @@ void setup()
     mqttPubData = Hostname + "/" + mqttPubData;
     mqttPubRssi = Hostname + "/" + mqttPubRssi;
     mqttPubStatus = Hostname + "/" + mqttPubStatus;
+    mqttPubTiming = Hostname + "/" + mqttPubTiming;
+    mqttPubDiag = Hostname + "/" + mqttPubDiag;
+    mqttPubTxDiag = Hostname + "/" + mqttPubTxDiag;
+    mqttPubConfig = Hostname + "/" + mqttPubConfig;
 
     mqtt_setup();
+    diag_sample(DIAG_MQTT);
 
-    log_i("%s: %s\n", mqttPubData.c_str(), json);
-    client.publish(mqttPubData, json, false /* retain */, 0);
+    for (uint8_t i = 0; i < GROWATT_MAX_INVERTERS; i++)
+    {
+        if (rxInverters & (1 << i))
+        {
+            String topic = (i == 0) ? mqttPubData : mqttPubData + "/" + String(i);
+            log_i("%s: %s\n", topic.c_str(), jsonData[i]);
+            client.publish(topic, jsonData[i], false /* retain */, 0);
+        }
+        if (rxConfigs & (1 << i))
+        {
+            String topic = (i == 0) ? mqttPubConfig : mqttPubConfig + "/" + String(i);
+            log_i("%s: %s\n", topic.c_str(), jsonConfig[i]);
+            client.publish(topic, jsonConfig[i], true /* retain */, 0);
+        }
+    }
 
     log_i("%s: %0.1f", mqttPubRssi.c_str(), rssi);
     client.publish(mqttPubRssi, String(rssi, 1), false, 0);
+
+    if (timingValid)
+    {
+        log_i("%s: %s\n", mqttPubTiming.c_str(), jsonTiming);
+        client.publish(mqttPubTiming, jsonTiming, false /* retain */, 0);
+    }
+
+    char jsonDiag[MQTT_PAYLOAD_SIZE];
+    if (txDiagValid)
+    {
+        diag_json(txDiag, jsonDiag, sizeof(jsonDiag));
+        log_i("%s: %s\n", mqttPubTxDiag.c_str(), jsonDiag);
+        client.publish(mqttPubTxDiag, jsonDiag, false /* retain */, 0);
+    }
+    diag_sample(DIAG_SLEEP);
+    if (diag_report_due())
+    {
+        diag_json(diag_record(), jsonDiag, sizeof(jsonDiag));
+        log_i("%s: %s\n", mqttPubDiag.c_str(), jsonDiag);
+        client.publish(mqttPubDiag, jsonDiag, false /* retain */, 0);
+        diag_reset();
+    }
     client.loop();
 
     log_i("Sleeping for %d s\n", SLEEP_INTERVAL);
@@ -706,6 +1235,8 @@ void setup()
     client.disconnect();
     net.stop();
 
+    TRACE_VAL(TRACE_SLEEP, (uint32_t)SLEEP_INTERVAL);
+    TRACE_DUMP(Serial);
     ESP.deepSleep(SLEEP_INTERVAL * 1000000L);
 }
 
@@ -39,6 +39,20 @@
 //          Added ESP32 chip_id as transmitter ID to message
 // 20250710 Minor changes
 // 20260223 Added support for Seeed Studio XIAO ESP32S3 & Wio-SX1262
+// 20261017 Replaced bit-serial digest by table-driven lfsr_digest16<gen, key>()
+//          Replaced frame building by FrameCodec; payload is encoded in place
+//          Added trace points (see ENABLE_TRACE in growatt_cfg.h)
+//          Added phase timing and timing telemetry frame (see TIMING_INTERVAL in growatt_cfg.h)
+//          Moved frame encoding and transmission to transmitFrame()
+//          Added heap/stack diagnostics frame (see DIAG_INTERVAL in growatt_cfg.h)
+//          Added one data frame per inverter (see GROWATT_SLAVE_IDS in growatt_cfg.h)
+//          Added family specific data frame (see GROWATT_FAMILY in growatt_cfg.h)
+//          Added settings frame, sent if the inverter's settings snapshot has changed
+//          Skip empty family specific data frame (inverter unreachable)
+//          Added Modbus transaction dump (see MODBUS_CAPTURE in growatt_cfg.h)
+//          Frames are no longer padded (payload length in the header)
+//          Receive keyframe acknowledgement (payload format 3) after the last frame
+//          Frames with payloads exceeding FrameCodec::PayloadSize are not transmitted
 //
 // ToDo:
 // - Change syncword to distinguish messages from bresser protocol
@@ -50,12 +64,25 @@
 #include <LoraEncoder.h>
 #include <growatt_cfg.h>
 #include <AppLayer.h>
+#include <FrameCodec.h>
 #include <utils/utils.h>
+#include <utils/trace.h>
+#include <utils/timing.h>
+#include <utils/diag.h>
 #include "gw_transmitter.h"
+#if defined(MODBUS_CAPTURE)
+#include <growattInterface.h>
+extern growattIF growattInterface; // see AppLayer.cpp
+#endif
 
 #define SLEEP_INTERVAL 60  // sleep interval in seconds
-#define MAX_UPLINK_SIZE 256 // maximum uplink size in bytes
+#define MAX_UPLINK_SIZE 64 // maximum uplink size in bytes (preamble + header + payload)
 #define OUTPUT_POWER 10 // output power in dBm
+#if GROWATT_FAMILY != GW_FAMILY_MIC
+#define FRAMES_PER_INVERTER 3 // data frame, family specific data frame and settings frame
+#else
+#define FRAMES_PER_INVERTER 2 // data frame and settings frame
+#endif
 
 /// Modbus interface select: 0 - USB / 1 - RS485
 bool modbusRS485;
@@ -74,20 +101,136 @@ static SX1262 radio = new Module(PIN_TRANSCEIVER_CS, PIN_TRANSCEIVER_IRQ, PIN_TR
 static SX1276 radio = new Module(PIN_TRANSCEIVER_CS, PIN_TRANSCEIVER_IRQ, PIN_TRANSCEIVER_RST, PIN_TRANSCEIVER_GPIO);
 #endif
 
-int msgBegin(uint8_t *msg)
+#if PAYLOAD_FORMAT == 3
+// Flag to indicate that a packet was received
+volatile bool receivedFlag = false;
+
+// This function is called when a complete packet is received by the module
+#if defined(ESP8266) || defined(ESP32)
+IRAM_ATTR
+#endif
+void setFlag(void)
+{
+    receivedFlag = true;
+}
+
+/*!
+ * \brief Receive the keyframe acknowledgement (payload format 3)
+ *
+ * Listens with the receiver's settings (sync word, fixed packet length) for
+ * up to PAYLOAD_ACK_TIMEOUT and passes the acknowledgement to
+ * AppLayer::decodeDownlink(). The radio settings are not restored, so this
+ * must follow the last transmission of the wake cycle.
+ *
+ * \param chip_id transmitter ID
+ */
+void receiveAck(uint32_t chip_id)
+{
+    uint8_t sync_word[] = {0xAA, 0x2D};
+    radio.setSyncWord(sync_word, 2);
+    radio.fixedPacketLengthMode(FrameCodec::CaptureSize);
+#if defined(USE_SX1262)
+    radio.setCRC(0);
+#else
+    radio.setCrcFiltering(false);
+#endif
+    radio.setPacketReceivedAction(setFlag);
+    radio.startReceive();
+
+    uint32_t start = millis();
+    while (appLayer.ackPending() && ((millis() - start) < PAYLOAD_ACK_TIMEOUT))
+    {
+        if (!receivedFlag)
+        {
+            delay(1);
+            continue;
+        }
+        receivedFlag = false;
+
+        uint8_t buf[FrameCodec::CaptureSize];
+        int state = radio.readData(buf, sizeof(buf));
+        radio.startReceive();
+
+        // Last sync word byte, frame
+        if ((state != RADIOLIB_ERR_NONE) || (buf[0] != 0xD4) || !FrameCodec::decode(&buf[1], sizeof(buf) - 1))
+        {
+            continue;
+        }
+        if ((FrameCodec::getPort(&buf[1]) == FrameCodec::PortAck) && (FrameCodec::getId(&buf[1]) == chip_id))
+        {
+            appLayer.decodeDownlink(FrameCodec::PortAck, &buf[1 + FrameCodec::HeaderSize], FrameCodec::getLength(&buf[1]));
+        }
+    }
+    radio.standby();
+    log_d("Keyframe acknowledgement %s after %lu ms", appLayer.ackPending() ? "not received" : "received", millis() - start);
+}
+#endif
+
+/*!
+ * \brief Encode and transmit frame
+ *
+ * \param msg_buf message buffer; payload at FrameCodec::PreambleSize + FrameCodec::HeaderSize
+ * \param port port (payload format)
+ * \param chip_id transmitter ID
+ * \param uplinkSize payload size in bytes
+ *
+ * \returns RadioLib state
+ */
+int16_t transmitFrame(uint8_t *msg_buf, uint8_t port, uint32_t chip_id, uint8_t uplinkSize)
 {
-    uint8_t preamble[] = {0xAA, 0xAA, 0xAA, 0xAA};
-    uint8_t syncword[] = {0x2D, 0xD4};
+    // | preamble | byte0  | byte1  | byte2   | byte3   | byte4   | byte5   | byte6   | byte7 | ... | byteN |
+    // | -------- |--------|--------|---------|---------|---------|---------|---------|-------|-----|-------|
+    // |          | digest | digest | payload | index/  | chip_id | chip_id | chip_id |    <- payload ->    |
+    // |          | [15:8] |  [7:0] | length  | port    | [23:16] |  [15:8] |   [7:0] |     (uplinkSize)    |
+    // |          | <------------- whitening -------------------------------------------------------------> |
+    uint8_t preamble_size = FrameCodec::begin(msg_buf);
+    uint8_t frame_size = FrameCodec::encode(&msg_buf[preamble_size], port, chip_id, uplinkSize);
+    if (!frame_size)
+    {
+        // Payload exceeds FrameCodec::PayloadSize, the receiver would drop the frame
+        log_e("%s Frame (port %u) not transmitted", TRANSCEIVER_CHIP, port);
+        return RADIOLIB_ERR_PACKET_TOO_LONG;
+    }
+    uint8_t msg_size = preamble_size + frame_size;
 
-    memcpy(msg, preamble, sizeof(preamble));
-    memcpy(&msg[sizeof(preamble)], syncword, sizeof(syncword));
+    log_i("%s Transmitting packet (port %u, %d bytes)... ", TRANSCEIVER_CHIP, port, msg_size);
+    log_message("TX-Data", msg_buf, msg_size);
+    TRACE_DATA(TRACE_TX_FRAME, msg_buf, msg_size);
+    uint32_t start = millis();
+    int16_t state = radio.transmit(msg_buf, msg_size);
+    timing_add(TIMING_TX, millis() - start);
+    TRACE_VAL(TRACE_TX_DONE, (int16_t)state);
 
-    return sizeof(preamble) + sizeof(syncword);
+    if (state == RADIOLIB_ERR_NONE)
+    {
+        // the packet was successfully transmitted
+        log_i("success!");
+    }
+    else if (state == RADIOLIB_ERR_PACKET_TOO_LONG)
+    {
+        // the supplied packet was longer than 256 bytes
+        log_e("too long!");
+    }
+    else if (state == RADIOLIB_ERR_TX_TIMEOUT)
+    {
+        // timeout occurred while transmitting packet
+        log_e("timeout!");
+    }
+    else
+    {
+        // some other error occurred
+        log_e("failed, code %d", state);
+    }
+    return state;
 }
 
 // setup & execute all device functions ...
 void setup()
 {
+    TRACE_BEGIN();
+    timing_begin();
+    diag_begin();
+
     pinMode(INTERFACE_SEL, INPUT_PULLUP);
     modbusRS485 = !digitalRead(INTERFACE_SEL);
 
@@ -103,19 +246,55 @@ void setup()
     // Initialize Application Layer - starts sensor reception
     appLayer.begin();
 
-    // build payload byte array
-    uint8_t uplinkPayload[MAX_UPLINK_SIZE];
+    // build payload byte arrays in place, i.e. behind preamble and frame header;
+    // all inverters are read back-to-back before the radio is initialized
+    uint8_t msg_buf[GROWATT_MAX_INVERTERS * FRAMES_PER_INVERTER][MAX_UPLINK_SIZE];
+    uint8_t msg_port[GROWATT_MAX_INVERTERS * FRAMES_PER_INVERTER];
+    uint8_t uplinkSize[GROWATT_MAX_INVERTERS * FRAMES_PER_INVERTER];
+    uint8_t frames = 0;
 
-    LoraEncoder encoder(uplinkPayload);
+    for (uint8_t inv = 0; inv < appLayer.getInverterCount(); inv++)
+    {
+        LoraEncoder encoder(&msg_buf[frames][FrameCodec::PreambleSize + FrameCodec::HeaderSize]);
 
 #if defined(EMULATE_SENSORS)
-    appLayer.genPayload(1 /* fPort */, encoder);
+        appLayer.genPayload(1 /* fPort */, encoder);
 #else
-    // get payload immediately before uplink
-    appLayer.getPayloadStage2(1 /* fPort */, encoder);
+        // get payload immediately before uplink
+        appLayer.getPayloadStage2(1 /* fPort */, encoder, inv);
+#endif
+
+        msg_port[frames] = FrameCodec::dataPort(inv);
+        uplinkSize[frames] = encoder.getLength();
+        TRACE_BYTES(TRACE_PAYLOAD, 1 /* fPort */, uplinkSize[frames]);
+        frames++;
+
+#if GROWATT_FAMILY != GW_FAMILY_MIC
+        LoraEncoder familyEncoder(&msg_buf[frames][FrameCodec::PreambleSize + FrameCodec::HeaderSize]);
+        appLayer.getFamilyPayload(FrameCodec::PortFamily, familyEncoder);
+        if (familyEncoder.getLength())
+        {
+            msg_port[frames] = FrameCodec::dataPort(inv, FrameCodec::PortFamily);
+            uplinkSize[frames] = familyEncoder.getLength();
+            frames++;
+        }
+#endif
+
+#if !defined(EMULATE_SENSORS)
+        // Settings snapshot - only if it has changed
+        LoraEncoder configEncoder(&msg_buf[frames][FrameCodec::PreambleSize + FrameCodec::HeaderSize]);
+        uint8_t configPort;
+        appLayer.getConfigPayload(CMD_GET_SETTINGS_CHANGED, configPort, configEncoder);
+        if (configEncoder.getLength())
+        {
+            msg_port[frames] = FrameCodec::dataPort(inv, configPort);
+            uplinkSize[frames] = configEncoder.getLength();
+            frames++;
+        }
 #endif
+    }
 
-    uint8_t uplinkSize = encoder.getLength();
+    diag_sample(DIAG_MODBUS);
 
     log_i("%s Initializing ... ", TRANSCEIVER_CHIP);
     // carrier frequency:                   868.3 MHz
@@ -127,6 +306,7 @@ void setup()
     // Preamble: AA AA AA AA AA
     // Sync: 2D D4
     
+    uint32_t start = millis();
     #if defined(USE_SX1262)
     // SX1262 initialization
     int state = radio.beginFSK(868.3, 8.21, 57.136417, 234.3, OUTPUT_POWER, 32);
@@ -134,6 +314,9 @@ void setup()
     // SX1276 initialization
     int state = radio.beginFSK(868.3, 8.21, 57.136417, 250, OUTPUT_POWER, 32);
     #endif
+    timing_add(TIMING_RADIO_INIT, millis() - start);
+    diag_sample(DIAG_RADIO);
+    TRACE_VAL(TRACE_RADIO_INIT, (int16_t)state);
 
 #if defined(ARDUINO_XIAO_ESP32S3)
     // set RF switch control configuration
@@ -158,13 +341,6 @@ void setup()
             ;
     }
 
-    uint8_t msg_buf[50];
-    uint8_t preamble_size;
-
-    preamble_size = msgBegin(msg_buf);
-
-    memcpy(&msg_buf[preamble_size + 6], uplinkPayload, uplinkSize);
-
     uint32_t chip_id = 0;
 #if defined(ESP32)
     for (int i = 0; i < 17; i = i + 8)
@@ -172,58 +348,73 @@ void setup()
         chip_id |= ((ESP.getEfuseMac() >> (40 - i)) & 0xff) << i;
     }
 #elif defined(APPEND_CHIP_ID) && defined(ESP8266)
-    chip_id = ESP.getChipId();
+    chip_id = ESP.getChipId() & 0xFFFFFF;
 #endif
-    log_d("ChipID: 0x%08lX", chip_id);
+    log_d("ChipID: 0x%06lX", chip_id);
 
-    for (int i = 0; i < 4; i++)
+    for (uint8_t i = 0; i < frames; i++)
     {
-        msg_buf[preamble_size + 2 + i] = (chip_id >> (24 - i * 8)) & 0xFF;
+        transmitFrame(msg_buf[i], msg_port[i], chip_id, uplinkSize[i]);
     }
 
-    int digest = lfsr_digest16(&msg_buf[preamble_size + 2], uplinkSize + 4, 0x8005, 0xba95);
-    digest ^= 0x6df1;
-
-    // | preamble | byte0  | byte1  | byte2   | byte3   | byte4   | byte5   | byte6 | ... | byteN |
-    // | -------- |--------|--------|---------|---------|---------|---------|-------|-----|-------|
-    // |          | digest | digest | chip_id | chip_id | chip_id | chip_id |    <- payload ->    |
-    // |          | [15:8] |  [7:0] | [31:24] | [23:16] |  [15:8] |   [7:0] |     (uplinkSize)    |
-    // |          | <------------- whitening ---------------------------------------------------> |
-
-    msg_buf[preamble_size] = digest >> 8;
-    msg_buf[preamble_size + 1] = digest & 0xFF;
+    // Timing telemetry of the previous wake cycles
+    if (timing_report_due())
+    {
+        LoraEncoder timingEncoder(&msg_buf[0][FrameCodec::PreambleSize + FrameCodec::HeaderSize]);
+        appLayer.getTimingPayload(FrameCodec::PortTiming, timingEncoder);
+        transmitFrame(msg_buf[0], FrameCodec::PortTiming, chip_id, timingEncoder.getLength());
+        timing_reset();
+    }
 
-    for (int i = 0; i < uplinkSize + 6; i++)
+    // Heap/stack diagnostics of the previous and the current wake cycle
+    diag_sample(DIAG_SLEEP);
+    if (diag_report_due())
     {
-        msg_buf[preamble_size + i] ^= 0xAA;
+        LoraEncoder diagEncoder(&msg_buf[0][FrameCodec::PreambleSize + FrameCodec::HeaderSize]);
+        appLayer.getDiagPayload(FrameCodec::PortDiag, diagEncoder);
+        transmitFrame(msg_buf[0], FrameCodec::PortDiag, chip_id, diagEncoder.getLength());
+        diag_reset();
     }
 
-    uint8_t msg_size = preamble_size + 6 + uplinkSize;
-    log_i("%s Transmitting packet (%d bytes)... ", TRANSCEIVER_CHIP, msg_size);
-    log_message("TX-Data", msg_buf, msg_size);
-    state = radio.transmit(msg_buf, msg_size);
+#if PAYLOAD_FORMAT == 3
+    // Keyframe acknowledgement - after the last transmission (changes the radio settings)
+    if (appLayer.ackPending())
+    {
+        receiveAck(chip_id);
+    }
+#endif
 
-    if (state == RADIOLIB_ERR_NONE)
+    TRACE_VAL(TRACE_SLEEP, (uint32_t)SLEEP_INTERVAL);
+#if defined(ENABLE_TRACE)
+    // Dump trace to debug output (Serial is used for Modbus via USB)
+    if (modbusRS485)
     {
-        // the packet was successfully transmitted
-        log_i("success!");
+        Serial.begin(115200);
+        TRACE_DUMP(Serial);
+        Serial.flush();
     }
-    else if (state == RADIOLIB_ERR_PACKET_TOO_LONG)
+    else
     {
-        // the supplied packet was longer than 256 bytes
-        log_e("too long!");
+        TRACE_DUMP(DEBUG_PORT);
+        DEBUG_PORT.flush();
     }
-    else if (state == RADIOLIB_ERR_TX_TIMEOUT)
+#endif
+#if defined(MODBUS_CAPTURE)
+    // Dump Modbus transactions to debug output (Serial is used for Modbus via USB)
+    if (modbusRS485)
     {
-        // timeout occurred while transmitting packet
-        log_e("timeout!");
+        Serial.begin(115200);
+        growattInterface.dumpCapture(Serial);
+        Serial.flush();
     }
     else
     {
-        // some other error occurred
-        log_e("failed, code %d", state);
+        growattInterface.dumpCapture(DEBUG_PORT);
+        DEBUG_PORT.flush();
     }
+#endif
 
+    timing_end();
     ESP.deepSleep(SLEEP_INTERVAL * 1000000L);
 }
 
@@ -0,0 +1,338 @@
+///////////////////////////////////////////////////////////////////////////////
+// gw_bench.cpp
+//
+// Host build - microbenchmarks for the encode, decode, digest and
+// register-decode hot paths
+//
+// Each benchmark runs a fixed number of iterations on fixed input data,
+// repeated several times; the fastest repetition is reported in ns/op.
+// Heap usage is reported in B/op (bytes allocated) and allocs/op.
+//
+// Usage: gw_bench [options] [filter]
+//   --baseline <file>   compare against baseline file
+//   --threshold <x>     max. tolerated slowdown vs. baseline (default: 0.25 = 25%)
+//   --update <file>     write results to baseline file
+//
+// Returns 1 if any benchmark is slower than baseline * (1 + threshold) or
+// allocates more heap memory than the baseline.
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#define RX_TIMEOUT 0
+#include <assert.h>
+#include <chrono>
+#include <new>
+#include <map>
+#include <string>
+#include "host.h"
+
+// Arduino generates prototypes for functions in .ino files
+void mqtt_connect(void);
+
+#include "../../../examples/gw_receiver/gw_receiver.ino"
+#include <AppLayer.h>
+#include <growattInterface.h>
+#include "GrowattSlave.h"
+
+/// Modbus interface select: 0 - USB / 1 - RS485
+bool modbusRS485 = true;
+
+extern growattIF growattInterface;
+
+// ------------------------------------------------------------------------------------------------
+// --- Heap allocation counter ---
+// ------------------------------------------------------------------------------------------------
+static size_t heapBytes;
+static size_t heapAllocs;
+
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void *operator new(size_t size)
+{
+    heapBytes += size;
+    heapAllocs++;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+// ------------------------------------------------------------------------------------------------
+// --- Fixture ---
+// ------------------------------------------------------------------------------------------------
+namespace
+{
+    GrowattSlave inverter;
+    GrowattSlaveDevice inverterDevice(inverter);
+    AppLayer appLayer;
+
+    // Port 1 frame as transmitted (preamble, sync, header, payload)
+    uint8_t txFrame[64];
+    uint8_t txFrameSize;
+
+    // Port 1 frame as received (last sync byte, header, payload; see getMessage())
+    uint8_t rxFrame[MSG_BUF_SIZE];
+
+    volatile uint32_t sink;
+
+    void setupFixture(void)
+    {
+        Serial2.hostAttach(&inverterDevice);
+
+        LoraEncoder encoder(&txFrame[FrameCodec::PreambleSize + FrameCodec::HeaderSize]);
+        appLayer.getPayloadStage2(1, encoder);
+        uint8_t preambleSize = FrameCodec::begin(txFrame);
+        txFrameSize = preambleSize + FrameCodec::encode(&txFrame[preambleSize], FrameCodec::PortData, 0x00C3D4E5, encoder.getLength());
+
+        memset(rxFrame, 0, sizeof(rxFrame));
+        memcpy(rxFrame, &txFrame[preambleSize - 1], min<size_t>(txFrameSize - preambleSize + 1, sizeof(rxFrame)));
+    }
+
+    // --------------------------------------------------------------------------------------------
+    // --- Benchmarks ---
+    // --------------------------------------------------------------------------------------------
+    void benchDigest(void)
+    {
+        sink = lfsr_digest16<0x8005, 0xba95>(&txFrame[FrameCodec::PreambleSize + 2], txFrameSize - FrameCodec::PreambleSize - 2);
+    }
+
+    void benchDigestRef(void)
+    {
+        sink = lfsr_digest16(&txFrame[FrameCodec::PreambleSize + 2], txFrameSize - FrameCodec::PreambleSize - 2, 0x8005, 0xba95);
+    }
+
+    void benchPayloadStage2(void)
+    {
+        uint8_t buf[64];
+        LoraEncoder encoder(buf);
+        appLayer.getPayloadStage2(1, encoder);
+        sink = encoder.getLength();
+    }
+
+    void benchFrameEncode(void)
+    {
+        uint8_t buf[64];
+        memcpy(buf, txFrame, txFrameSize);
+        sink = FrameCodec::encode(&buf[FrameCodec::PreambleSize], FrameCodec::PortData, 0x00C3D4E5, txFrameSize - FrameCodec::PreambleSize - FrameCodec::HeaderSize);
+    }
+
+    void benchDecodeMessage(void)
+    {
+        uint8_t buf[MSG_BUF_SIZE];
+        memcpy(buf, rxFrame, sizeof(buf));
+        sink = decodeMessage(&buf[1], sizeof(buf) - 1);
+        assert(sink == DECODE_OK);
+    }
+
+    void benchReadInputRegisters(void)
+    {
+        sink = growattInterface.ReadInputRegisters(NULL, 0);
+        assert(sink == growattInterface.Success);
+    }
+
+    void benchReadHoldingRegisters(void)
+    {
+        sink = growattInterface.ReadHoldingRegisters(NULL, 0);
+        assert(sink == growattInterface.Success);
+    }
+
+    void benchInputJson(void)
+    {
+        char json[768];
+        sink = growattInterface.inputJson(json, sizeof(json));
+        assert(sink > 0);
+    }
+
+    void benchHoldingJson(void)
+    {
+        char json[768];
+        sink = growattInterface.holdingJson(json, sizeof(json));
+        assert(sink > 0);
+    }
+
+    void benchLogMessage(void)
+    {
+        log_message("TX-Data", txFrame, txFrameSize);
+    }
+
+    struct Benchmark
+    {
+        const char *name;
+        unsigned iterations;
+        void (*run)(void);
+    };
+
+    const Benchmark benchmarks[] = {
+        {"lfsr_digest16", 200000, benchDigest},
+        {"lfsr_digest16_ref", 20000, benchDigestRef},
+        {"FrameCodec::encode", 200000, benchFrameEncode},
+        {"AppLayer::getPayloadStage2", 5000, benchPayloadStage2},
+        {"growattIF::ReadInputRegisters", 5000, benchReadInputRegisters},
+        {"growattIF::ReadHoldingRegisters", 5000, benchReadHoldingRegisters},
+        {"growattIF::inputJson", 20000, benchInputJson},
+        {"growattIF::holdingJson", 20000, benchHoldingJson},
+        {"decodeMessage+serializeJson", 20000, benchDecodeMessage},
+        {"log_message", 20000, benchLogMessage},
+    };
+
+    const int Repetitions = 5;
+
+    struct Result
+    {
+        double nsPerOp;
+        double bytesPerOp;
+        double allocsPerOp;
+    };
+
+    Result runBenchmark(const Benchmark &b)
+    {
+        typedef std::chrono::steady_clock Clock;
+        Result r = {1e99, 0, 0};
+
+        // Warm-up
+        for (unsigned i = 0; i < b.iterations / 10; i++)
+            b.run();
+
+        for (int rep = 0; rep < Repetitions; rep++)
+        {
+            heapBytes = 0;
+            heapAllocs = 0;
+            Clock::time_point start = Clock::now();
+            for (unsigned i = 0; i < b.iterations; i++)
+                b.run();
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            r.nsPerOp = min(r.nsPerOp, ns / b.iterations);
+            r.bytesPerOp = (double)heapBytes / b.iterations;
+            r.allocsPerOp = (double)heapAllocs / b.iterations;
+        }
+        return r;
+    }
+
+    std::map<std::string, Result> readBaseline(const char *path)
+    {
+        std::map<std::string, Result> baseline;
+        FILE *f = fopen(path, "r");
+        if (!f)
+        {
+            perror(path);
+            return baseline;
+        }
+        char line[256];
+        while (fgets(line, sizeof(line), f))
+        {
+            char name[128];
+            Result r;
+            if (line[0] == '#')
+                continue;
+            if (sscanf(line, "%127s %lf %lf %lf", name, &r.nsPerOp, &r.bytesPerOp, &r.allocsPerOp) == 4)
+                baseline[name] = r;
+        }
+        fclose(f);
+        return baseline;
+    }
+
+    void usage(const char *prog)
+    {
+        fprintf(stderr, "Usage: %s [--baseline <file>] [--threshold <x>] [--update <file>] [filter]\n", prog);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *baselinePath = nullptr;
+    const char *updatePath = nullptr;
+    const char *filter = nullptr;
+    double threshold = 0.25;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--baseline") && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "--threshold") && i + 1 < argc)
+            threshold = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--update") && i + 1 < argc)
+            updatePath = argv[++i];
+        else if (argv[i][0] != '-')
+            filter = argv[i];
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    host::setVirtualTime(true);
+    host::setLogFile(nullptr);
+    setupFixture();
+
+    std::map<std::string, Result> baseline;
+    if (baselinePath)
+        baseline = readBaseline(baselinePath);
+
+    FILE *update = nullptr;
+    if (updatePath)
+    {
+        update = fopen(updatePath, "w");
+        if (!update)
+        {
+            perror(updatePath);
+            return 2;
+        }
+        fprintf(update, "# growatt2radio host benchmark baseline - written by gw_bench --update\n");
+        fprintf(update, "# %-38s %12s %10s %10s\n", "name", "ns/op", "B/op", "allocs/op");
+    }
+
+    printf("%-40s %12s %10s %10s %14s %8s\n", "benchmark", "ns/op", "B/op", "allocs/op", "baseline ns/op", "delta");
+
+    int regressions = 0;
+    for (const Benchmark &b : benchmarks)
+    {
+        if (filter && !strstr(b.name, filter))
+            continue;
+
+        Result r = runBenchmark(b);
+        printf("%-40s %12.1f %10.1f %10.2f", b.name, r.nsPerOp, r.bytesPerOp, r.allocsPerOp);
+
+        auto base = baseline.find(b.name);
+        if (base != baseline.end())
+        {
+            double delta = r.nsPerOp / base->second.nsPerOp - 1.0;
+            bool slower = delta > threshold;
+            bool moreHeap = r.bytesPerOp > base->second.bytesPerOp;
+            printf(" %14.1f %+7.1f%%%s%s", base->second.nsPerOp, delta * 100.0, slower ? "  SLOWER" : "",
+                   moreHeap ? "  MORE HEAP" : "");
+            if (slower || moreHeap)
+                regressions++;
+        }
+        else if (baselinePath)
+        {
+            printf(" %14s", "(new)");
+        }
+        printf("\n");
+
+        if (update)
+            fprintf(update, "%-40s %12.1f %10.1f %10.2f\n", b.name, r.nsPerOp, r.bytesPerOp, r.allocsPerOp);
+    }
+
+    if (update)
+        fclose(update);
+
+    if (regressions)
+    {
+        printf("%d regression(s) exceeding threshold of %.0f%%\n", regressions, threshold * 100.0);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// gw_receiver_host.cpp
+//
+// Host build - runs examples/gw_receiver on Linux
+//
+// Frames are read from "TX-Data: XX XX ..." lines (as printed by
+// gw_transmitter_host or by gw_transmitter's debug log) and received
+// one per wake cycle; further inverters' data frames and telemetry frames
+// following the first inverter's data frame are received in the same wake cycle.
+// Published MQTT messages are printed to stdout.
+//
+// Usage: gw_receiver_host [file] (default: stdin)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#define RX_TIMEOUT 10000 // no need to wait for the next frame
+#include "host.h"
+#include <RadioLib.h>
+
+// Arduino generates prototypes for functions in .ino files
+void mqtt_connect(void);
+
+#include "../../examples/gw_receiver/gw_receiver.ino"
+
+// Check if a "TX-Data:" frame (preamble, sync word, frame) starts a wake cycle,
+// i.e. is the data frame of the first inverter
+static bool frameStartsCycle(const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> frame(data.begin() + min(data.size(), (size_t)FrameCodec::PreambleSize), data.end());
+    // Room for a frame without payload length (see FrameCodec::decode())
+    if (frame.size() < FrameCodec::HeaderSize + FrameCodec::PayloadSize)
+        frame.resize(FrameCodec::HeaderSize + FrameCodec::PayloadSize);
+    if (!FrameCodec::decode(frame.data(), frame.size()))
+        return false;
+    return FrameCodec::getPort(frame.data()) == FrameCodec::PortData && FrameCodec::getIndex(frame.data()) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *in = stdin;
+    if (argc > 1)
+    {
+        in = fopen(argv[1], "r");
+        if (!in)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    host::setVirtualTime(true);
+
+    std::vector<std::vector<uint8_t>> frames;
+    char line[1024];
+    std::vector<uint8_t> data;
+    while (fgets(line, sizeof(line), in))
+    {
+        if (host::parseHexLine(line, "TX-Data:", data))
+            frames.push_back(data);
+    }
+
+    // One wake cycle per frame, data frame and subsequent telemetry frames in the same cycle
+    unsigned cycle = 0;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        host::radioQueue(frames[i].data(), frames[i].size());
+        bool data = frameStartsCycle(frames[i]);
+        while (data && i + 1 < frames.size() && !frameStartsCycle(frames[i + 1]))
+        {
+            i++;
+            host::radioQueue(frames[i].data(), frames[i].size());
+        }
+        cycle++;
+        if (host::runWakeCycles(1, setup) != 0)
+            return cycle;
+        host::radioClear();
+    }
+
+    return 0;
+}
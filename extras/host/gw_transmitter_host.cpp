@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// gw_transmitter_host.cpp
+//
+// Host build - runs examples/gw_transmitter on Linux
+//
+// Each wake cycle runs setup() until ESP.deepSleep(). Transmitted frames are
+// printed to stdout as "TX-Data: XX XX ..." lines, which can be piped into
+// gw_receiver_host. The awake time of each cycle is printed to stderr.
+//
+// Usage: gw_transmitter_host [--inverter | --modbus <tty> | --replay <file>] [--ack <file>] [cycles]
+//   --inverter      connect Serial2 to the in-process inverter model(s) (see GROWATT_SLAVE_IDS)
+//   --replay <file> answer requests with the responses captured in <file>
+//                   ("MODBUS: ..." lines, see MODBUS_CAPTURE in growatt_cfg.h)
+//   --modbus <tty>  connect Serial2 to a tty (e.g. gw_inverter_emu or a USB RS485 adapter)
+//                   and run in real time (otherwise in virtual time)
+//   (neither)       no inverter connected - all requests time out
+//   --ack <file>    frames received in each wake cycle, e.g. the keyframe acknowledgements
+//                   ("TX-Data: ..." lines printed by gw_receiver_host, payload format 3)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "../../examples/gw_transmitter/gw_transmitter.ino"
+#include "host.h"
+#include "GrowattSlave.h"
+#include "ModbusReplay.h"
+#include <growattInterface.h>
+#include <vector>
+
+static void printAwakeTime(unsigned cycle, uint64_t awake_us)
+{
+    fprintf(stderr, "Wake cycle %u: awake %.1f ms\n", cycle, awake_us / 1000.0);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned cycles = 1;
+    bool inverter = false;
+    const char *modbusTty = nullptr;
+    const char *replayPath = nullptr;
+    const char *ackPath = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--inverter"))
+            inverter = true;
+        else if (!strcmp(argv[i], "--modbus") && i + 1 < argc)
+            modbusTty = argv[++i];
+        else if (!strcmp(argv[i], "--replay") && i + 1 < argc)
+            replayPath = argv[++i];
+        else if (!strcmp(argv[i], "--ack") && i + 1 < argc)
+            ackPath = argv[++i];
+        else if (isdigit((unsigned char)argv[i][0]))
+            cycles = atoi(argv[i]);
+        else
+        {
+            fprintf(stderr, "Usage: %s [--inverter | --modbus <tty> | --replay <file>] [--ack <file>] [cycles]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // Queued in the parent process, i.e. received in each wake cycle
+    if (ackPath)
+    {
+        FILE *in = fopen(ackPath, "r");
+        if (!in)
+        {
+            perror(ackPath);
+            return 1;
+        }
+        char line[1024];
+        std::vector<uint8_t> data;
+        while (fgets(line, sizeof(line), in))
+        {
+            if (host::parseHexLine(line, "TX-Data:", data))
+                host::radioQueue(data.data(), data.size());
+        }
+        fclose(in);
+    }
+
+    // INTERFACE_SEL low: Modbus via RS485 (Serial2), keeps Modbus traffic off stdout
+    host::setPinLevel(INTERFACE_SEL, LOW);
+
+    // One inverter model per slave ID on the bus
+    static const uint8_t slaveIds[] = GROWATT_SLAVE_IDS;
+    std::vector<GrowattSlave> slaves(slaveIds, slaveIds + sizeof(slaveIds));
+    GrowattSlaveDevice slaveDevice(slaves[0]);
+    for (size_t i = 1; i < slaves.size(); i++)
+        slaveDevice.add(slaves[i]);
+    if (modbusTty)
+    {
+        if (!Serial2.hostOpen(modbusTty))
+            return 1;
+        return host::runWakeCycles(cycles, setup, printAwakeTime);
+    }
+    if (inverter)
+        Serial2.hostAttach(&slaveDevice);
+
+    std::vector<ModbusTransaction> capture;
+    ModbusReplayDevice replayDevice(capture);
+    if (replayPath)
+    {
+        FILE *in = fopen(replayPath, "r");
+        if (!in)
+        {
+            perror(replayPath);
+            return 1;
+        }
+        fprintf(stderr, "%zu captured transactions\n", loadModbusCapture(in, capture));
+        fclose(in);
+        Serial2.hostAttach(&replayDevice);
+    }
+
+    host::setVirtualTime(true);
+    return host::runWakeCycles(cycles, setup, printAwakeTime);
+}
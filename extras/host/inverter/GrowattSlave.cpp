@@ -0,0 +1,213 @@
+///////////////////////////////////////////////////////////////////////////////
+// GrowattSlave.cpp
+//
+// Host build - Growatt inverter Modbus RTU slave model
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "GrowattSlave.h"
+
+namespace
+{
+    const uint8_t FcReadHolding = 0x03;
+    const uint8_t FcReadInput = 0x04;
+    const uint8_t FcWriteSingle = 0x06;
+
+    const uint8_t ExIllegalFunction = 0x01;
+    const uint8_t ExIllegalDataAddress = 0x02;
+    const uint8_t ExIllegalDataValue = 0x03;
+
+    // Store ASCII string in registers (two characters per register, first character in high byte)
+    void setString(uint16_t *regs, const char *s, size_t chars)
+    {
+        for (size_t i = 0; i < chars; i += 2)
+        {
+            regs[i / 2] = (static_cast<uint8_t>(s[i]) << 8) | static_cast<uint8_t>(s[i + 1]);
+        }
+    }
+}
+
+GrowattSlave::GrowattSlave(uint8_t slaveId) : slaveId(slaveId)
+{
+    loadDefaults();
+}
+
+void GrowattSlave::setInput32(uint16_t reg, uint32_t value)
+{
+    input[reg] = value >> 16;
+    input[reg + 1] = value & 0xFFFF;
+}
+
+void GrowattSlave::loadDefaults(void)
+{
+    memset(input, 0, sizeof(input));
+    memset(holding, 0, sizeof(holding));
+
+    // Input registers (scale factors see growattIF::ReadInputRegisters())
+    input[0] = 1;            // status: normal
+    setInput32(1, 6200);     // solarpower       620.0 W
+    input[3] = 800;          // pv1voltage        80.0 V
+    input[4] = 78;           // pv1current         7.8 A
+    setInput32(5, 6200);     // pv1power         620.0 W
+    setInput32(35, 6000);    // outputpower      600.0 W
+    input[37] = 5000;        // gridfrequency    50.00 Hz
+    input[38] = 2300;        // gridvoltage      230.0 V
+    setInput32(53, 44);      // energytoday        4.4 kWh
+    setInput32(55, 55555);   // energytotal     5555.5 kWh
+    setInput32(57, 2469136); // totalworktime  1234568 s
+    setInput32(59, 46);      // pv1energytoday     4.6 kWh
+    setInput32(61, 56666);   // pv1energytotal  5666.6 kWh
+    input[93] = 255;         // tempinverter      25.5 °C
+    input[94] = 261;         // tempipm           26.1 °C
+    input[95] = 248;         // tempboost         24.8 °C
+    input[100] = 10000;      // ipf
+    input[101] = 100;        // realoppercent
+    setInput32(102, 6000);   // opfullpower      600.0 W
+    input[42] = 2310;        // gridvoltage2     231.0 V (MOD/MAX)
+    input[46] = 2290;        // gridvoltage3     229.0 V (MOD/MAX)
+    setInput32(1009, 1500);  // dischargepower   150.0 W (SPH)
+    setInput32(1011, 0);     // chargepower        0.0 W (SPH)
+    input[1013] = 512;       // batteryvoltage    51.2 V (SPH)
+    input[1014] = 87;        // soc                 87 % (SPH)
+
+    // Holding registers (see growattIF::ReadHoldingRegisters())
+    holding[0] = 1;          // enable
+    holding[3] = 100;        // maxoutputactivepp   100 %
+    holding[4] = 100;        // maxoutputreactivepp 100 %
+    holding[6] = 0;          // maxpower        600.0 W
+    holding[7] = 6000;
+    holding[8] = 2300;       // voltnormal      230.0 V
+    setString(&holding[9], "GH1.0 ", 6);       // firmware
+    setString(&holding[12], "ZAAA  ", 6);      // controlfirmware
+    holding[17] = 800;       // startvoltage     80.0 V
+    setString(&holding[23], "AB12345678", 10); // serial
+    holding[52] = 1840;      // gridvoltlowlimit      184.0 V
+    holding[53] = 2530;      // gridvolthighlimit     253.0 V
+    holding[54] = 4750;      // gridfreqlowlimit      47.50 Hz
+    holding[55] = 5150;      // gridfreqhighlimit     51.50 Hz
+    holding[64] = 1960;      // gridvoltlowconnlimit  196.0 V
+    holding[65] = 2530;      // gridvolthighconnlimit 253.0 V
+    holding[66] = 4750;      // gridfreqlowconnlimit  47.50 Hz
+    holding[67] = 5005;      // gridfreqhighconnlimit 50.05 Hz
+    holding[121] = 0x0006;   // modul
+}
+
+uint16_t GrowattSlave::crc16(const uint8_t *data, size_t size)
+{
+    uint16_t crc = 0xFFFF;
+    while (size--)
+    {
+        crc ^= *data++;
+        for (int i = 0; i < 8; ++i)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+    }
+    return crc;
+}
+
+size_t GrowattSlave::finish(uint8_t *resp, size_t size)
+{
+    uint16_t crc = crc16(resp, size);
+    resp[size++] = crc & 0xFF;
+    resp[size++] = crc >> 8;
+    return size;
+}
+
+size_t GrowattSlave::exception(uint8_t function, uint8_t code, uint8_t *resp)
+{
+    resp[0] = slaveId;
+    resp[1] = function | 0x80;
+    resp[2] = code;
+    return finish(resp, 3);
+}
+
+bool GrowattSlave::inject(double probability)
+{
+    return (probability > 0) && (std::uniform_real_distribution<double>(0, 1)(_rng) < probability);
+}
+
+size_t GrowattSlave::process(const uint8_t *req, size_t reqSize, uint8_t *resp)
+{
+    if (reqSize < 4 || req[0] != slaveId)
+    {
+        stats.ignored++;
+        return 0;
+    }
+    uint16_t crc = req[reqSize - 2] | (req[reqSize - 1] << 8);
+    if (crc16(req, reqSize - 2) != crc)
+    {
+        stats.ignored++;
+        return 0;
+    }
+    stats.requests++;
+
+    if (inject(faults.timeout))
+    {
+        stats.timeouts++;
+        return 0;
+    }
+
+    size_t size = inject(faults.illegalAddress) ? exception(req[1], ExIllegalDataAddress, resp) : handle(req, reqSize, resp);
+    if (resp[1] & 0x80)
+        stats.exceptions++;
+
+    if (inject(faults.crcError))
+    {
+        stats.crcErrors++;
+        resp[size - 1] ^= 0x5A;
+    }
+    return size;
+}
+
+size_t GrowattSlave::handle(const uint8_t *req, size_t reqSize, uint8_t *resp)
+{
+    uint8_t function = req[1];
+    if (function != FcReadHolding && function != FcReadInput && function != FcWriteSingle)
+        return exception(function, ExIllegalFunction, resp);
+    if (reqSize != 8)
+        return exception(function, ExIllegalDataValue, resp);
+
+    uint16_t addr = (req[2] << 8) | req[3];
+    uint16_t value = (req[4] << 8) | req[5];
+
+    if (function == FcWriteSingle)
+    {
+        if (addr >= NumHoldingRegs)
+            return exception(function, ExIllegalDataAddress, resp);
+        holding[addr] = value;
+        stats.writes++;
+        memcpy(resp, req, 6);
+        return finish(resp, 6);
+    }
+
+    const uint16_t *regs = (function == FcReadInput) ? input : holding;
+    uint16_t numRegs = (function == FcReadInput) ? NumInputRegs : NumHoldingRegs;
+    if (value == 0 || value > MaxRequestQty)
+        return exception(function, ExIllegalDataValue, resp);
+    if (addr + value > numRegs)
+        return exception(function, ExIllegalDataAddress, resp);
+
+    size_t size = 0;
+    resp[size++] = slaveId;
+    resp[size++] = function;
+    resp[size++] = value * 2;
+    for (uint16_t i = 0; i < value; i++)
+    {
+        resp[size++] = regs[addr + i] >> 8;
+        resp[size++] = regs[addr + i] & 0xFF;
+    }
+    return finish(resp, size);
+}
+
+void GrowattSlaveDevice::onReceive(HardwareSerial &port, const uint8_t *data, size_t size)
+{
+    uint8_t resp[GrowattSlave::MaxAduSize];
+    for (size_t i = 0; i < _count; i++)
+    {
+        size_t respSize = _slaves[i]->process(data, size, resp);
+        if (respSize)
+            port.hostFeed(resp, respSize);
+    }
+}
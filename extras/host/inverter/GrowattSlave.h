@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+// GrowattSlave.h
+//
+// Host build - Growatt inverter Modbus RTU slave model
+//
+// Register image with the layout expected by growattIF (input registers
+// 0..1124 incl. the registers of all inverter families, holding registers
+// 0..191) and Modbus RTU request processing
+// for function codes 0x03, 0x04 and 0x06, with optional fault injection.
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_GROWATT_SLAVE_H)
+#define _GROWATT_SLAVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <random>
+#include <HardwareSerial.h>
+
+/*!
+ * \brief Growatt inverter Modbus RTU slave
+ */
+class GrowattSlave
+{
+public:
+    static const uint16_t NumInputRegs = 1125;
+    static const uint16_t NumHoldingRegs = 192;
+    static const uint16_t MaxRequestQty = 125;
+    static const size_t MaxAduSize = 256;
+
+    /*!
+     * \brief Fault injection - probability per request (0..1)
+     */
+    struct Faults
+    {
+        double timeout = 0;        //!< no response
+        double crcError = 0;       //!< response with corrupted CRC
+        double illegalAddress = 0; //!< exception response "illegal data address"
+    };
+
+    /*!
+     * \brief Statistics
+     */
+    struct Stats
+    {
+        unsigned requests = 0;   //!< requests addressed to this slave with valid CRC
+        unsigned ignored = 0;    //!< requests ignored (CRC error, other slave ID)
+        unsigned timeouts = 0;   //!< injected timeouts
+        unsigned crcErrors = 0;  //!< injected CRC errors
+        unsigned exceptions = 0; //!< exception responses (incl. injected)
+        unsigned writes = 0;     //!< holding register writes
+    };
+
+    uint8_t slaveId;
+    uint16_t input[NumInputRegs];
+    uint16_t holding[NumHoldingRegs];
+    Faults faults;
+    Stats stats;
+
+    /*!
+     * \brief Constructor - loads a plausible register image
+     */
+    explicit GrowattSlave(uint8_t slaveId = 1);
+
+    /// Load default register image (inverter feeding ~600 W)
+    void loadDefaults(void);
+
+    /// Set 32-bit value in two consecutive input registers (high word first)
+    void setInput32(uint16_t reg, uint32_t value);
+
+    /*!
+     * \brief Process Modbus RTU request
+     *
+     * Requests with wrong CRC or slave ID are ignored (no response).
+     *
+     * \param req request ADU
+     * \param reqSize request size in bytes
+     * \param resp response ADU buffer (MaxAduSize bytes)
+     *
+     * \returns response size in bytes (0: no response)
+     */
+    size_t process(const uint8_t *req, size_t reqSize, uint8_t *resp);
+
+    /// Seed random generator for fault injection
+    void seed(unsigned value) { _rng.seed(value); }
+
+    /// Modbus RTU CRC-16
+    static uint16_t crc16(const uint8_t *data, size_t size);
+
+private:
+    std::mt19937 _rng;
+
+    bool inject(double probability);
+    size_t handle(const uint8_t *req, size_t reqSize, uint8_t *resp);
+    size_t exception(uint8_t function, uint8_t code, uint8_t *resp);
+    size_t finish(uint8_t *resp, size_t size);
+};
+
+/*!
+ * \brief GrowattSlave(s) attached to a host serial port
+ *
+ * Responds immediately to each request written to the port. Several slaves
+ * with different slave IDs can share the port (like inverters on an RS485 bus).
+ */
+class GrowattSlaveDevice : public HostSerialDevice
+{
+public:
+    static const size_t MaxSlaves = 16;
+
+    explicit GrowattSlaveDevice(GrowattSlave &slave) { add(slave); }
+
+    /// Add slave to the bus (ignored if MaxSlaves are attached)
+    void add(GrowattSlave &slave)
+    {
+        if (_count < MaxSlaves)
+            _slaves[_count++] = &slave;
+    }
+
+    void onReceive(HardwareSerial &port, const uint8_t *data, size_t size) override;
+
+private:
+    GrowattSlave *_slaves[MaxSlaves];
+    size_t _count = 0;
+};
+
+#endif // _GROWATT_SLAVE_H
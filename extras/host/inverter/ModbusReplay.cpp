@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// ModbusReplay.cpp
+//
+// Host build - Modbus transactions captured by growattIF::dumpCapture()
+// (MODBUS_CAPTURE): parser and replay device
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <Arduino.h>
+#include "host.h"
+#include "ModbusReplay.h"
+
+namespace
+{
+    // Dump line header: txStart, txEnd, rxFirst, rxLast (4 bytes each), result, reqSize, rspSize
+    const size_t HeaderSize = 19;
+
+    uint32_t le32(const uint8_t *p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    // Next transaction to be replayed; kept across wake cycles
+    RTC_DATA_ATTR size_t replayNext;
+}
+
+bool parseModbusCapture(const char *line, ModbusTransaction &t)
+{
+    std::vector<uint8_t> data;
+
+    if (!host::parseHexLine(line, "MODBUS:", data) || data.size() < HeaderSize)
+        return false;
+
+    const uint8_t *d = data.data();
+    uint8_t reqSize = d[17];
+    uint8_t rspSize = d[18];
+    if (data.size() != HeaderSize + reqSize + rspSize)
+        return false;
+
+    t.txStart = le32(&d[0]);
+    t.txEnd = le32(&d[4]);
+    t.rxFirst = le32(&d[8]);
+    t.rxLast = le32(&d[12]);
+    t.result = d[16];
+    t.req.assign(&d[HeaderSize], &d[HeaderSize] + reqSize);
+    t.rsp.assign(&d[HeaderSize + reqSize], &d[HeaderSize + reqSize] + rspSize);
+    return true;
+}
+
+size_t loadModbusCapture(FILE *in, std::vector<ModbusTransaction> &log)
+{
+    char line[1024];
+    ModbusTransaction t;
+
+    while (fgets(line, sizeof(line), in))
+    {
+        if (parseModbusCapture(line, t))
+            log.push_back(t);
+    }
+    return log.size();
+}
+
+void ModbusReplayDevice::onReceive(HardwareSerial &port, const uint8_t *data, size_t size)
+{
+    for (size_t i = replayNext; i < _log.size(); i++)
+    {
+        const ModbusTransaction &t = _log[i];
+        if ((t.req.size() == size) && !memcmp(t.req.data(), data, size))
+        {
+            if (!t.rsp.empty())
+                port.hostFeed(t.rsp.data(), t.rsp.size());
+            replayNext = i + 1;
+            return;
+        }
+    }
+}
+
+size_t ModbusReplayDevice::remaining() const
+{
+    return (replayNext < _log.size()) ? _log.size() - replayNext : 0;
+}
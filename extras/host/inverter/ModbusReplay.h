@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+// ModbusReplay.h
+//
+// Host build - Modbus transactions captured by growattIF::dumpCapture()
+// (MODBUS_CAPTURE): parser and replay device
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_MODBUS_REPLAY_H)
+#define _MODBUS_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include <HardwareSerial.h>
+
+/*!
+ * \brief Captured Modbus transaction (see growattIF::dumpCapture())
+ */
+struct ModbusTransaction
+{
+    uint32_t txStart = 0;      //!< request transmission started [µs]
+    uint32_t txEnd = 0;        //!< request transmitted [µs]
+    uint32_t rxFirst = 0;      //!< first response byte read [µs]
+    uint32_t rxLast = 0;       //!< last response byte read [µs]
+    uint8_t result = 0;        //!< Success or Modbus error code
+    std::vector<uint8_t> req;  //!< request frame
+    std::vector<uint8_t> rsp;  //!< response bytes received (may be incomplete)
+};
+
+/*!
+ * \brief Parse a "MODBUS: XX XX ..." line
+ *
+ * \returns false if the line does not contain a valid transaction
+ */
+bool parseModbusCapture(const char *line, ModbusTransaction &t);
+
+/*!
+ * \brief Read all transactions from a dump (e.g. a captured serial log)
+ *
+ * \returns no. of transactions
+ */
+size_t loadModbusCapture(FILE *in, std::vector<ModbusTransaction> &log);
+
+/*!
+ * \brief Replays captured responses on a host serial port
+ *
+ * Each request written to the port is answered by the response of the next
+ * captured transaction with the same request frame (in capture order);
+ * timeouts and incomplete or corrupted responses are replayed as captured.
+ * Requests without a matching transaction are not answered.
+ *
+ * The replay position is kept in RTC memory, i.e. it continues across the
+ * wake cycles of host::runWakeCycles().
+ */
+class ModbusReplayDevice : public HostSerialDevice
+{
+public:
+    explicit ModbusReplayDevice(const std::vector<ModbusTransaction> &log) : _log(log) {}
+
+    void onReceive(HardwareSerial &port, const uint8_t *data, size_t size) override;
+
+    /// Get no. of transactions not replayed yet
+    size_t remaining() const;
+
+private:
+    const std::vector<ModbusTransaction> &_log;
+};
+
+#endif // _MODBUS_REPLAY_H
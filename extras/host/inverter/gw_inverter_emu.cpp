@@ -0,0 +1,244 @@
+///////////////////////////////////////////////////////////////////////////////
+// gw_inverter_emu.cpp
+//
+// Host build - Growatt inverter Modbus RTU emulator on a pseudo-terminal
+//
+// Answers Modbus RTU requests (function codes 0x03, 0x04, 0x06) with the
+// register layout expected by growattIF. Bus timing (data rate, inverter
+// turnaround) and faults can be configured.
+//
+// Usage: gw_inverter_emu [options]
+//   --link <path>             create symlink to the pty (e.g. /tmp/ttyGrowatt)
+//   --slave <id>              Modbus slave ID (default: 1)
+//   --slaves <n>              no. of inverters on the bus, slave IDs <id>...<id>+<n>-1 (default: 1)
+//   --baud <rate>             emulated data rate, 0: no wire time (default: 9600)
+//   --latency <ms>            inverter turnaround time (default: 20)
+//   --timeout <p>             probability of not responding (default: 0)
+//   --crc-error <p>           probability of a corrupted response CRC (default: 0)
+//   --illegal-address <p>     probability of an illegal data address exception (default: 0)
+//   --seed <n>                random seed for fault injection (default: 1)
+//   --verbose                 print requests and responses
+//
+// Example:
+//   gw_inverter_emu --link /tmp/ttyGrowatt --timeout 0.1 &
+//   gw_transmitter_host --modbus /tmp/ttyGrowatt 10
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <growattInterface.h>
+#include "GrowattSlave.h"
+
+namespace
+{
+    volatile sig_atomic_t terminate = 0;
+
+    void onSignal(int)
+    {
+        terminate = 1;
+    }
+
+    void printHex(const char *descr, const uint8_t *data, size_t size)
+    {
+        printf("%s:", descr);
+        for (size_t i = 0; i < size; i++)
+            printf(" %02X", data[i]);
+        printf("\n");
+    }
+
+    /// Expected request size derived from the function code (0: unknown)
+    size_t requestSize(const uint8_t *req, size_t size)
+    {
+        if (size < 2)
+            return 0;
+        switch (req[1])
+        {
+        case 0x03:
+        case 0x04:
+        case 0x06:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    void usage(const char *prog)
+    {
+        fprintf(stderr,
+                "Usage: %s [--link <path>] [--slave <id>] [--slaves <n>] [--baud <rate>] [--latency <ms>]\n"
+                "       [--timeout <p>] [--crc-error <p>] [--illegal-address <p>] [--seed <n>] [--verbose]\n",
+                prog);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *link = nullptr;
+    unsigned baud = 9600;
+    unsigned latencyMs = 20;
+    bool verbose = false;
+    unsigned numSlaves = 1;
+    GrowattSlave slave(SLAVE_ID);
+
+    slave.seed(1);
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasArg = i + 1 < argc;
+        if (!strcmp(argv[i], "--link") && hasArg)
+            link = argv[++i];
+        else if (!strcmp(argv[i], "--slave") && hasArg)
+            slave.slaveId = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--slaves") && hasArg)
+            numSlaves = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--baud") && hasArg)
+            baud = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--latency") && hasArg)
+            latencyMs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--timeout") && hasArg)
+            slave.faults.timeout = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--crc-error") && hasArg)
+            slave.faults.crcError = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--illegal-address") && hasArg)
+            slave.faults.illegalAddress = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && hasArg)
+            slave.seed(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--verbose"))
+            verbose = true;
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    // Create pseudo-terminal
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        perror("posix_openpt");
+        return 1;
+    }
+    const char *ptyName = ptsname(master);
+
+    // Keep the slave side open in raw mode, so the pty persists while clients come and go
+    int keep = open(ptyName, O_RDWR | O_NOCTTY);
+    struct termios tio;
+    if (keep < 0 || tcgetattr(keep, &tio) != 0)
+    {
+        perror(ptyName);
+        return 1;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(keep, TCSANOW, &tio);
+
+    if (link)
+    {
+        unlink(link);
+        if (symlink(ptyName, link) != 0)
+        {
+            perror(link);
+            return 1;
+        }
+    }
+    // Inverters sharing the bus - same register image and fault injection, consecutive slave IDs
+    if (numSlaves < 1)
+        numSlaves = 1;
+    std::vector<GrowattSlave> slaves(numSlaves, slave);
+    for (unsigned i = 0; i < numSlaves; i++)
+        slaves[i].slaveId = slave.slaveId + i;
+
+    printf("Growatt inverter emulator (slave ID %u...%u) on %s%s%s\n", slaves.front().slaveId,
+           slaves.back().slaveId, ptyName, link ? " -> " : "", link ? link : "");
+    fflush(stdout);
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    // Inter-frame silence (3.5 character times, min. 1.75 ms)
+    double charTime = baud ? 11.0 / baud : 0;
+    int silenceMs = (int)(charTime * 3.5 * 1000.0 + 0.999);
+    if (silenceMs < 2)
+        silenceMs = 2;
+
+    uint8_t req[GrowattSlave::MaxAduSize];
+    uint8_t resp[GrowattSlave::MaxAduSize];
+    size_t reqSize = 0;
+
+    while (!terminate)
+    {
+        struct pollfd pfd = {master, POLLIN, 0};
+        int ready = poll(&pfd, 1, reqSize ? silenceMs : 200);
+        if (ready < 0)
+            break;
+
+        if (ready > 0)
+        {
+            ssize_t n = read(master, &req[reqSize], sizeof(req) - reqSize);
+            if (n > 0)
+                reqSize += n;
+            size_t expected = requestSize(req, reqSize);
+            if (!expected || reqSize < expected)
+                continue;
+        }
+        else if (reqSize == 0)
+        {
+            continue;
+        }
+        // Request complete (expected size received or inter-frame silence)
+
+        if (verbose)
+            printHex("REQ ", req, reqSize);
+
+        size_t respSize = 0;
+        for (size_t i = 0; i < slaves.size() && !respSize; i++)
+            respSize = slaves[i].process(req, reqSize, resp);
+
+        if (verbose && reqSize == 8 && req[1] == 0x06 && respSize && !(resp[1] & 0x80))
+        {
+            uint16_t reg = (req[2] << 8) | req[3];
+            uint16_t value = (req[4] << 8) | req[5];
+            const char *name = (reg == growattIF::regOnOff) ? "regOnOff" : (reg == growattIF::regMaxOutputActive) ? "regMaxOutputActive" : "";
+            printf("WRITE %u %s = %u\n", reg, name, value);
+        }
+
+        if (respSize)
+        {
+            // Request on the wire + turnaround + response on the wire
+            double delay = (reqSize + respSize) * charTime + latencyMs / 1000.0;
+            std::this_thread::sleep_for(std::chrono::duration<double>(delay));
+            if (write(master, resp, respSize) < 0)
+                perror("write");
+            if (verbose)
+                printHex("RESP", resp, respSize);
+        }
+        else if (verbose)
+        {
+            printf("RESP (none)\n");
+        }
+        fflush(stdout);
+        reqSize = 0;
+    }
+
+    if (link)
+        unlink(link);
+
+    for (const GrowattSlave &s : slaves)
+        printf("slave %u - requests: %u, ignored: %u, injected timeouts: %u, injected CRC errors: %u, exceptions: %u, writes: %u\n",
+               s.slaveId, s.stats.requests, s.stats.ignored, s.stats.timeouts, s.stats.crcErrors,
+               s.stats.exceptions, s.stats.writes);
+    close(keep);
+    close(master);
+    return 0;
+}
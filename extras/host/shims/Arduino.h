@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////
+// Arduino.h
+//
+// Host build shim - Arduino core API (subset of arduino-esp32 used by
+// growatt2radio)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_ARDUINO_H)
+#define _HOST_ARDUINO_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <algorithm>
+
+#include "WString.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::max;
+using std::min;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define LED_BUILTIN 2
+
+#define IRAM_ATTR
+#define PROGMEM
+#define F(string_literal) (string_literal)
+
+// Variables in RTC memory are preserved across simulated deep sleep cycles,
+// see host::runWakeCycles()
+#define RTC_DATA_ATTR __attribute__((section("rtc_data")))
+#define RTC_NOINIT_ATTR RTC_DATA_ATTR
+
+// Heap size reported by ESP.getHeapSize() (ESP32: ~320 KiB DRAM heap)
+#define HOST_HEAP_SIZE (320 * 1024)
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+class EspClass
+{
+public:
+    /// Ends the current wake cycle by throwing host::DeepSleep
+    [[noreturn]] void deepSleep(uint64_t time_us);
+    [[noreturn]] void restart(void);
+    uint64_t getEfuseMac(void);
+
+    // Heap of HOST_HEAP_SIZE bytes, used by the host's malloc() arena (no fragmentation model)
+    uint32_t getHeapSize(void);
+    uint32_t getFreeHeap(void);
+    uint32_t getMinFreeHeap(void);
+    uint32_t getMaxAllocHeap(void);
+};
+
+extern EspClass ESP;
+
+// SNTP is not available; the host's system time is used
+void configTime(long gmtOffset_sec, int daylightOffset_sec, const char *server1, const char *server2 = nullptr,
+                const char *server3 = nullptr);
+
+// Never set the host's system time
+int host_settimeofday(const struct timeval *tv, const void *tz);
+#define settimeofday host_settimeofday
+
+// ------------------------------------------------------------------------------------------------
+// --- Logging (format compatible to arduino-esp32) ---
+// ------------------------------------------------------------------------------------------------
+#define ARDUHAL_LOG_LEVEL_NONE (0)
+#define ARDUHAL_LOG_LEVEL_ERROR (1)
+#define ARDUHAL_LOG_LEVEL_WARN (2)
+#define ARDUHAL_LOG_LEVEL_INFO (3)
+#define ARDUHAL_LOG_LEVEL_DEBUG (4)
+#define ARDUHAL_LOG_LEVEL_VERBOSE (5)
+
+#if !defined(CORE_DEBUG_LEVEL)
+#define CORE_DEBUG_LEVEL ARDUHAL_LOG_LEVEL_NONE
+#endif
+
+void host_log(int level, const char *file, int line, const char *func, const char *format, ...);
+
+#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_ERROR
+#define log_e(format, ...) host_log(ARDUHAL_LOG_LEVEL_ERROR, __FILE__, __LINE__, __FUNCTION__, format, ##__VA_ARGS__)
+#else
+#define log_e(format, ...) do {} while (0)
+#endif
+#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_WARN
+#define log_w(format, ...) host_log(ARDUHAL_LOG_LEVEL_WARN, __FILE__, __LINE__, __FUNCTION__, format, ##__VA_ARGS__)
+#else
+#define log_w(format, ...) do {} while (0)
+#endif
+#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
+#define log_i(format, ...) host_log(ARDUHAL_LOG_LEVEL_INFO, __FILE__, __LINE__, __FUNCTION__, format, ##__VA_ARGS__)
+#else
+#define log_i(format, ...) do {} while (0)
+#endif
+#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
+#define log_d(format, ...) host_log(ARDUHAL_LOG_LEVEL_DEBUG, __FILE__, __LINE__, __FUNCTION__, format, ##__VA_ARGS__)
+#else
+#define log_d(format, ...) do {} while (0)
+#endif
+#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_VERBOSE
+#define log_v(format, ...) host_log(ARDUHAL_LOG_LEVEL_VERBOSE, __FILE__, __LINE__, __FUNCTION__, format, ##__VA_ARGS__)
+#else
+#define log_v(format, ...) do {} while (0)
+#endif
+
+#endif // _HOST_ARDUINO_H
@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+// ArduinoJson.h
+//
+// Host build shim - ArduinoJson (https://arduinojson.org)
+//
+// Flat JsonDocument with number and string members (subset used by gw_receiver).
+// Configure with -DGW_ARDUINOJSON_DIR=<path to ArduinoJson/src> to use the
+// real library instead.
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_ARDUINOJSON_H)
+#define _HOST_ARDUINOJSON_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+class JsonDocument
+{
+public:
+    class Member
+    {
+    public:
+        Member(JsonDocument &doc, const char *key) : _doc(doc), _key(key) {}
+
+        Member &operator=(float v) { return set(fmt("%.7g", (double)v)); }
+        Member &operator=(double v) { return set(fmt("%.15g", v)); }
+        Member &operator=(int v) { return set(fmt("%d", v)); }
+        Member &operator=(unsigned int v) { return set(fmt("%u", v)); }
+        Member &operator=(long v) { return set(fmt("%ld", v)); }
+        Member &operator=(unsigned long v) { return set(fmt("%lu", v)); }
+        Member &operator=(uint8_t v) { return set(fmt("%u", (unsigned)v)); }
+        Member &operator=(const char *v) { return set(quote(v)); }
+
+    private:
+        JsonDocument &_doc;
+        const char *_key;
+
+        static std::string fmt(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+        static std::string quote(const char *v)
+        {
+            std::string s = "\"";
+            for (; *v; v++)
+            {
+                if (*v == '"' || *v == '\\')
+                    s += '\\';
+                if ((uint8_t)*v < 0x20)
+                    s += fmt("\\u%04x", (unsigned)*v);
+                else
+                    s += *v;
+            }
+            return s + '"';
+        }
+
+        Member &set(const std::string &value)
+        {
+            for (auto &m : _doc._members)
+            {
+                if (m.first == _key)
+                {
+                    m.second = value;
+                    return *this;
+                }
+            }
+            _doc._members.emplace_back(_key, value);
+            return *this;
+        }
+    };
+
+    Member operator[](const char *key) { return Member(*this, key); }
+
+    /// Serialize to buf (truncated if too small); returns number of characters written
+    size_t serialize(char *buf, size_t size) const
+    {
+        std::string s = "{";
+        for (size_t i = 0; i < _members.size(); i++)
+        {
+            if (i)
+                s += ',';
+            s += '"' + _members[i].first + "\":" + _members[i].second;
+        }
+        s += '}';
+        if (size == 0)
+            return 0;
+        size_t n = std::min(s.size(), size - 1);
+        memcpy(buf, s.data(), n);
+        buf[n] = '\0';
+        return n;
+    }
+
+private:
+    std::vector<std::pair<std::string, std::string>> _members;
+};
+
+inline std::string JsonDocument::Member::fmt(const char *format, ...)
+{
+    char buf[32];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    return buf;
+}
+
+inline size_t serializeJson(const JsonDocument &doc, char *output, size_t size)
+{
+    return doc.serialize(output, size);
+}
+
+#endif // _HOST_ARDUINOJSON_H
@@ -0,0 +1,220 @@
+///////////////////////////////////////////////////////////////////////////////
+// HardwareSerial.cpp
+//
+// Host build shim - Arduino HardwareSerial
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <termios.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "HardwareSerial.h"
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(2);
+
+size_t Print::printf(const char *format, ...)
+{
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len < 0)
+        return 0;
+    return write(reinterpret_cast<const uint8_t *>(buf), (size_t)len < sizeof(buf) ? len : sizeof(buf) - 1);
+}
+
+void HardwareSerial::begin(unsigned long baud, uint32_t config, int8_t rxPin, int8_t txPin)
+{
+    (void)config;
+    (void)rxPin;
+    (void)txPin;
+    _baud = baud;
+
+    // Set data rate of bound tty (irrelevant for pseudo-terminals)
+    struct termios tio;
+    if (_fd >= 0 && tcgetattr(_fd, &tio) == 0)
+    {
+        speed_t speed = (baud == 9600) ? B9600 : (baud == 19200) ? B19200 : (baud == 38400) ? B38400 : B115200;
+        cfsetspeed(&tio, speed);
+        tcsetattr(_fd, TCSANOW, &tio);
+    }
+}
+
+bool HardwareSerial::hostOpen(const char *path)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0)
+    {
+        perror(path);
+        return false;
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    if (_fd >= 0)
+        close(_fd);
+    _fd = fd;
+    return true;
+}
+
+void HardwareSerial::pollTty(void)
+{
+    uint8_t buf[RxBufferSize];
+    size_t space = RxBufferSize - _rxCount;
+    if (_fd < 0 || space == 0)
+        return;
+    ssize_t n = ::read(_fd, buf, space);
+    if (n > 0)
+        hostFeed(buf, n);
+}
+
+void HardwareSerial::onReceive(OnReceiveCb function, bool onlyOnTimeout)
+{
+    _onReceive = function;
+    _onlyOnTimeout = onlyOnTimeout;
+}
+
+bool HardwareSerial::setRxTimeout(uint8_t symbols_timeout)
+{
+    _rxTimeout = symbols_timeout;
+    return true;
+}
+
+void HardwareSerial::checkRxEvent(void)
+{
+    if (!_rxEvent || !_onReceive)
+        return;
+    // RX timeout: no data for <_rxTimeout> characters of 10 bits
+    if (_onlyOnTimeout && _baud && (micros() - _lastRx < _rxTimeout * 10000000UL / _baud))
+        return;
+    _rxEvent = false;
+    _onReceive();
+}
+
+int HardwareSerial::available()
+{
+    pollTty();
+    return _rxCount;
+}
+
+void HardwareSerial::hostTick(void)
+{
+    pollTty();
+    checkRxEvent();
+}
+
+namespace host
+{
+    void serialTick(void)
+    {
+        static bool active = false;
+
+        // An onReceive() callback calling delay() must not re-enter itself
+        if (active)
+            return;
+        active = true;
+        Serial.hostTick();
+        Serial1.hostTick();
+        Serial2.hostTick();
+        active = false;
+    }
+}
+
+int HardwareSerial::read()
+{
+    if (_rxCount == 0)
+        pollTty();
+    if (_rxCount == 0)
+        return -1;
+    uint8_t c = _rx[_rxHead];
+    _rxHead = (_rxHead + 1) % RxBufferSize;
+    _rxCount--;
+    return c;
+}
+
+int HardwareSerial::peek()
+{
+    if (_rxCount == 0)
+        pollTty();
+    return _rxCount ? _rx[_rxHead] : -1;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (_fd >= 0)
+    {
+        size_t done = 0;
+        while (done < size)
+        {
+            ssize_t n = ::write(_fd, buffer + done, size - done);
+            if (n > 0)
+                done += n;
+            else if (n < 0 && errno != EAGAIN)
+                break;
+        }
+    }
+    else if (_device)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            if (_txCount == TxBufferSize)
+                flush();
+            _tx[_txCount++] = buffer[i];
+        }
+    }
+    else if (_uart_nr == 0)
+    {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+void HardwareSerial::flush()
+{
+    if (_fd >= 0)
+    {
+        tcdrain(_fd);
+    }
+    else if (_device && _txCount)
+    {
+        size_t size = _txCount;
+        _txCount = 0;
+        _device->onReceive(*this, _tx, size);
+    }
+    else if (_uart_nr == 0)
+    {
+        fflush(stdout);
+    }
+}
+
+void HardwareSerial::hostFeed(const uint8_t *data, size_t size)
+{
+    // Data exceeding the receive buffer is lost (as with a real UART)
+    for (size_t i = 0; i < size && _rxCount < RxBufferSize; i++)
+    {
+        _rx[(_rxHead + _rxCount) % RxBufferSize] = data[i];
+        _rxCount++;
+    }
+    if (size)
+    {
+        _rxEvent = true;
+        _lastRx = micros();
+    }
+}
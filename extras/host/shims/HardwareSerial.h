@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+// HardwareSerial.h
+//
+// Host build shim - Arduino HardwareSerial
+//
+// A port can be attached to a HostSerialDevice (e.g. an emulated inverter),
+// which receives everything written to the port and feeds its response into
+// the port's receive buffer, or bound to a host tty (e.g. a pseudo-terminal
+// or a USB RS485 adapter). Otherwise, data written to Serial goes to stdout
+// and data written to any other port is discarded.
+//
+// onReceive() callbacks are invoked when time advances (delay(), see
+// host::serialTick()) - like the UART event task, asynchronously to the
+// code reading the port; the RX timeout is emulated from the time of the
+// last received data.
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_HARDWARESERIAL_H)
+#define _HOST_HARDWARESERIAL_H
+
+#include <functional>
+#include "Stream.h"
+
+#define SERIAL_8N1 0x800001c
+
+class HardwareSerial;
+
+/*!
+ * \brief Device connected to a host serial port
+ */
+class HostSerialDevice
+{
+public:
+    virtual ~HostSerialDevice() {}
+
+    /*!
+     * \brief Called when the host flushes its transmit data to the device
+     *
+     * \param port serial port; use port.hostFeed() to send response data
+     * \param data data written by the host since the last flush
+     * \param size data size in bytes
+     */
+    virtual void onReceive(HardwareSerial &port, const uint8_t *data, size_t size) = 0;
+};
+
+typedef std::function<void(void)> OnReceiveCb;
+
+/// UART mode (as ESP-IDF uart_mode_t)
+typedef enum
+{
+    UART_MODE_UART = 0x00,
+    UART_MODE_RS485_HALF_DUPLEX = 0x01,
+    UART_MODE_IRDA = 0x02,
+    UART_MODE_RS485_COLLISION_DETECT = 0x03,
+    UART_MODE_RS485_APP_CTRL = 0x04
+} SerialMode;
+
+class HardwareSerial : public Stream
+{
+public:
+    explicit HardwareSerial(int uart_nr) : _uart_nr(uart_nr) {}
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1);
+    void end() {}
+    void setDebugOutput(bool) {}
+    unsigned long baudRate() const { return _baud; }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    void flush() override;
+
+    void onReceive(OnReceiveCb function, bool onlyOnTimeout = false);
+    bool setRxTimeout(uint8_t symbols_timeout);
+    bool setPins(int8_t rxPin, int8_t txPin, int8_t ctsPin = -1, int8_t rtsPin = -1) { return true; }
+    bool setMode(SerialMode mode) { _mode = mode; return true; }
+
+    /// Attach device (nullptr: detach)
+    void hostAttach(HostSerialDevice *device) { _device = device; }
+
+    /// Bind to host tty (raw mode); returns false on error
+    bool hostOpen(const char *path);
+
+    /// Append data to receive buffer
+    void hostFeed(const uint8_t *data, size_t size);
+
+    /// Poll bound tty and invoke onReceive() callback if due (see host::serialTick())
+    void hostTick(void);
+
+private:
+    int _uart_nr;
+    unsigned long _baud = 0;
+    HostSerialDevice *_device = nullptr;
+    int _fd = -1;
+
+    void pollTty(void);
+    void checkRxEvent(void);
+    OnReceiveCb _onReceive;
+    bool _onlyOnTimeout = false;
+    uint8_t _rxTimeout = 2;
+    bool _rxEvent = false;
+    unsigned long _lastRx = 0;
+    SerialMode _mode = UART_MODE_UART; // no effect - direction control is not emulated
+    // Fixed size buffers as with arduino-esp32 (no heap allocation)
+    static const size_t TxBufferSize = 256;
+    static const size_t RxBufferSize = 256;
+    uint8_t _tx[TxBufferSize];
+    size_t _txCount = 0;
+    uint8_t _rx[RxBufferSize];
+    size_t _rxHead = 0;
+    size_t _rxCount = 0;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+namespace host
+{
+    /*!
+     * \brief Emulate the UART event task of all ports
+     *
+     * Called by delay()/delayMicroseconds() after time has advanced.
+     */
+    void serialTick(void);
+}
+
+#endif // _HOST_HARDWARESERIAL_H
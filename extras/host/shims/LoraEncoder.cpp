@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// LoraEncoder.cpp
+//
+// Host build shim - lora-serialization LoraEncoder
+// (https://github.com/thesolarnomad/lora-serialization)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LoraEncoder.h"
+
+LoraEncoder::LoraEncoder(byte *buffer) : _buffer(buffer), _origin(buffer)
+{
+}
+
+void LoraEncoder::_intToBytes(byte *buf, int32_t i, uint8_t byteSize)
+{
+    for (uint8_t x = 0; x < byteSize; x++)
+    {
+        buf[x] = (byte)(i >> (x * 8));
+    }
+}
+
+void LoraEncoder::writeUnixtime(uint32_t unixtime)
+{
+    _intToBytes(_buffer, unixtime, 4);
+    _buffer += 4;
+}
+
+void LoraEncoder::writeLatLng(double latitude, double longitude)
+{
+    int32_t lat = latitude * 1e6;
+    int32_t lng = longitude * 1e6;
+
+    _intToBytes(_buffer, lat, 4);
+    _intToBytes(_buffer + 4, lng, 4);
+    _buffer += 8;
+}
+
+void LoraEncoder::writeUint32(uint32_t i)
+{
+    _intToBytes(_buffer, i, 4);
+    _buffer += 4;
+}
+
+void LoraEncoder::writeUint16(uint16_t i)
+{
+    _intToBytes(_buffer, i, 2);
+    _buffer += 2;
+}
+
+void LoraEncoder::writeUint8(uint8_t i)
+{
+    _intToBytes(_buffer, i, 1);
+    _buffer += 1;
+}
+
+void LoraEncoder::writeHumidity(float humidity)
+{
+    int16_t h = (int16_t)(humidity * 100);
+    _intToBytes(_buffer, h, 2);
+    _buffer += 2;
+}
+
+void LoraEncoder::writeBitmap(bool a, bool b, bool c, bool d, bool e, bool f, bool g, bool h)
+{
+    uint8_t bitmap = 0;
+    bitmap |= (a & 1) << 7;
+    bitmap |= (b & 1) << 6;
+    bitmap |= (c & 1) << 5;
+    bitmap |= (d & 1) << 4;
+    bitmap |= (e & 1) << 3;
+    bitmap |= (f & 1) << 2;
+    bitmap |= (g & 1) << 1;
+    bitmap |= (h & 1) << 0;
+    writeUint8(bitmap);
+}
+
+void LoraEncoder::writeTemperature(float temperature)
+{
+    int16_t t = (int16_t)(temperature * 100);
+    if (temperature < 0)
+    {
+        t = ~-t;
+        t = t + 1;
+    }
+    _buffer[0] = (t >> 8) & 0xFF;
+    _buffer[1] = t & 0xFF;
+    _buffer += 2;
+}
+
+void LoraEncoder::writeRawFloat(float value)
+{
+    memcpy(_buffer, &value, sizeof(value));
+    _buffer += sizeof(value);
+}
+
+int LoraEncoder::getLength(void)
+{
+    return _buffer - _origin;
+}
@@ -0,0 +1,37 @@
+///////////////////////////////////////////////////////////////////////////////
+// LoraEncoder.h
+//
+// Host build shim - lora-serialization LoraEncoder
+// (https://github.com/thesolarnomad/lora-serialization)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_LORAENCODER_H)
+#define _HOST_LORAENCODER_H
+
+#include "Arduino.h"
+
+class LoraEncoder
+{
+public:
+    LoraEncoder(byte *buffer);
+    void writeUnixtime(uint32_t unixtime);
+    void writeLatLng(double latitude, double longitude);
+    void writeUint32(uint32_t i);
+    void writeUint16(uint16_t i);
+    void writeUint8(uint8_t i);
+    void writeHumidity(float humidity);
+    void writeBitmap(bool a, bool b, bool c, bool d, bool e, bool f, bool g, bool h);
+    void writeTemperature(float temperature);
+    void writeRawFloat(float value);
+    int getLength(void);
+
+private:
+    byte *_buffer;
+    byte *_origin;
+    void _intToBytes(byte *buf, int32_t i, uint8_t byteSize);
+};
+
+#endif // _HOST_LORAENCODER_H
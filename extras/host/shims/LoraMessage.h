@@ -0,0 +1,16 @@
+///////////////////////////////////////////////////////////////////////////////
+// LoraMessage.h
+//
+// Host build shim - lora-serialization LoraMessage
+// (https://github.com/thesolarnomad/lora-serialization)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_LORAMESSAGE_H)
+#define _HOST_LORAMESSAGE_H
+
+#include "LoraEncoder.h"
+
+#endif // _HOST_LORAMESSAGE_H
@@ -0,0 +1,40 @@
+///////////////////////////////////////////////////////////////////////////////
+// MQTT.cpp
+//
+// Host build shim - arduino-mqtt (https://github.com/256dpi/arduino-mqtt)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MQTT.h"
+
+namespace
+{
+    void printPublish(const char *topic, const char *payload, bool retained)
+    {
+        printf("MQTT %s%s: %s\n", topic, retained ? " (retained)" : "", payload);
+    }
+
+    std::function<void(const char *, const char *, bool)> publishHandler = printPublish;
+}
+
+bool MQTTClient::publish(const char topic[], const char payload[], bool retained, int qos)
+{
+    (void)qos;
+    if (!_connected)
+        return false;
+    if ((int)(strlen(topic) + strlen(payload)) > _bufSize)
+        return false;
+    if (publishHandler)
+        publishHandler(topic, payload, retained);
+    return true;
+}
+
+namespace host
+{
+    void setMqttPublishHandler(std::function<void(const char *topic, const char *payload, bool retained)> handler)
+    {
+        publishHandler = handler;
+    }
+}
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// MQTT.h
+//
+// Host build shim - arduino-mqtt (https://github.com/256dpi/arduino-mqtt)
+//
+// Published messages are passed to the host's publish handler.
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_MQTT_H)
+#define _HOST_MQTT_H
+
+#include <functional>
+#include "Arduino.h"
+
+class MQTTClient
+{
+public:
+    explicit MQTTClient(int bufSize = 128) : _bufSize(bufSize) {}
+
+    template <typename Client>
+    void begin(const char hostname[], int port, Client &client)
+    {
+        (void)hostname;
+        (void)port;
+        (void)client;
+    }
+    void setWill(const char topic[], const char payload[], bool retained, int qos)
+    {
+        (void)topic;
+        (void)payload;
+        (void)retained;
+        (void)qos;
+    }
+    bool connect(const char clientID[], const char username[] = nullptr, const char password[] = nullptr)
+    {
+        (void)clientID;
+        (void)username;
+        (void)password;
+        _connected = true;
+        return true;
+    }
+
+    bool publish(const String &topic, const String &payload, bool retained = false, int qos = 0)
+    {
+        return publish(topic.c_str(), payload.c_str(), retained, qos);
+    }
+    bool publish(const String &topic, const char payload[], bool retained = false, int qos = 0)
+    {
+        return publish(topic.c_str(), payload, retained, qos);
+    }
+    bool publish(const char topic[], const char payload[], bool retained = false, int qos = 0);
+
+    bool loop(void) { return _connected; }
+    bool connected(void) { return _connected; }
+    bool disconnect(void)
+    {
+        _connected = false;
+        return true;
+    }
+
+private:
+    int _bufSize;
+    bool _connected = false;
+};
+
+namespace host
+{
+    /// Set handler for published messages (default: print "MQTT <topic>: <payload>" to stdout)
+    void setMqttPublishHandler(std::function<void(const char *topic, const char *payload, bool retained)> handler);
+}
+
+#endif // _HOST_MQTT_H
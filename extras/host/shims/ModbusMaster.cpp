@@ -0,0 +1,199 @@
+///////////////////////////////////////////////////////////////////////////////
+// ModbusMaster.cpp
+//
+// Host build shim - ModbusMaster (https://github.com/4-20ma/ModbusMaster)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ModbusMaster.h"
+
+static uint16_t crc16_update(uint16_t crc, uint8_t a)
+{
+    crc ^= a;
+    for (int i = 0; i < 8; ++i)
+    {
+        if (crc & 1)
+            crc = (crc >> 1) ^ 0xA001;
+        else
+            crc = (crc >> 1);
+    }
+    return crc;
+}
+
+ModbusMaster::ModbusMaster(void)
+    : _serial(nullptr), _u8MBSlave(0), _u16ReadAddress(0), _u16ReadQty(0), _u16WriteAddress(0), _u16WriteValue(0),
+      _idle(nullptr), _preTransmission(nullptr), _postTransmission(nullptr)
+{
+    clearResponseBuffer();
+}
+
+void ModbusMaster::begin(uint8_t slave, Stream &serial)
+{
+    _u8MBSlave = slave;
+    _serial = &serial;
+}
+
+void ModbusMaster::idle(void (*idle)())
+{
+    _idle = idle;
+}
+
+void ModbusMaster::preTransmission(void (*preTransmission)())
+{
+    _preTransmission = preTransmission;
+}
+
+void ModbusMaster::postTransmission(void (*postTransmission)())
+{
+    _postTransmission = postTransmission;
+}
+
+uint16_t ModbusMaster::getResponseBuffer(uint8_t u8Index)
+{
+    if (u8Index < ku8MaxBufferSize)
+        return _u16ResponseBuffer[u8Index];
+    return 0xFFFF;
+}
+
+void ModbusMaster::clearResponseBuffer()
+{
+    for (uint8_t i = 0; i < ku8MaxBufferSize; i++)
+        _u16ResponseBuffer[i] = 0;
+}
+
+uint8_t ModbusMaster::readHoldingRegisters(uint16_t u16ReadAddress, uint16_t u16ReadQty)
+{
+    _u16ReadAddress = u16ReadAddress;
+    _u16ReadQty = u16ReadQty;
+    return ModbusMasterTransaction(ku8MBReadHoldingRegisters);
+}
+
+uint8_t ModbusMaster::readInputRegisters(uint16_t u16ReadAddress, uint8_t u16ReadQty)
+{
+    _u16ReadAddress = u16ReadAddress;
+    _u16ReadQty = u16ReadQty;
+    return ModbusMasterTransaction(ku8MBReadInputRegisters);
+}
+
+uint8_t ModbusMaster::writeSingleRegister(uint16_t u16WriteAddress, uint16_t u16WriteValue)
+{
+    _u16WriteAddress = u16WriteAddress;
+    _u16WriteValue = u16WriteValue;
+    return ModbusMasterTransaction(ku8MBWriteSingleRegister);
+}
+
+uint8_t ModbusMaster::ModbusMasterTransaction(uint8_t u8MBFunction)
+{
+    uint8_t u8ModbusADU[256];
+    uint8_t u8ModbusADUSize = 0;
+    uint16_t u16CRC;
+    uint32_t u32StartTime;
+    uint8_t u8BytesLeft = 8;
+    uint8_t u8MBStatus = ku8MBSuccess;
+
+    // assemble Modbus Request Application Data Unit
+    u8ModbusADU[u8ModbusADUSize++] = _u8MBSlave;
+    u8ModbusADU[u8ModbusADUSize++] = u8MBFunction;
+    if (u8MBFunction == ku8MBWriteSingleRegister)
+    {
+        u8ModbusADU[u8ModbusADUSize++] = _u16WriteAddress >> 8;
+        u8ModbusADU[u8ModbusADUSize++] = _u16WriteAddress & 0xFF;
+        u8ModbusADU[u8ModbusADUSize++] = _u16WriteValue >> 8;
+        u8ModbusADU[u8ModbusADUSize++] = _u16WriteValue & 0xFF;
+    }
+    else
+    {
+        u8ModbusADU[u8ModbusADUSize++] = _u16ReadAddress >> 8;
+        u8ModbusADU[u8ModbusADUSize++] = _u16ReadAddress & 0xFF;
+        u8ModbusADU[u8ModbusADUSize++] = _u16ReadQty >> 8;
+        u8ModbusADU[u8ModbusADUSize++] = _u16ReadQty & 0xFF;
+    }
+
+    // append CRC
+    u16CRC = 0xFFFF;
+    for (uint8_t i = 0; i < u8ModbusADUSize; i++)
+        u16CRC = crc16_update(u16CRC, u8ModbusADU[i]);
+    u8ModbusADU[u8ModbusADUSize++] = u16CRC & 0xFF;
+    u8ModbusADU[u8ModbusADUSize++] = u16CRC >> 8;
+
+    // flush receive buffer before transmitting request
+    while (_serial->read() != -1)
+        ;
+
+    // transmit request
+    if (_preTransmission)
+        _preTransmission();
+    for (uint8_t i = 0; i < u8ModbusADUSize; i++)
+        _serial->write(u8ModbusADU[i]);
+    u8ModbusADUSize = 0;
+    _serial->flush();
+    if (_postTransmission)
+        _postTransmission();
+
+    // loop until we run out of time or bytes, or an error occurs
+    u32StartTime = millis();
+    while (u8BytesLeft && !u8MBStatus)
+    {
+        if (_serial->available())
+        {
+            u8ModbusADU[u8ModbusADUSize++] = _serial->read();
+            u8BytesLeft--;
+        }
+        else if (_idle)
+        {
+            _idle();
+        }
+
+        // evaluate slave ID, function code once enough bytes have been read
+        if (u8ModbusADUSize == 5)
+        {
+            if (u8ModbusADU[0] != _u8MBSlave)
+            {
+                u8MBStatus = ku8MBInvalidSlaveID;
+                break;
+            }
+            if ((u8ModbusADU[1] & 0x7F) != u8MBFunction)
+            {
+                u8MBStatus = ku8MBInvalidFunction;
+                break;
+            }
+            if (u8ModbusADU[1] & 0x80)
+            {
+                u8MBStatus = u8ModbusADU[2];
+                break;
+            }
+            if (u8ModbusADU[1] == ku8MBWriteSingleRegister)
+                u8BytesLeft = 3;
+            else
+                u8BytesLeft = u8ModbusADU[2];
+        }
+        if ((millis() - u32StartTime) > ku16MBResponseTimeout)
+        {
+            u8MBStatus = ku8MBResponseTimedOut;
+        }
+    }
+
+    // verify response is large enough to inspect further
+    if (!u8MBStatus && u8ModbusADUSize >= 5)
+    {
+        u16CRC = 0xFFFF;
+        for (uint8_t i = 0; i < (u8ModbusADUSize - 2); i++)
+            u16CRC = crc16_update(u16CRC, u8ModbusADU[i]);
+        if ((u16CRC & 0xFF) != u8ModbusADU[u8ModbusADUSize - 2] || (u16CRC >> 8) != u8ModbusADU[u8ModbusADUSize - 1])
+            u8MBStatus = ku8MBInvalidCRC;
+    }
+
+    // disassemble ADU into words; response bytes are ordered H, L, H, L, ...
+    if (!u8MBStatus && u8ModbusADU[1] != ku8MBWriteSingleRegister)
+    {
+        for (uint8_t i = 0; i < (u8ModbusADU[2] >> 1); i++)
+        {
+            if (i < ku8MaxBufferSize)
+                _u16ResponseBuffer[i] = (u8ModbusADU[2 * i + 3] << 8) | u8ModbusADU[2 * i + 4];
+        }
+    }
+
+    return u8MBStatus;
+}
@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////////////
+// ModbusMaster.h
+//
+// Host build shim - ModbusMaster (https://github.com/4-20ma/ModbusMaster)
+//
+// Modbus RTU master with the same API, buffer size, timeout and transaction
+// sequence as ModbusMaster 2.0.1 (subset of function codes used by
+// growatt2radio: 0x03, 0x04, 0x06).
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_MODBUSMASTER_H)
+#define _HOST_MODBUSMASTER_H
+
+#include "Arduino.h"
+
+class ModbusMaster
+{
+public:
+    ModbusMaster();
+
+    void begin(uint8_t slave, Stream &serial);
+    void idle(void (*)());
+    void preTransmission(void (*)());
+    void postTransmission(void (*)());
+
+    // Modbus exception codes
+    static const uint8_t ku8MBIllegalFunction = 0x01;
+    static const uint8_t ku8MBIllegalDataAddress = 0x02;
+    static const uint8_t ku8MBIllegalDataValue = 0x03;
+    static const uint8_t ku8MBSlaveDeviceFailure = 0x04;
+
+    // Class-defined success/exception codes
+    static const uint8_t ku8MBSuccess = 0x00;
+    static const uint8_t ku8MBInvalidSlaveID = 0xE0;
+    static const uint8_t ku8MBInvalidFunction = 0xE1;
+    static const uint8_t ku8MBResponseTimedOut = 0xE2;
+    static const uint8_t ku8MBInvalidCRC = 0xE3;
+
+    uint16_t getResponseBuffer(uint8_t index);
+    void clearResponseBuffer();
+
+    uint8_t readHoldingRegisters(uint16_t readAddress, uint16_t readQty);
+    uint8_t readInputRegisters(uint16_t readAddress, uint8_t readQty);
+    uint8_t writeSingleRegister(uint16_t writeAddress, uint16_t writeValue);
+
+private:
+    Stream *_serial;
+    uint8_t _u8MBSlave;
+    static const uint8_t ku8MaxBufferSize = 64;
+    uint16_t _u16ReadAddress;
+    uint16_t _u16ReadQty;
+    uint16_t _u16ResponseBuffer[ku8MaxBufferSize];
+    uint16_t _u16WriteAddress;
+    uint16_t _u16WriteValue;
+
+    // Modbus function codes for 16 bit access
+    static const uint8_t ku8MBReadHoldingRegisters = 0x03;
+    static const uint8_t ku8MBReadInputRegisters = 0x04;
+    static const uint8_t ku8MBWriteSingleRegister = 0x06;
+
+    // Modbus timeout [milliseconds]
+    static const uint16_t ku16MBResponseTimeout = 2000;
+
+    uint8_t ModbusMasterTransaction(uint8_t u8MBFunction);
+
+    void (*_idle)();
+    void (*_preTransmission)();
+    void (*_postTransmission)();
+};
+
+#endif // _HOST_MODBUSMASTER_H
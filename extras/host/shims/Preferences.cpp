@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+// Preferences.cpp
+//
+// Host build shim - ESP32 Preferences (NVS key-value storage)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "Preferences.h"
+
+namespace
+{
+    struct Entry
+    {
+        char name[16]; // namespace
+        char key[16];  // key (empty: unused entry)
+        uint16_t len;
+        uint8_t value[Preferences::MaxValueSize];
+    };
+
+    RTC_DATA_ATTR Entry entries[Preferences::MaxEntries];
+
+    Entry *find(const char *name, const char *key)
+    {
+        for (Entry &e : entries)
+        {
+            if (e.key[0] && !strcmp(e.name, name) && !strcmp(e.key, key))
+                return &e;
+        }
+        return nullptr;
+    }
+}
+
+bool Preferences::begin(const char *name, bool readOnly)
+{
+    if (strlen(name) >= sizeof(_name))
+        return false;
+    strcpy(_name, name);
+    _readOnly = readOnly;
+    _started = true;
+    return true;
+}
+
+void Preferences::end(void)
+{
+    _started = false;
+}
+
+bool Preferences::clear(void)
+{
+    if (!_started || _readOnly)
+        return false;
+    for (Entry &e : entries)
+    {
+        if (!strcmp(e.name, _name))
+            e.key[0] = '\0';
+    }
+    return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+    Entry *e = _started && !_readOnly ? find(_name, key) : nullptr;
+    if (!e)
+        return false;
+    e->key[0] = '\0';
+    return true;
+}
+
+bool Preferences::isKey(const char *key)
+{
+    return _started && find(_name, key);
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len)
+{
+    if (!_started || _readOnly || len > MaxValueSize || strlen(key) >= sizeof(Entry::key))
+        return 0;
+    Entry *e = find(_name, key);
+    for (size_t i = 0; !e && i < MaxEntries; i++)
+    {
+        if (!entries[i].key[0])
+            e = &entries[i];
+    }
+    if (!e)
+        return 0;
+    strcpy(e->name, _name);
+    strcpy(e->key, key);
+    e->len = (uint16_t)len;
+    memcpy(e->value, value, len);
+    return len;
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+    Entry *e = _started ? find(_name, key) : nullptr;
+    return e ? e->len : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen)
+{
+    Entry *e = _started ? find(_name, key) : nullptr;
+    if (!e || e->len > maxLen)
+        return 0;
+    memcpy(buf, e->value, e->len);
+    return e->len;
+}
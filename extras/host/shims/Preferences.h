@@ -0,0 +1,39 @@
+///////////////////////////////////////////////////////////////////////////////
+// Preferences.h
+//
+// Host build shim - ESP32 Preferences (NVS key-value storage)
+//
+// Entries are kept in a fixed table in the rtc_data section, i.e. they
+// survive host::runWakeCycles() like the NVS partition survives deep sleep.
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_PREFERENCES_H)
+#define _HOST_PREFERENCES_H
+
+#include "Arduino.h"
+
+class Preferences
+{
+public:
+    static const size_t MaxEntries = 8;     //!< max. no. of keys (all namespaces)
+    static const size_t MaxValueSize = 256; //!< max. value size [bytes]
+
+    bool begin(const char *name, bool readOnly = false);
+    void end(void);
+    bool clear(void);
+    bool remove(const char *key);
+    bool isKey(const char *key);
+    size_t putBytes(const char *key, const void *value, size_t len);
+    size_t getBytesLength(const char *key);
+    size_t getBytes(const char *key, void *buf, size_t maxLen);
+
+private:
+    char _name[16] = "";
+    bool _started = false;
+    bool _readOnly = false;
+};
+
+#endif // _HOST_PREFERENCES_H
@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////
+// RadioLib.cpp
+//
+// Host build shim - RadioLib (https://github.com/jgromes/RadioLib)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include "RadioLib.h"
+
+namespace
+{
+    void printTxData(const uint8_t *data, size_t len)
+    {
+        printf("TX-Data:");
+        for (size_t i = 0; i < len; i++)
+            printf(" %02X", data[i]);
+        printf("\n");
+    }
+
+    std::function<void(const uint8_t *, size_t)> txHandler = printTxData;
+    std::deque<std::vector<uint8_t>> rxQueue;
+    float rssi = -60.0;
+}
+
+int16_t HostRadio::beginFSK(float freq, float br, float freqDev, float rxBw, int8_t power, uint16_t preambleLength)
+{
+    (void)freq;
+    (void)br;
+    (void)freqDev;
+    (void)rxBw;
+    (void)power;
+    (void)preambleLength;
+    (void)_mod;
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t HostRadio::transmit(const uint8_t *data, size_t len, uint8_t addr)
+{
+    (void)addr;
+    if (len > 255)
+        return RADIOLIB_ERR_PACKET_TOO_LONG;
+    _receiving = false;
+    if (!txHandler)
+        return RADIOLIB_ERR_NONE;
+    if (_syncWord.empty())
+    {
+        txHandler(data, len);
+        return RADIOLIB_ERR_NONE;
+    }
+
+    // Packet as on air: preamble, sync word, data
+    std::vector<uint8_t> packet = {0xAA, 0xAA, 0xAA, 0xAA};
+    packet.insert(packet.end(), _syncWord.begin(), _syncWord.end());
+    packet.insert(packet.end(), data, data + len);
+    txHandler(packet.data(), packet.size());
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t HostRadio::fixedPacketLengthMode(uint8_t len)
+{
+    _packetLength = len;
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t HostRadio::variablePacketLengthMode(uint8_t maxLen)
+{
+    (void)maxLen;
+    _packetLength = 0;
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t HostRadio::setSyncWord(uint8_t *syncWord, size_t len)
+{
+    if (len == 0 || len > 8)
+        return RADIOLIB_ERR_INVALID_SYNC_WORD;
+    _syncWord.assign(syncWord, syncWord + len);
+    return RADIOLIB_ERR_NONE;
+}
+
+void HostRadio::setPacketReceivedAction(void (*func)(void))
+{
+    _packetReceivedAction = func;
+}
+
+int16_t HostRadio::startReceive(void)
+{
+    _receiving = true;
+
+    // Deliver next queued packet which contains the sync word
+    // (unless the previous one has not been read yet)
+    while (_rxData.empty() && !rxQueue.empty())
+    {
+        std::vector<uint8_t> packet;
+        packet.swap(rxQueue.front());
+        rxQueue.pop_front();
+
+        auto sync = std::search(packet.begin(), packet.end(), _syncWord.begin(), _syncWord.end());
+        if (_syncWord.empty() || sync == packet.end())
+            continue;
+
+        _rxData.assign(sync + _syncWord.size(), packet.end());
+        if (_packetLength)
+        {
+            // Fixed packet length: receiver demodulates noise after the end of the packet
+            static std::minstd_rand noise(0x2DD4);
+            size_t end = _rxData.size();
+            _rxData.resize(_packetLength);
+            for (size_t i = end; i < _rxData.size(); i++)
+                _rxData[i] = noise() & 0xFF;
+        }
+        if (_packetReceivedAction)
+            _packetReceivedAction();
+        break;
+    }
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t HostRadio::readData(uint8_t *data, size_t len)
+{
+    size_t n = std::min(len, _rxData.size());
+    memcpy(data, _rxData.data(), n);
+    _rxData.clear();
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t HostRadio::standby(void)
+{
+    _receiving = false;
+    return RADIOLIB_ERR_NONE;
+}
+
+float HostRadio::getRSSI(void)
+{
+    return rssi;
+}
+
+namespace host
+{
+    void setRadioTxHandler(std::function<void(const uint8_t *data, size_t len)> handler)
+    {
+        txHandler = handler;
+    }
+
+    void radioQueue(const uint8_t *data, size_t len)
+    {
+        rxQueue.emplace_back(data, data + len);
+    }
+
+    size_t radioPending(void)
+    {
+        return rxQueue.size();
+    }
+
+    void radioClear(void)
+    {
+        rxQueue.clear();
+    }
+
+    void setRadioRssi(float value)
+    {
+        rssi = value;
+    }
+}
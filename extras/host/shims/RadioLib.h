@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+// RadioLib.h
+//
+// Host build shim - RadioLib (https://github.com/jgromes/RadioLib)
+//
+// SX1276/SX1262 FSK mode (subset used by growatt2radio).
+//
+// Transmitted packets are passed to the host's transmit handler, preceded
+// by preamble and sync word if a sync word has been set (the transmitter
+// sends preamble and sync word as part of the data instead).
+// Packets queued with host::radioQueue() are received like over the air:
+// the receiving radio searches its sync word in the packet and delivers
+// the following (fixed packet length) bytes, then calls the packet
+// received action - one packet per startReceive().
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_RADIOLIB_H)
+#define _HOST_RADIOLIB_H
+
+#include <functional>
+#include <vector>
+#include "Arduino.h"
+
+#define RADIOLIB_NC (0xFFFFFFFF)
+
+#define RADIOLIB_ERR_NONE (0)
+#define RADIOLIB_ERR_UNKNOWN (-1)
+#define RADIOLIB_ERR_PACKET_TOO_LONG (-4)
+#define RADIOLIB_ERR_TX_TIMEOUT (-5)
+#define RADIOLIB_ERR_RX_TIMEOUT (-6)
+#define RADIOLIB_ERR_INVALID_SYNC_WORD (-16)
+
+class Module
+{
+public:
+    Module(uint32_t cs, uint32_t irq, uint32_t rst, uint32_t gpio = RADIOLIB_NC)
+    {
+        (void)cs;
+        (void)irq;
+        (void)rst;
+        (void)gpio;
+    }
+};
+
+/*!
+ * \brief FSK radio transceiver
+ */
+class HostRadio
+{
+public:
+    HostRadio(Module *mod) : _mod(mod) {}
+
+    int16_t beginFSK(float freq, float br, float freqDev, float rxBw, int8_t power, uint16_t preambleLength);
+    int16_t transmit(const uint8_t *data, size_t len, uint8_t addr = 0);
+    int16_t fixedPacketLengthMode(uint8_t len);
+    int16_t variablePacketLengthMode(uint8_t maxLen = 0xFF);
+    int16_t setSyncWord(uint8_t *syncWord, size_t len);
+    void setPacketReceivedAction(void (*func)(void));
+    int16_t startReceive(void);
+    int16_t readData(uint8_t *data, size_t len);
+    int16_t standby(void);
+    float getRSSI(void);
+    void setRfSwitchPins(uint32_t rxEn, uint32_t txEn) { (void)rxEn; (void)txEn; }
+
+private:
+    Module *_mod;
+    uint8_t _packetLength = 0;
+    std::vector<uint8_t> _syncWord;
+    std::vector<uint8_t> _rxData;
+    void (*_packetReceivedAction)(void) = nullptr;
+    bool _receiving = false;
+};
+
+class SX1276 : public HostRadio
+{
+public:
+    SX1276(Module *mod) : HostRadio(mod) {}
+    int16_t setCrcFiltering(bool enable) { (void)enable; return RADIOLIB_ERR_NONE; }
+};
+
+class SX1262 : public HostRadio
+{
+public:
+    SX1262(Module *mod) : HostRadio(mod) {}
+    int16_t setCRC(uint8_t len) { (void)len; return RADIOLIB_ERR_NONE; }
+    int16_t setTCXO(float voltage) { (void)voltage; return RADIOLIB_ERR_NONE; }
+};
+
+namespace host
+{
+    /// Set handler for transmitted packets (default: print "TX-Data: ..." to stdout)
+    void setRadioTxHandler(std::function<void(const uint8_t *data, size_t len)> handler);
+
+    /// Queue packet for reception
+    void radioQueue(const uint8_t *data, size_t len);
+
+    /// Number of queued packets
+    size_t radioPending(void);
+
+    /// Discard queued packets
+    void radioClear(void);
+
+    /// Set value returned by getRSSI()
+    void setRadioRssi(float rssi);
+}
+
+#endif // _HOST_RADIOLIB_H
@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////
+// WString.h
+//
+// Host build shim - Arduino String class (subset used by growatt2radio)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_WSTRING_H)
+#define _HOST_WSTRING_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+class String
+{
+public:
+    String(const char *s = "") : _s(s ? s : "") {}
+    String(const std::string &s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(unsigned char v, unsigned char base = 10) : _s(fromInt(v, base)) {}
+    String(int v, unsigned char base = 10) : _s(fromInt(v, base)) {}
+    String(unsigned int v, unsigned char base = 10) : _s(fromInt(v, base)) {}
+    String(long v, unsigned char base = 10) : _s(fromInt(v, base)) {}
+    String(unsigned long v, unsigned char base = 10) : _s(fromInt(v, base)) {}
+    String(float v, unsigned int decimals = 2) : _s(fromFloat(v, decimals)) {}
+    String(double v, unsigned int decimals = 2) : _s(fromFloat(v, decimals)) {}
+
+    const char *c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    char operator[](unsigned int i) const { return _s[i]; }
+
+    String &operator+=(const String &rhs)
+    {
+        _s += rhs._s;
+        return *this;
+    }
+    String &operator+=(const char *rhs)
+    {
+        _s += rhs;
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        _s += c;
+        return *this;
+    }
+
+    friend String operator+(const String &lhs, const String &rhs) { return String(lhs._s + rhs._s); }
+    friend String operator+(const String &lhs, const char *rhs) { return String(lhs._s + rhs); }
+    friend String operator+(const char *lhs, const String &rhs) { return String(lhs + rhs._s); }
+
+    bool operator==(const String &rhs) const { return _s == rhs._s; }
+    bool operator==(const char *rhs) const { return _s == rhs; }
+    bool operator!=(const String &rhs) const { return _s != rhs._s; }
+    bool operator!=(const char *rhs) const { return _s != rhs; }
+
+private:
+    std::string _s;
+
+    static std::string fromInt(long long v, unsigned char base)
+    {
+        char buf[40];
+        if (base == 16)
+            snprintf(buf, sizeof(buf), "%llx", v);
+        else
+            snprintf(buf, sizeof(buf), "%lld", v);
+        return buf;
+    }
+
+    static std::string fromInt(unsigned long long v, unsigned char base)
+    {
+        char buf[40];
+        snprintf(buf, sizeof(buf), (base == 16) ? "%llx" : "%llu", v);
+        return buf;
+    }
+
+    static std::string fromInt(int v, unsigned char base) { return fromInt((long long)v, base); }
+    static std::string fromInt(long v, unsigned char base) { return fromInt((long long)v, base); }
+    static std::string fromInt(unsigned char v, unsigned char base) { return fromInt((unsigned long long)v, base); }
+    static std::string fromInt(unsigned int v, unsigned char base) { return fromInt((unsigned long long)v, base); }
+    static std::string fromInt(unsigned long v, unsigned char base) { return fromInt((unsigned long long)v, base); }
+
+    static std::string fromFloat(double v, unsigned int decimals)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        return buf;
+    }
+};
+
+#endif // _HOST_WSTRING_H
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+// WiFi.h
+//
+// Host build shim - arduino-esp32 WiFi (always connected)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_WIFI_H)
+#define _HOST_WIFI_H
+
+#include "Arduino.h"
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_CONNECTED = 3,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum
+{
+    WIFI_OFF = 0,
+    WIFI_STA = 1
+} wifi_mode_t;
+
+class WiFiClass
+{
+public:
+    wl_status_t status(void) { return WL_CONNECTED; }
+    bool hostname(const char *name) { (void)name; return true; }
+    bool mode(wifi_mode_t mode) { (void)mode; return true; }
+    wl_status_t begin(const char *ssid, const char *passphrase = nullptr)
+    {
+        (void)ssid;
+        (void)passphrase;
+        return WL_CONNECTED;
+    }
+};
+
+class WiFiClient
+{
+public:
+    void stop(void) {}
+};
+
+static WiFiClass WiFi;
+
+#endif // _HOST_WIFI_H
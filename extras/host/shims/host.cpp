@@ -0,0 +1,335 @@
+///////////////////////////////////////////////////////////////////////////////
+// host.cpp
+//
+// Host build - Arduino core shim implementation and control interface
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <ctype.h>
+#include <malloc.h>
+#include <stdarg.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include "Arduino.h"
+#include "host.h"
+
+EspClass ESP;
+
+// RTC memory section boundaries (provided by the linker if any variable is placed there)
+extern uint8_t __start_rtc_data[] __attribute__((weak));
+extern uint8_t __stop_rtc_data[] __attribute__((weak));
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point bootTime = Clock::now();
+    uint64_t skippedMicros = 0;
+    uint64_t rtcBaseMicros = 0;
+    bool virtualTime = false;
+    uint8_t pinLevel[256];
+    int logLevel = CORE_DEBUG_LEVEL;
+    FILE *logFile = stderr;
+    uint64_t efuseMac = 0x0000A1B2C3D4E5F6ULL;
+    uint32_t minFreeHeap = UINT32_MAX;
+
+    struct Init
+    {
+        Init()
+        {
+            memset(pinLevel, HIGH, sizeof(pinLevel));
+            const char *level = getenv("GW_LOG_LEVEL");
+            if (level)
+                logLevel = atoi(level);
+        }
+    } init;
+
+    bool readAll(int fd, void *buf, size_t size)
+    {
+        uint8_t *p = static_cast<uint8_t *>(buf);
+        while (size)
+        {
+            ssize_t n = ::read(fd, p, size);
+            if (n <= 0)
+                return false;
+            p += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    void writeAll(int fd, const void *buf, size_t size)
+    {
+        const uint8_t *p = static_cast<const uint8_t *>(buf);
+        while (size)
+        {
+            ssize_t n = ::write(fd, p, size);
+            if (n <= 0)
+                return;
+            p += n;
+            size -= n;
+        }
+    }
+}
+
+unsigned long micros(void)
+{
+    if (virtualTime)
+    {
+        // Each clock read takes 1 µs, so polling loops time out without real waiting
+        return skippedMicros++;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - bootTime).count() + skippedMicros;
+}
+
+unsigned long millis(void)
+{
+    return micros() / 1000;
+}
+
+void delay(unsigned long ms)
+{
+    delayMicroseconds(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    if (virtualTime)
+    {
+        skippedMicros += us;
+        host::serialTick();
+        return;
+    }
+    // Real time: the emulated UART event task runs every millisecond
+    Clock::time_point end = Clock::now() + std::chrono::microseconds(us);
+    for (Clock::time_point now = Clock::now(); now < end; now = Clock::now())
+    {
+        std::this_thread::sleep_for(std::min<Clock::duration>(end - now, std::chrono::milliseconds(1)));
+        host::serialTick();
+    }
+}
+
+void yield(void)
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    pinLevel[pin] = val;
+}
+
+int digitalRead(uint8_t pin)
+{
+    return pinLevel[pin];
+}
+
+void EspClass::deepSleep(uint64_t time_us)
+{
+    throw host::DeepSleep{time_us};
+}
+
+void EspClass::restart(void)
+{
+    throw host::DeepSleep{0};
+}
+
+uint64_t EspClass::getEfuseMac(void)
+{
+    return efuseMac;
+}
+
+uint32_t EspClass::getHeapSize(void)
+{
+    return HOST_HEAP_SIZE;
+}
+
+uint32_t EspClass::getFreeHeap(void)
+{
+    size_t used = mallinfo2().uordblks;
+    uint32_t free = (used < HOST_HEAP_SIZE) ? HOST_HEAP_SIZE - used : 0;
+    if (free < minFreeHeap)
+        minFreeHeap = free;
+    return free;
+}
+
+uint32_t EspClass::getMinFreeHeap(void)
+{
+    getFreeHeap();
+    return minFreeHeap;
+}
+
+uint32_t EspClass::getMaxAllocHeap(void)
+{
+    return getFreeHeap();
+}
+
+void configTime(long gmtOffset_sec, int daylightOffset_sec, const char *server1, const char *server2,
+                const char *server3)
+{
+    (void)gmtOffset_sec;
+    (void)daylightOffset_sec;
+    (void)server1;
+    (void)server2;
+    (void)server3;
+}
+
+int host_settimeofday(const struct timeval *tv, const void *tz)
+{
+    (void)tv;
+    (void)tz;
+    return 0;
+}
+
+void host_log(int level, const char *file, int line, const char *func, const char *format, ...)
+{
+    static const char tag[] = "NEWIDV";
+
+    if (!logFile || level > logLevel)
+        return;
+
+    const char *base = strrchr(file, '/');
+    base = base ? base + 1 : file;
+
+    fprintf(logFile, "[%6lu][%c][%s:%d] %s(): ", millis(), tag[level], base, line, func);
+    va_list args;
+    va_start(args, format);
+    vfprintf(logFile, format, args);
+    va_end(args);
+    fputc('\n', logFile);
+}
+
+namespace host
+{
+    void setVirtualTime(bool enable)
+    {
+        virtualTime = enable;
+    }
+
+    void reboot(void)
+    {
+        bootTime = Clock::now();
+        skippedMicros = 0;
+    }
+
+    uint64_t rtcMicros(void)
+    {
+        return rtcBaseMicros + micros();
+    }
+
+    void setPinLevel(uint8_t pin, int level)
+    {
+        pinLevel[pin] = level;
+    }
+
+    void setLogLevel(int level)
+    {
+        logLevel = level;
+    }
+
+    void setLogFile(FILE *file)
+    {
+        logFile = file;
+    }
+
+    void setEfuseMac(uint64_t mac)
+    {
+        efuseMac = mac;
+    }
+
+    int runWakeCycles(unsigned cycles, void (*entry)(void), void (*onSleep)(unsigned cycle, uint64_t awake_us))
+    {
+        size_t rtcSize = (__start_rtc_data && __stop_rtc_data) ? __stop_rtc_data - __start_rtc_data : 0;
+        std::vector<uint8_t> rtc(__start_rtc_data, __start_rtc_data + rtcSize);
+
+        for (unsigned cycle = 1; cycle <= cycles; cycle++)
+        {
+            int fds[2];
+            if (pipe(fds) != 0)
+                return cycle;
+
+            fflush(nullptr);
+            pid_t pid = fork();
+            if (pid < 0)
+                return cycle;
+
+            if (pid == 0)
+            {
+                // Wake-up: restore RTC memory, restart clock
+                close(fds[0]);
+                if (rtcSize)
+                    memcpy(__start_rtc_data, rtc.data(), rtcSize);
+                reboot();
+                try
+                {
+                    entry();
+                }
+                catch (const DeepSleep &sleep)
+                {
+                    uint64_t times[2] = {micros(), sleep.time_us};
+                    fflush(nullptr);
+                    writeAll(fds[1], times, sizeof(times));
+                    if (rtcSize)
+                        writeAll(fds[1], __start_rtc_data, rtcSize);
+                    _exit(0);
+                }
+                fflush(nullptr);
+                _exit(1);
+            }
+
+            close(fds[1]);
+            uint64_t times[2];
+            bool ok = readAll(fds[0], times, sizeof(times)) && readAll(fds[0], rtc.data(), rtcSize);
+            close(fds[0]);
+            int status = 0;
+            waitpid(pid, &status, 0);
+            if (!ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            {
+                fprintf(stderr, "Wake cycle %u did not end in deep sleep\n", cycle);
+                return cycle;
+            }
+            rtcBaseMicros += times[0] + times[1];
+            if (onSleep)
+                onSleep(cycle, times[0]);
+        }
+
+        // Keep RTC memory for subsequent calls
+        if (rtcSize)
+            memcpy(__start_rtc_data, rtc.data(), rtcSize);
+        return 0;
+    }
+
+    bool parseHexLine(const char *line, const char *tag, std::vector<uint8_t> &data)
+    {
+        data.clear();
+        const char *p = line;
+        if (tag)
+        {
+            p = strstr(line, tag);
+            if (!p)
+                return false;
+            p += strlen(tag);
+        }
+
+        while (*p)
+        {
+            while (*p && isspace((unsigned char)*p))
+                p++;
+            if (!isxdigit((unsigned char)p[0]) || !isxdigit((unsigned char)p[1]))
+                break;
+            char hex[3] = {p[0], p[1], '\0'};
+            data.push_back(static_cast<uint8_t>(strtoul(hex, nullptr, 16)));
+            p += 2;
+        }
+        return !data.empty();
+    }
+}
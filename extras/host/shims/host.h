@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////////////
+// host.h
+//
+// Host build - control interface for the Arduino shims
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_H)
+#define _HOST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+namespace host
+{
+    /*!
+     * \brief Thrown by ESP.deepSleep() to end a wake cycle
+     */
+    struct DeepSleep
+    {
+        uint64_t time_us;
+    };
+
+    /*!
+     * \brief Enable/disable virtual time
+     *
+     * With virtual time, delay() returns immediately and advances
+     * millis()/micros() by the requested time instead of sleeping.
+     * Otherwise the clock only advances by 1 µs per read of millis()/micros(),
+     * so busy-wait timeouts expire quickly and runs are reproducible.
+     */
+    void setVirtualTime(bool enable);
+
+    /*!
+     * \brief Restart millis()/micros() at zero (as after wake-up from deep sleep)
+     */
+    void reboot(void);
+
+    /*!
+     * \brief Time since power-on including simulated deep sleep periods [µs]
+     */
+    uint64_t rtcMicros(void);
+
+    /// Set level returned by digitalRead()
+    void setPinLevel(uint8_t pin, int level);
+
+    /// Set runtime log level (messages above CORE_DEBUG_LEVEL are compiled out anyway)
+    void setLogLevel(int level);
+
+    /// Set log output (default: stderr, nullptr: discard)
+    void setLogFile(FILE *file);
+
+    /// Set value returned by ESP.getEfuseMac()
+    void setEfuseMac(uint64_t mac);
+
+    /*!
+     * \brief Run wake cycles, each ending with ESP.deepSleep()
+     *
+     * Each cycle runs in a child process forked from the pristine process
+     * image, so all global objects start from their initial state as after
+     * a reset. Variables declared with RTC_DATA_ATTR are carried over from
+     * one cycle to the next.
+     *
+     * \param cycles number of wake cycles
+     * \param entry entry function, e.g. setup()
+     * \param onSleep called after each cycle with its awake time [µs] (optional)
+     *
+     * \returns 0 on success, otherwise the number of the failed cycle
+     */
+    int runWakeCycles(unsigned cycles, void (*entry)(void),
+                      void (*onSleep)(unsigned cycle, uint64_t awake_us) = nullptr);
+
+    /*!
+     * \brief Parse hex dump line
+     *
+     * Parses lines as printed by log_message(), e.g.
+     * "[...] log_message(): TX-Data: AA AA AA AA 2D D4 ..."
+     *
+     * \param line text line
+     * \param tag tag preceding the hex data (e.g. "TX-Data:"), nullptr: none
+     * \param data parsed data
+     *
+     * \returns true if line contained tag and at least one byte
+     */
+    bool parseHexLine(const char *line, const char *tag, std::vector<uint8_t> &data);
+}
+
+#endif // _HOST_H
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// check.h
+//
+// Host build - minimal assertions for the unit tests in tests/
+//
+// A failed CHECK() prints the location and the condition and is counted;
+// the test continues. main() returns check_result() to ctest.
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HOST_CHECK_H)
+#define _HOST_CHECK_H
+
+#include <stdio.h>
+
+namespace check
+{
+    inline unsigned failures;
+    inline unsigned checks;
+}
+
+/// Check condition, print location and condition on failure
+#define CHECK(cond)                                                             \
+    do                                                                          \
+    {                                                                           \
+        check::checks++;                                                        \
+        if (!(cond))                                                            \
+        {                                                                       \
+            check::failures++;                                                  \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        }                                                                       \
+    } while (0)
+
+/// Check condition, print location, condition and context (printf format) on failure
+#define CHECK_MSG(cond, ...)                                                    \
+    do                                                                          \
+    {                                                                           \
+        check::checks++;                                                        \
+        if (!(cond))                                                            \
+        {                                                                       \
+            check::failures++;                                                  \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, __VA_ARGS__);                                       \
+            fprintf(stderr, "\n");                                              \
+        }                                                                       \
+    } while (0)
+
+/*!
+ * \brief Print summary
+ *
+ * \returns exit code for ctest (0: all checks passed)
+ */
+inline int check_result(void)
+{
+    printf("%u checks, %u failed\n", check::checks, check::failures);
+    return check::failures ? 1 : 0;
+}
+
+#endif // _HOST_CHECK_H
@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// test_digest.cpp
+//
+// Host build - table-driven lfsr_digest16<gen, key>() vs. the bit-serial
+// reference lfsr_digest16(message, bytes, gen, key)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <random>
+#include <vector>
+#include <utils/utils.h>
+#include "check.h"
+
+namespace
+{
+    std::mt19937 rng(0x2DD4);
+
+    /// Compare both implementations for a (gen, key) pair over random and edge-case messages
+    template <uint16_t gen, uint16_t key>
+    void compare(void)
+    {
+        std::vector<uint8_t> msg(300);
+
+        // Empty message, all lengths up to 64 bytes and typical/maximal frame sizes
+        std::vector<unsigned> lengths = {0, 1, 2, 3, 7, 8, 35, 36, 255, 256, 300};
+        for (unsigned n = 4; n <= 64; n++)
+            lengths.push_back(n);
+
+        for (unsigned n : lengths)
+        {
+            for (int run = 0; run < 20; run++)
+            {
+                for (auto &b : msg)
+                    b = rng() & 0xFF;
+                uint16_t ref = lfsr_digest16(msg.data(), n, gen, key);
+                uint16_t tab = lfsr_digest16<gen, key>(msg.data(), n);
+                CHECK_MSG(ref == tab, "gen %04X key %04X bytes %u: %04X vs %04X", gen, key, n, ref, tab);
+            }
+        }
+
+        // Constant messages (all bits clear/set) and single bits
+        for (uint8_t fill : {0x00, 0xFF, 0xAA, 0x55})
+        {
+            std::vector<uint8_t> c(256, fill);
+            for (unsigned n : {1u, 2u, 35u, 256u})
+            {
+                CHECK_MSG(lfsr_digest16(c.data(), n, gen, key) == (lfsr_digest16<gen, key>(c.data(), n)),
+                          "gen %04X key %04X fill %02X bytes %u", gen, key, fill, n);
+            }
+        }
+        for (unsigned bit = 0; bit < 8 * 36; bit++)
+        {
+            uint8_t m[36] = {};
+            m[bit / 8] = 0x80 >> (bit % 8);
+            CHECK_MSG(lfsr_digest16(m, sizeof(m), gen, key) == (lfsr_digest16<gen, key>(m, sizeof(m))),
+                      "gen %04X key %04X bit %u", gen, key, bit);
+        }
+    }
+}
+
+int main()
+{
+    compare<0x8005, 0xBA95>(); // FrameCodec
+    compare<0x8810, 0x5412>(); // other generators/keys, e.g. rtl_433 decoders
+    compare<0x8810, 0xEE94>();
+    compare<0x0001, 0xFFFF>();
+    return check_result();
+}
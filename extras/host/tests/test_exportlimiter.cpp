@@ -0,0 +1,156 @@
+///////////////////////////////////////////////////////////////////////////////
+// test_exportlimiter.cpp
+//
+// Host build - ExportLimiter against the inverter model: power limit
+// computation, hysteresis, write with read-back confirmation, read-back
+// mismatch and write latency
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <growattInterface.h>
+#include <ExportLimiter.h>
+#include "GrowattSlave.h"
+#include "host.h"
+#include "check.h"
+
+/// Modbus interface select: 0 - USB / 1 - RS485
+bool modbusRS485 = true;
+
+namespace
+{
+    /// Inverter with a response time which limits the power limit to <maxLimit> [%]
+    class LimitingDevice : public GrowattSlaveDevice
+    {
+    public:
+        LimitingDevice(GrowattSlave &slave) : GrowattSlaveDevice(slave), slave(slave) {}
+
+        uint32_t responseTime = 20; //!< [ms]
+        uint16_t maxLimit = 100;    //!< [%]
+
+        void onReceive(HardwareSerial &port, const uint8_t *data, size_t size) override
+        {
+            delay(responseTime);
+            GrowattSlaveDevice::onReceive(port, data, size);
+            if (slave.holding[growattIF::regMaxOutputActive] > maxLimit)
+                slave.holding[growattIF::regMaxOutputActive] = maxLimit;
+        }
+
+    private:
+        GrowattSlave &slave;
+    };
+
+    void testComputeLimit(void)
+    {
+        // Zero export: limit to the load
+        CHECK(ExportLimiter::computeLimit(0, 300, 0, 600) == 50);
+        CHECK(ExportLimiter::computeLimit(-60, 300, 0, 600) == 60);
+        CHECK(ExportLimiter::computeLimit(60, 300, 0, 600) == 40);
+
+        // Target export, rounded down
+        CHECK(ExportLimiter::computeLimit(0, 300, 50, 600) == 58);
+        CHECK(ExportLimiter::computeLimit(0.6f, 300, 0, 600) == 49);
+
+        // Limits
+        CHECK(ExportLimiter::computeLimit(400, 300, 0, 600) == 0);
+        CHECK(ExportLimiter::computeLimit(-1000, 300, 0, 600) == 100);
+    }
+
+    void testUpdate(void)
+    {
+        GrowattSlave inverter;
+        LimitingDevice device(inverter);
+        growattIF gw(1, 2, 3, 4);
+
+        Serial2.hostAttach(&device);
+        gw.initGrowatt();
+
+        // Nominal power (600 W) from the inverter's settings
+        CHECK(gw.ReadHoldingRegisters(nullptr, 0) == growattIF::Success);
+        CHECK(gw.modbussettings.maxpower == 600.0f);
+        ExportLimiter limiter(gw);
+        CHECK(limiter.limit() == 0xFF);
+
+        // Unknown limit: written and read back
+        CHECK(limiter.update(0, 300) == growattIF::Success);
+        CHECK(inverter.holding[growattIF::regMaxOutputActive] == 50);
+        CHECK(limiter.limit() == 50);
+        CHECK(gw.modbussettings.maxoutputactivepp == 50);
+        CHECK(limiter.writes() == 1);
+        CHECK_MSG(limiter.latency() >= 2 * device.responseTime, "%lu ms", (unsigned long)limiter.latency());
+        CHECK(limiter.maxLatency() == limiter.latency());
+
+        // Change within the hysteresis: no Modbus request
+        unsigned requests = inverter.stats.requests;
+        CHECK(limiter.update(-6, 300) == growattIF::Success); // 51 %
+        CHECK(limiter.update(-12, 300) == growattIF::Success); // 52 %
+        CHECK(inverter.stats.requests == requests);
+        CHECK(inverter.holding[growattIF::regMaxOutputActive] == 50);
+        CHECK(limiter.limit() == 50);
+        CHECK(limiter.writes() == 1);
+
+        // Export above the target: corrected within the hysteresis
+        CHECK(limiter.update(3, 300) == growattIF::Success); // 49 %
+        CHECK(inverter.holding[growattIF::regMaxOutputActive] == 49);
+        CHECK(inverter.stats.requests == requests + 2);
+        CHECK(limiter.writes() == 2);
+
+        // Change past the hysteresis: written and read back
+        unsigned writes = inverter.stats.writes;
+        CHECK(limiter.update(-60, 300) == growattIF::Success); // 60 %
+        CHECK(inverter.holding[growattIF::regMaxOutputActive] == 60);
+        CHECK(inverter.stats.writes == writes + 1);
+        CHECK(inverter.stats.requests == requests + 4);
+        CHECK(limiter.limit() == 60);
+        CHECK(limiter.writes() == 3);
+
+        // Read-back mismatch: the inverter limits to 80 %
+        device.maxLimit = 80;
+        CHECK(limiter.update(-400, 300) == ExportLimiter::Mismatch); // 100 %
+        CHECK(inverter.holding[growattIF::regMaxOutputActive] == 80);
+        CHECK(limiter.limit() == 0xFF);
+        CHECK(limiter.writes() == 3);
+
+        // Unknown limit again: written on the next update
+        CHECK(limiter.update(-120, 300) == growattIF::Success); // 70 %
+        CHECK(inverter.holding[growattIF::regMaxOutputActive] == 70);
+        CHECK(limiter.limit() == 70);
+        CHECK(limiter.writes() == 4);
+
+        // Slower response: latency and max. latency follow
+        uint32_t latency = limiter.maxLatency();
+        device.maxLimit = 100;
+        device.responseTime = 100;
+        CHECK(limiter.update(-300, 300) == growattIF::Success); // 100 %
+        CHECK_MSG(limiter.latency() >= 2 * device.responseTime, "%lu ms", (unsigned long)limiter.latency());
+        CHECK(limiter.maxLatency() == limiter.latency());
+        CHECK(limiter.maxLatency() > latency);
+
+        // Faster response: max. latency kept
+        latency = limiter.maxLatency();
+        device.responseTime = 20;
+        CHECK(limiter.update(0, 300) == growattIF::Success); // 50 %
+        CHECK(limiter.latency() < latency);
+        CHECK(limiter.maxLatency() == latency);
+
+        // Inverter unreachable: limit unchanged, reported as error
+        inverter.faults.timeout = 1;
+        CHECK(limiter.update(300, 300) != growattIF::Success); // 0 %
+        CHECK(limiter.limit() == 50);
+        CHECK(limiter.writes() == 6);
+
+        Serial2.hostAttach(nullptr);
+    }
+}
+
+int main()
+{
+    host::setVirtualTime(true);
+    host::setLogFile(nullptr);
+
+    testComputeLimit();
+    testUpdate();
+    return check_result();
+}
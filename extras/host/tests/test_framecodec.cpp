@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////////////
+// test_framecodec.cpp
+//
+// Host build - FrameCodec frames of all payload lengths read back, frames
+// without payload length (as sent by transmitters built before it was
+// added), corrupted frames and oversized payloads
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <random>
+#include <FrameCodec.h>
+#include <utils/utils.h>
+#include "check.h"
+
+namespace
+{
+    typedef FrameCodec FC;
+
+    std::mt19937 rng(0x2DD4);
+
+    /// Received data: frame followed by random bytes up to the capture size
+    struct Capture
+    {
+        uint8_t buf[FC::CaptureSize - 1];
+
+        void fill(void)
+        {
+            for (auto &b : buf)
+                b = rng() & 0xFF;
+        }
+    };
+
+    /*!
+     * Frame without payload length, built like the original gw_transmitter:
+     * digest, 4-byte chip ID (upper byte: port) and padded payload
+     */
+    void legacyFrame(uint8_t *frame, uint8_t port, uint32_t id, const uint8_t *payload, uint8_t size)
+    {
+        memset(frame, 0, FC::LegacyFrameSize);
+        frame[2] = port;
+        for (int i = 0; i < 3; i++)
+            frame[3 + i] = (id >> (16 - i * 8)) & 0xFF;
+        memcpy(&frame[6], payload, size);
+
+        uint16_t digest = lfsr_digest16(&frame[2], FC::LegacyFrameSize - 2, 0x8005, 0xba95) ^ 0x6df1;
+        frame[0] = digest >> 8;
+        frame[1] = digest & 0xFF;
+        for (int i = 0; i < FC::LegacyFrameSize; i++)
+            frame[i] ^= 0xAA;
+    }
+
+    void testRoundTrip(void)
+    {
+        Capture rx;
+        uint8_t payload[FC::PayloadSize];
+
+        for (uint8_t size = 0; size <= FC::PayloadSize; size++)
+        {
+            for (int run = 0; run < 100; run++)
+            {
+                uint32_t id = rng() & 0xFFFFFF;
+                uint8_t port = FC::dataPort(rng() % (FC::MaxIndex + 1), 1 + rng() % FC::PortAck);
+                for (auto &b : payload)
+                    b = rng() & 0xFF;
+
+                // Random bytes or zeros (after de-whitening) following the frame
+                rx.fill();
+                if (run & 1)
+                    memset(rx.buf, 0xAA, sizeof(rx.buf));
+                memcpy(&rx.buf[FC::HeaderSize], payload, size);
+                CHECK(FC::encode(rx.buf, port, id, size) == FC::HeaderSize + size);
+                uint8_t after[sizeof(rx.buf)];
+                memcpy(after, rx.buf, sizeof(after));
+
+                CHECK_MSG(FC::decode(rx.buf, sizeof(rx.buf)) == FC::HeaderSize + size, "size %u", size);
+                CHECK(FC::getLength(rx.buf) == size);
+                CHECK(FC::getId(rx.buf) == id);
+                CHECK(FC::getPort(rx.buf) == (port & 0x0F));
+                CHECK(FC::getIndex(rx.buf) == (port >> 4));
+                CHECK(memcmp(&rx.buf[FC::HeaderSize], payload, size) == 0);
+
+                // Bytes following the frame are left untouched
+                CHECK(memcmp(&rx.buf[FC::HeaderSize + size], &after[FC::HeaderSize + size],
+                             sizeof(rx.buf) - FC::HeaderSize - size) == 0);
+            }
+        }
+    }
+
+    void testLegacy(void)
+    {
+        Capture rx;
+        uint8_t payload[FC::PayloadSize];
+
+        // Original transmitter (v1 payload, byte 2 is 0) and transmitters with port support;
+        // short payloads (e.g. format 2 after a Modbus error) must not pass as frames with payload length
+        for (uint8_t port : {(uint8_t)0, FC::PortData, FC::PortTiming, FC::dataPort(2, FC::PortFamily)})
+        {
+            for (int run = 0; run < 200; run++)
+            {
+                uint32_t id = rng() & 0xFFFFFF;
+                uint8_t size = (run < 20) ? 1 + run % 4 : 1 + rng() % FC::PayloadSize;
+                for (auto &b : payload)
+                    b = rng() & 0xFF;
+
+                rx.fill();
+                legacyFrame(rx.buf, port, id, payload, size);
+                CHECK_MSG(FC::decode(rx.buf, sizeof(rx.buf)) == FC::HeaderSize + FC::PayloadSize, "port %u", port);
+                CHECK(FC::getLength(rx.buf) == FC::PayloadSize);
+                CHECK(FC::getId(rx.buf) == id);
+                CHECK(FC::getPort(rx.buf) == (port ? (port & 0x0F) : FC::PortData));
+                CHECK(FC::getIndex(rx.buf) == (port >> 4));
+                CHECK(memcmp(&rx.buf[FC::HeaderSize], payload, size) == 0);
+                for (uint8_t i = size; i < FC::PayloadSize; i++)
+                    CHECK(rx.buf[FC::HeaderSize + i] == 0);
+            }
+        }
+
+        // The converted frame needs HeaderSize + PayloadSize bytes
+        legacyFrame(rx.buf, 0, 0x123456, payload, FC::PayloadSize);
+        CHECK(FC::decode(rx.buf, FC::LegacyFrameSize) == 0);
+    }
+
+    void testOversized(void)
+    {
+        // Not encoded, the receiver would drop the frame
+        uint8_t buf[FC::HeaderSize + 64];
+        memset(buf, 0x55, sizeof(buf));
+        for (unsigned size : {FC::PayloadSize + 1u, 64u})
+            CHECK_MSG(FC::encode(buf, FC::PortData, 0x00C3D4E5, size) == 0, "size %u", size);
+        for (uint8_t b : buf)
+            CHECK(b == 0x55);
+    }
+
+    void testCorrupted(void)
+    {
+        Capture rx;
+        unsigned accepted = 0;
+
+        for (int run = 0; run < 2000; run++)
+        {
+            uint8_t size = rng() % (FC::PayloadSize + 1);
+            rx.fill();
+            if (run & 1)
+            {
+                FC::encode(rx.buf, FC::PortData, 0x00C3D4E5, size);
+                rx.buf[rng() % (FC::HeaderSize + size)] ^= 1 << (rng() % 8);
+            }
+            else
+            {
+                uint8_t payload[FC::PayloadSize];
+                memcpy(payload, &rx.buf[FC::HeaderSize], size);
+                legacyFrame(rx.buf, 0, 0x00C3D4E5, payload, size);
+                rx.buf[rng() % FC::LegacyFrameSize] ^= 1 << (rng() % 8);
+            }
+            if (FC::decode(rx.buf, sizeof(rx.buf)))
+                accepted++;
+        }
+        CHECK_MSG(accepted == 0, "%u corrupted frames accepted", accepted);
+
+        // Too short for a header
+        rx.fill();
+        CHECK(FC::decode(rx.buf, FC::HeaderSize - 1) == 0);
+    }
+}
+
+int main(void)
+{
+    testRoundTrip();
+    testLegacy();
+    testCorrupted();
+    testOversized();
+    return check_result();
+}
@@ -0,0 +1,146 @@
+///////////////////////////////////////////////////////////////////////////////
+// test_jsonwriter.cpp
+//
+// Host build - JsonWriter output parsed back (numbers and strings), out of
+// range numbers and buffer overflow
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+#include <utils/jsonwriter.h>
+#include "check.h"
+
+namespace
+{
+    std::mt19937 rng(0x2DD4);
+
+    /// Write a single fixed point member and return the value's text
+    const char *number(char *buf, size_t size, float value, uint8_t decimals)
+    {
+        JsonWriter writer(buf, size);
+        writer.add("v", value, decimals);
+        writer.end();
+        // Skip {"v":
+        return (strlen(buf) > 5) ? &buf[5] : buf;
+    }
+
+    /// Parse the fixed point value back and compare to the value (half a digit + float rounding)
+    void roundTrip(float value, uint8_t decimals)
+    {
+        char buf[48];
+        const char *text = number(buf, sizeof(buf), value, decimals);
+        char *end;
+        double parsed = strtod(text, &end);
+        CHECK_MSG(strcmp(end, "}") == 0, "%.9g: %s", value, buf);
+
+        // Exactly <decimals> digits after the point, no "-0"
+        const char *point = strchr(text, '.');
+        CHECK_MSG(decimals ? (point && (size_t)(end - point - 1) == decimals) : !point,
+                  "%.9g decimals %u: %s", value, decimals, buf);
+        CHECK_MSG(!(text[0] == '-' && parsed == 0), "%.9g decimals %u: %s", value, decimals, buf);
+
+        double tolerance = 0.5 * pow(10.0, -decimals) + fabs(value) * 1.2e-7;
+        CHECK_MSG(fabs(parsed - value) <= tolerance, "%.9g decimals %u: %s", value, decimals, buf);
+    }
+
+    void testNumbers(void)
+    {
+        // Typical register values
+        for (float value : {0.0f, -0.0f, 0.04f, -0.04f, 0.05f, 0.5f, -0.5f, 1.0f, 49.99f, 50.01f,
+                            230.4f, -12.3f, 5555.5f, 1234567.5f, 65535.0f, 2147483.6f})
+        {
+            for (uint8_t decimals = 0; decimals <= 6; decimals++)
+                roundTrip(value, decimals);
+        }
+
+        // Random values over the range of the register contents
+        std::uniform_real_distribution<float> dist(-1e7f, 1e7f);
+        for (int i = 0; i < 10000; i++)
+            roundTrip(dist(rng), rng() % 4);
+
+        // Integer members incl. limits
+        for (int32_t value : {0, 1, -1, 600, INT32_MAX, INT32_MIN})
+        {
+            char buf[32];
+            char expected[32];
+            JsonWriter writer(buf, sizeof(buf));
+            writer.add("v", value);
+            writer.end();
+            snprintf(expected, sizeof(expected), "{\"v\":%ld}", (long)value);
+            CHECK_MSG(strcmp(buf, expected) == 0, "%s vs %s", buf, expected);
+        }
+    }
+
+    void testOutOfRange(void)
+    {
+        char buf[48];
+
+        // NaN, infinite and values which do not fit into 64 bits after scaling
+        for (float value : {NAN, INFINITY, -INFINITY, 1e18f, -1e18f, 3e38f})
+            CHECK_MSG(strcmp(number(buf, sizeof(buf), value, 0), "null}") == 0, "%g: %s", value, buf);
+        CHECK_MSG(strcmp(number(buf, sizeof(buf), 1e13f, 6), "null}") == 0, "%s", buf);
+
+        // Large value below the limit (2^36, exact in single precision)
+        CHECK_MSG(strcmp(number(buf, sizeof(buf), 68719476736.0f, 6), "68719476736.000000}") == 0, "%s", buf);
+
+        // More than 6 decimals are limited to 6
+        CHECK_MSG(strcmp(number(buf, sizeof(buf), 1.5f, 9), "1.500000}") == 0, "%s", buf);
+    }
+
+    void testStrings(void)
+    {
+        char buf[64];
+        JsonWriter writer(buf, sizeof(buf));
+        writer.add("s", "a\"b\\c\n\x01");
+        writer.add("n", "serial123456", 5);
+        writer.addHex("h", 0x6, 4);
+        CHECK(writer.end() == strlen(buf));
+        CHECK_MSG(strcmp(buf, "{\"s\":\"a\\\"b\\\\c\\u000a\\u0001\",\"n\":\"seria\",\"h\":\"0006\"}") == 0, "%s", buf);
+    }
+
+    void testOverflow(void)
+    {
+        const char *full = "{\"status\":1,\"outputpower\":600.0,\"serial\":\"AB\"}";
+        size_t len = strlen(full);
+
+        // Every buffer size from 0 up to the required size + 1
+        for (size_t size = 0; size <= len + 1; size++)
+        {
+            char buf[64];
+            memset(buf, 0x55, sizeof(buf));
+            JsonWriter writer(buf, size);
+            writer.add("status", 1);
+            writer.add("outputpower", 600.0f, 1);
+            writer.add("serial", "AB");
+            size_t n = writer.end();
+
+            if (size > len)
+            {
+                CHECK_MSG(!writer.overflow() && n == len && strcmp(buf, full) == 0, "size %zu: %s", size, buf);
+            }
+            else
+            {
+                CHECK_MSG(writer.overflow() && n == 0, "size %zu", size);
+                CHECK_MSG(size == 0 || buf[0] == '\0', "size %zu", size);
+            }
+
+            // Nothing written beyond the buffer
+            for (size_t i = size; i < sizeof(buf); i++)
+                CHECK_MSG(buf[i] == 0x55, "size %zu: byte %zu written", size, i);
+        }
+    }
+}
+
+int main(void)
+{
+    testNumbers();
+    testOutOfRange();
+    testStrings();
+    testOverflow();
+    return check_result();
+}
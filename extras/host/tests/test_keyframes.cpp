@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// test_keyframes.cpp
+//
+// Host build - payload format 3 (keyframes and deltas) with frame loss
+//
+// AppLayer (compiled with PAYLOAD_FORMAT 3) encodes the data frames of the
+// inverter model. A receiver model decodes them like gw_receiver.ino and
+// acknowledges the keyframes it gets (AppLayer::decodeDownlink()). The
+// receiver is awake for about one of five frames (sleep interval 300 s vs.
+// 60 s); frames and acknowledgements are lost at random, and the receiver
+// loses its keyframe once (reset). Every delta frame the receiver gets must
+// refer to its keyframe - except for at most PAYLOAD_KEYFRAME_INTERVAL
+// frames after the reset - and decode to the transmitted values.
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <LoraEncoder.h>
+#include <AppLayer.h>
+#include <FrameCodec.h>
+#include <PayloadCodec.h>
+#include <growattInterface.h>
+#include <random>
+#include "GrowattSlave.h"
+#include "host.h"
+#include "check.h"
+
+static_assert(PAYLOAD_FORMAT == 3, "test_keyframes requires PAYLOAD_FORMAT 3");
+
+/// Modbus interface select: 0 - USB / 1 - RS485
+bool modbusRS485 = true;
+
+extern growattIF growattInterface; // see AppLayer.cpp
+
+namespace
+{
+    typedef PayloadCodec PC;
+
+    /// Receiver's keyframe of the transmitter ID/inverter pair (see gw_receiver.ino)
+    struct Receiver
+    {
+        bool valid = false;
+        uint8_t key = 0;
+        int32_t raw[PC::NumValues] = {};
+
+        enum Result
+        {
+            Key,
+            Delta,
+            Skip
+        };
+
+        /// Decode data frame payload to <raw>
+        Result decode(const uint8_t *payload, uint8_t size, int32_t *out)
+        {
+            if (payload[0] == FrameCodec::FormatKey)
+            {
+                CHECK(size == 2 + PC::AbsoluteSize);
+                key = payload[1];
+                PC::readAbsolute(&payload[2], raw);
+                valid = true;
+                memcpy(out, raw, sizeof(raw));
+                return Key;
+            }
+            CHECK_MSG(payload[0] == FrameCodec::FormatDelta, "format %02X", payload[0]);
+            if (!valid || (key != payload[2]))
+                return Skip;
+            CHECK(PC::readDelta(&payload[4], payload[3], raw, out) == payload[3]);
+            CHECK(size == 4 + payload[3]);
+            return Delta;
+        }
+    };
+
+    /// Values as encoded by AppLayer (see encodeData())
+    void transmitted(int32_t *raw)
+    {
+        const growattIF::modbus_input_registers &data = growattInterface.modbusdata;
+        raw[PC::Status] = data.status;
+        raw[PC::FaultCode] = data.faultcode;
+        raw[PC::EnergyToday] = PC::toRaw(PC::EnergyToday, data.energytoday);
+        raw[PC::EnergyTotal] = PC::toRaw(PC::EnergyTotal, data.energytotal);
+        raw[PC::TotalWorkTime] = PC::toRaw(PC::TotalWorkTime, data.totalworktime);
+        raw[PC::OutputPower] = PC::toRaw(PC::OutputPower, data.outputpower);
+        raw[PC::GridVoltage] = PC::toRaw(PC::GridVoltage, data.gridvoltage);
+        raw[PC::GridFrequency] = PC::toRaw(PC::GridFrequency, data.gridfrequency);
+        raw[PC::TempInverter] = PC::toRaw(PC::TempInverter, data.tempinverter);
+        PC::clamp(raw);
+    }
+}
+
+int main()
+{
+    host::setVirtualTime(true);
+    host::setLogFile(nullptr);
+
+    GrowattSlave inverter;
+    GrowattSlaveDevice device(inverter);
+    Serial2.hostAttach(&device);
+
+    AppLayer appLayer;
+    appLayer.begin();
+
+    std::mt19937 rng(0x2DD4);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    Receiver rx;
+    const unsigned Cycles = 3000;
+    const unsigned ResetCycle = Cycles / 2;
+    unsigned count[3] = {};
+    unsigned sinceReset = 0;
+    uint32_t energy = 12345;
+
+    for (unsigned cycle = 0; cycle < Cycles; cycle++)
+    {
+        // Changing values: output power, energy today and grid voltage
+        inverter.setInput32(35, 6000 + rng() % 2000);
+        inverter.setInput32(53, energy += rng() % 3);
+        inverter.input[38] = 2280 + rng() % 40;
+
+        uint8_t payload[64];
+        LoraEncoder encoder(payload);
+        appLayer.getPayloadStage2(1, encoder, 0);
+        uint8_t size = encoder.getLength();
+        CHECK(size <= FrameCodec::PayloadSize);
+
+        if (cycle == ResetCycle)
+        {
+            // Receiver lost its keyframe (e.g. power loss)
+            rx.valid = false;
+            sinceReset = 0;
+        }
+        sinceReset++;
+
+        // Receiver asleep or frame lost
+        if ((uniform(rng) > 0.2) || (uniform(rng) < 0.1))
+            continue;
+
+        int32_t raw[PC::NumValues];
+        int32_t expected[PC::NumValues];
+        Receiver::Result result = rx.decode(payload, size, raw);
+        count[result]++;
+        if (result == Receiver::Skip)
+        {
+            // Only until the next keyframe after the receiver's reset
+            CHECK_MSG((cycle >= ResetCycle) && (sinceReset <= PAYLOAD_KEYFRAME_INTERVAL),
+                      "cycle %u: keyframe %u not received", cycle, payload[2]);
+            continue;
+        }
+        transmitted(expected);
+        CHECK_MSG(memcmp(raw, expected, sizeof(raw)) == 0, "cycle %u", cycle);
+
+        // Acknowledgement (lost at random)
+        if ((result == Receiver::Key) && (uniform(rng) >= 0.1))
+        {
+            uint8_t ack[] = {0, rx.key};
+            appLayer.decodeDownlink(FrameCodec::PortAck, ack, sizeof(ack));
+            CHECK(!appLayer.ackPending());
+        }
+    }
+
+    // Unacknowledged keyframes are resent, so deltas are the majority of the received frames
+    printf("Received: %u keyframes, %u deltas, %u skipped\n", count[Receiver::Key], count[Receiver::Delta],
+           count[Receiver::Skip]);
+    CHECK(count[Receiver::Delta] > count[Receiver::Key]);
+
+    // Acknowledgement of another keyframe or inverter is ignored
+    uint8_t payload[64];
+    do
+    {
+        LoraEncoder encoder(payload);
+        appLayer.getPayloadStage2(1, encoder, 0);
+    } while (payload[0] != FrameCodec::FormatKey);
+    uint8_t ack[] = {0, (uint8_t)(payload[1] + 1), GROWATT_MAX_INVERTERS, payload[1]};
+    appLayer.decodeDownlink(FrameCodec::PortAck, ack, sizeof(ack));
+    CHECK(appLayer.ackPending());
+
+    return check_result();
+}
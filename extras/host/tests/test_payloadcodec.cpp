@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////
+// test_payloadcodec.cpp
+//
+// Host build - PayloadCodec absolute and delta encodings read back, out of
+// range values (clamp()) and invalid delta encodings
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <random>
+#include <PayloadCodec.h>
+#include "check.h"
+
+namespace
+{
+    typedef PayloadCodec PC;
+
+    std::mt19937 rng(0x2DD4);
+
+    // Value ranges of the encoding (see PayloadCodec::Value)
+    const int32_t Min[PC::NumValues] = {0, 0, 0, 0, 0, -(1 << 23), 0, 0, -(1 << 15)};
+    const int32_t Max[PC::NumValues] = {255, 255, 65535, INT32_MAX, INT32_MAX, (1 << 23) - 1, 65535, 65535, (1 << 15) - 1};
+
+    /// Random values within the ranges, mostly small changes to <base> if given
+    void randomValues(int32_t *raw, const int32_t *base = nullptr)
+    {
+        for (int i = 0; i < PC::NumValues; i++)
+        {
+            int64_t value;
+            if (base && (rng() % 4))
+            {
+                value = (int64_t)base[i] + (int64_t)(rng() % 201) - 100;
+            }
+            else
+            {
+                value = Min[i] + (int64_t)(rng() % ((uint32_t)Max[i] - (uint32_t)Min[i] + 1u));
+            }
+            raw[i] = (int32_t)((value < Min[i]) ? Min[i] : (value > Max[i]) ? Max[i] : value);
+        }
+    }
+
+    /// Transmitter: keyframe <key> and delta <raw>; receiver: reads both; values must match
+    void roundTrip(const int32_t *key, const int32_t *raw)
+    {
+        uint8_t buf[PC::MaxDeltaSize];
+        int32_t rxKey[PC::NumValues];
+        int32_t rxRaw[PC::NumValues];
+
+        CHECK(PC::writeAbsolute(buf, key) == PC::AbsoluteSize);
+        CHECK(PC::readAbsolute(buf, rxKey) == PC::AbsoluteSize);
+        CHECK(memcmp(rxKey, key, sizeof(rxKey)) == 0);
+
+        uint8_t size = PC::writeDelta(buf, raw, key);
+        CHECK(size >= 2 && size <= PC::MaxDeltaSize);
+        CHECK(PC::readDelta(buf, size, rxKey, rxRaw) == size);
+        for (int i = 0; i < PC::NumValues; i++)
+            CHECK_MSG(rxRaw[i] == raw[i], "value %d: %ld vs %ld", i, (long)rxRaw[i], (long)raw[i]);
+    }
+
+    void testRoundTrip(void)
+    {
+        int32_t key[PC::NumValues];
+        int32_t raw[PC::NumValues];
+
+        // Limits
+        roundTrip(Min, Max);
+        roundTrip(Max, Min);
+        roundTrip(Min, Min);
+
+        for (int run = 0; run < 20000; run++)
+        {
+            randomValues(key);
+            randomValues(raw, (run & 1) ? key : nullptr);
+            roundTrip(key, raw);
+        }
+
+        // Physical values and back
+        CHECK(PC::toRaw(PC::GridFrequency, 49.99f) == 4999);
+        CHECK(PC::toRaw(PC::OutputPower, -12.34f) == -123);
+        CHECK(PC::toPhysical(PC::TempInverter, -11) == -1.1f);
+    }
+
+    void testClamp(void)
+    {
+        int32_t key[PC::NumValues];
+        int32_t raw[PC::NumValues];
+
+        // Out of range values in the keyframe and in the following data frame
+        const int32_t high[PC::NumValues] = {256, 1000, 65536, INT32_MAX, INT32_MAX, 1 << 23, 70000, 100000, 1 << 15};
+        const int32_t low[PC::NumValues] = {-1, -1000, -1, -1, INT32_MIN, -(1 << 23) - 1, -5, -1, -(1 << 15) - 1};
+        for (const int32_t *value : {high, low})
+        {
+            memcpy(key, value, sizeof(key));
+            PC::clamp(key);
+            for (int i = 0; i < PC::NumValues; i++)
+                CHECK_MSG(key[i] == ((value == high) ? Max[i] : Min[i]), "value %d: %ld", i, (long)key[i]);
+
+            randomValues(raw, key);
+            roundTrip(key, raw);
+
+            // Delta across the whole range, out of range the other way
+            memcpy(raw, (value == high) ? low : high, sizeof(raw));
+            PC::clamp(raw);
+            roundTrip(key, raw);
+        }
+
+        // Values within the ranges are unchanged
+        for (int run = 0; run < 1000; run++)
+        {
+            randomValues(raw);
+            memcpy(key, raw, sizeof(key));
+            PC::clamp(key);
+            CHECK(memcmp(key, raw, sizeof(key)) == 0);
+        }
+    }
+
+    void testInvalidDelta(void)
+    {
+        int32_t ref[PC::NumValues] = {};
+        int32_t raw[PC::NumValues];
+        int32_t out[PC::NumValues];
+        uint8_t buf[PC::MaxDeltaSize];
+
+        randomValues(raw);
+        uint8_t size = PC::writeDelta(buf, raw, ref);
+
+        // Truncated encodings
+        for (uint8_t n = 0; n < size; n++)
+            CHECK_MSG(PC::readDelta(buf, n, ref, out) == 0, "size %u of %u", n, size);
+
+        // Varint longer than 5 bytes
+        const uint8_t overlong[] = {0x01, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+        CHECK(PC::readDelta(overlong, sizeof(overlong), ref, out) == 0);
+
+        // Unchanged values: mask only
+        CHECK(PC::writeDelta(buf, ref, ref) == 2);
+        CHECK(PC::readDelta(buf, 2, ref, out) == 2);
+        CHECK(memcmp(out, ref, sizeof(out)) == 0);
+    }
+}
+
+int main(void)
+{
+    testRoundTrip();
+    testClamp();
+    testInvalidDelta();
+    return check_result();
+}
@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////
+// test_uart_events.cpp
+//
+// Host build - event-driven Modbus reception (MODBUS_UART_EVENTS)
+//
+// The UART event (RX timeout) is emulated by the HardwareSerial shim when
+// time advances; growattIF must only consume data while an acquisition
+// waits for a response, so blocking ModbusMaster transactions keep theirs.
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <growattInterface.h>
+#include "GrowattSlave.h"
+#include "host.h"
+#include "check.h"
+
+/// Modbus interface select: 0 - USB / 1 - RS485
+bool modbusRS485 = true;
+
+int main()
+{
+    host::setVirtualTime(true);
+    host::setLogFile(nullptr);
+
+    GrowattSlave inverter;
+    GrowattSlaveDevice device(inverter);
+    growattIF gw(1, 2, 3, 4);
+
+    Serial2.hostAttach(&device);
+    gw.initGrowatt();
+
+    for (int i = 0; i < 10; i++)
+    {
+        // Acquisition - response completed by the UART event
+        CHECK(gw.ReadInputRegisters(nullptr, 0) == growattIF::Success);
+        CHECK(gw.modbusdata.outputpower == 600.0f);
+
+        // Blocking ModbusMaster transactions in between (e.g. ExportLimiter)
+        uint16_t value = 0;
+        CHECK(gw.writeRegister(growattIF::regMaxOutputActive, 50 + i) == growattIF::Success);
+        CHECK(gw.readRegister(growattIF::regMaxOutputActive, value) == growattIF::Success);
+        CHECK(value == 50 + i);
+    }
+
+    // Data received while no acquisition waits for a response is left in the UART
+    Serial2.hostAttach(nullptr);
+    const uint8_t response[] = {0x01, 0x03, 0x02, 0x00, 0x50, 0xB8, 0x78};
+    Serial2.hostFeed(response, sizeof(response));
+    delay(10);
+    CHECK(Serial2.available() == (int)sizeof(response));
+    for (uint8_t b : response)
+    {
+        CHECK(Serial2.read() == b);
+    }
+
+    return check_result();
+}
@@ -0,0 +1,165 @@
+///////////////////////////////////////////////////////////////////////////////
+// gw_modbus.cpp
+//
+// Host build - Modbus transaction capture analyzer
+//
+// Converts the transactions dumped by growattIF::dumpCapture() ("MODBUS: XX XX ..."
+// lines, e.g. a captured serial log; see MODBUS_CAPTURE in growatt_cfg.h)
+// to text and summarizes the timing, as a basis for tuning
+// MODBUS_RESPONSE_TIMEOUT, MODBUS_PROBE_TIMEOUT and the inter-frame gap.
+//
+// Per transaction:
+//   tx      request start [ms since wake-up]
+//   turn    inverter turnaround: end of request to start of response [ms]
+//           (estimated from the time of the last byte read and the
+//           response's wire time - an upper bound without MODBUS_UART_EVENTS)
+//   rsp     end of request to last response byte read [ms]
+//   gap     end of previous response to start of request [ms]
+//
+// Usage: gw_modbus [--baud <rate>] [file] (default: stdin)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "ModbusReplay.h"
+
+namespace
+{
+    struct Range
+    {
+        unsigned count = 0;
+        double min = 0;
+        double max = 0;
+        double sum = 0;
+
+        void add(double v)
+        {
+            if (!count || v < min)
+                min = v;
+            if (!count || v > max)
+                max = v;
+            sum += v;
+            count++;
+        }
+
+        void print(const char *name) const
+        {
+            if (count)
+                printf("%-10s min %8.2f  avg %8.2f  max %8.2f ms  (%u)\n", name, min, sum / count, max, count);
+        }
+    };
+
+    const char *resultName(uint8_t result)
+    {
+        switch (result)
+        {
+        case 0x00: return "OK";
+        case 0x01: return "ILL_FUNC";
+        case 0x02: return "ILL_ADDR";
+        case 0x03: return "ILL_VALUE";
+        case 0x04: return "DEV_FAIL";
+        case 0xE0: return "BAD_SLAVE";
+        case 0xE1: return "BAD_FUNC";
+        case 0xE2: return "TIMEOUT";
+        case 0xE3: return "BAD_CRC";
+        default:   return "?";
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned baud = 9600;
+    const char *path = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--baud") && i + 1 < argc)
+            baud = atoi(argv[++i]);
+        else if (argv[i][0] != '-')
+            path = argv[i];
+        else
+        {
+            fprintf(stderr, "Usage: %s [--baud <rate>] [file]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    FILE *in = path ? fopen(path, "r") : stdin;
+    if (!in || !baud)
+    {
+        perror(path);
+        return 1;
+    }
+
+    std::vector<ModbusTransaction> log;
+    loadModbusCapture(in, log);
+
+    // Wire time of a character (11 bits) [ms]
+    const double charTime = 11000.0 / baud;
+    Range turn, rsp, gap;
+    unsigned results[256] = {};
+    double maxTimeoutRsp = 0;
+
+    printf("   #    tx [ms] slave fc  addr  qty result     turn [ms]  rsp [ms]  gap [ms]\n");
+    for (size_t i = 0; i < log.size(); i++)
+    {
+        const ModbusTransaction &t = log[i];
+        uint8_t slave = (t.req.size() > 0) ? t.req[0] : 0;
+        uint8_t fc = (t.req.size() > 1) ? t.req[1] : 0;
+        unsigned addr = (t.req.size() > 3) ? (t.req[2] << 8) | t.req[3] : 0;
+        unsigned qty = (t.req.size() > 5) ? (t.req[4] << 8) | t.req[5] : 0;
+
+        // Times restart after each wake-up
+        if (i > 0 && (int32_t)(t.txStart - log[i - 1].txStart) < 0)
+            printf("--- wake ---\n");
+        results[t.result]++;
+        printf("%4zu %10.3f %5u %02X %5u %4u %-9s", i, t.txStart / 1000.0, slave, fc, addr, qty, resultName(t.result));
+
+        if (!t.rsp.empty())
+        {
+            double r = (int32_t)(t.rxLast - t.txEnd) / 1000.0;
+            double tu = r - t.rsp.size() * charTime;
+            turn.add(tu);
+            rsp.add(r);
+            printf(" %9.2f %9.2f", tu, r);
+        }
+        else
+        {
+            printf(" %9s %9s", "-", "-");
+        }
+        // Gap to the previous response (same wake cycle only)
+        if (i > 0 && !log[i - 1].rsp.empty() && (int32_t)(t.txStart - log[i - 1].rxLast) > 0)
+        {
+            double g = (t.txStart - log[i - 1].rxLast) / 1000.0;
+            gap.add(g);
+            printf(" %9.2f", g);
+        }
+        printf("\n");
+
+        if (t.result == 0xE2 && !t.rsp.empty())
+            maxTimeoutRsp = (int32_t)(t.rxLast - t.txEnd) / 1000.0;
+    }
+
+    printf("\n%zu transactions:", log.size());
+    for (unsigned r = 0; r < 256; r++)
+        if (results[r])
+            printf(" %s %u", resultName(r), results[r]);
+    printf("\n");
+    turn.print("turn");
+    rsp.print("rsp");
+    gap.print("gap");
+    printf("min. inter-frame gap (3.5 chars at %u baud): %.2f ms\n", baud, (baud > 19200) ? 1.75 : 3.5 * charTime);
+    if (maxTimeoutRsp > 0)
+        printf("incomplete response until %.2f ms before timeout\n", maxTimeoutRsp);
+    if (rsp.count)
+        printf("MODBUS_RESPONSE_TIMEOUT >= %.0f ms, MODBUS_PROBE_TIMEOUT >= %.0f ms (2 x max.)\n",
+               2 * rsp.max + 0.5, 2 * turn.max + 0.5);
+
+    return 0;
+}
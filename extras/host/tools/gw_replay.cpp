@@ -0,0 +1,187 @@
+///////////////////////////////////////////////////////////////////////////////
+// gw_replay.cpp
+//
+// Host build - replays captured frames through the receiver's
+// getMessage() / decodeMessage() at full speed
+//
+// Input formats:
+// - text: "TX-Data: XX XX ..." lines as printed by log_message("TX-Data", ...)
+//   in the transmitter's debug log (or by gw_transmitter_host)
+// - binary (--bin): sequence of <length (1 byte)> <frame (length bytes)>
+//
+// Frames are read completely before replay starts, so file I/O is not
+// included in the timing.
+//
+// Usage: gw_replay [options] [file] (default: stdin)
+//   --bin          binary input
+//   --id <hex>     accept only this transmitter ID (default: 0 - any)
+//   --repeat <n>   replay all frames n times (default: 1)
+//   --verbose      print log messages (stderr) and JSON output (stdout)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <vector>
+#include "host.h"
+
+// Transmitter ID filter is set at run time
+static uint32_t replayTransmitterId = 0;
+#define TRANSMITTER_ID replayTransmitterId
+#define RX_TIMEOUT 0
+
+// Arduino generates prototypes for functions in .ino files
+void mqtt_connect(void);
+
+#include "../../../examples/gw_receiver/gw_receiver.ino"
+
+namespace
+{
+    struct Stats
+    {
+        unsigned frames = 0;
+        unsigned ok = 0;
+        unsigned noSync = 0;
+        unsigned digestErrors = 0;
+        unsigned idRejects = 0;
+        unsigned other = 0;
+        size_t jsonBytes = 0;
+    };
+
+    bool readText(FILE *in, std::vector<std::vector<uint8_t>> &frames)
+    {
+        char line[1024];
+        std::vector<uint8_t> data;
+        while (fgets(line, sizeof(line), in))
+        {
+            if (host::parseHexLine(line, "TX-Data:", data))
+                frames.push_back(data);
+        }
+        return true;
+    }
+
+    bool readBinary(FILE *in, std::vector<std::vector<uint8_t>> &frames)
+    {
+        int len;
+        while ((len = fgetc(in)) != EOF)
+        {
+            std::vector<uint8_t> data(len);
+            if (fread(data.data(), 1, len, in) != (size_t)len)
+            {
+                fprintf(stderr, "Truncated frame in binary input\n");
+                return false;
+            }
+            frames.push_back(data);
+        }
+        return true;
+    }
+
+    void usage(const char *prog)
+    {
+        fprintf(stderr, "Usage: %s [--bin] [--id <hex>] [--repeat <n>] [--verbose] [file]\n", prog);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bool binary = false;
+    bool verbose = false;
+    unsigned repeat = 1;
+    const char *path = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--bin"))
+            binary = true;
+        else if (!strcmp(argv[i], "--verbose"))
+            verbose = true;
+        else if (!strcmp(argv[i], "--id") && i + 1 < argc)
+            replayTransmitterId = strtoul(argv[++i], nullptr, 16);
+        else if (!strcmp(argv[i], "--repeat") && i + 1 < argc)
+            repeat = atoi(argv[++i]);
+        else if (argv[i][0] != '-')
+            path = argv[i];
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    FILE *in = path ? fopen(path, binary ? "rb" : "r") : stdin;
+    if (!in)
+    {
+        perror(path);
+        return 1;
+    }
+    std::vector<std::vector<uint8_t>> frames;
+    bool valid = binary ? readBinary(in, frames) : readText(in, frames);
+    if (path)
+        fclose(in);
+    if (!valid)
+        return 1;
+
+    host::setVirtualTime(true);
+    if (!verbose)
+        host::setLogFile(nullptr);
+
+    setupRadio();
+
+    Stats stats;
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+
+    for (unsigned r = 0; r < repeat; r++)
+    {
+        for (const std::vector<uint8_t> &frame : frames)
+        {
+            stats.frames++;
+            host::radioQueue(frame.data(), frame.size());
+            radio.startReceive();
+            if (!receivedFlag)
+            {
+                // sync word not found - not received by the radio
+                stats.noSync++;
+                continue;
+            }
+
+            switch (getMessage())
+            {
+            case DECODE_OK:
+                stats.ok++;
+                stats.jsonBytes += strlen(json);
+                if (verbose)
+                    printf("%s\n", json);
+                break;
+            case DECODE_DIG_ERR:
+                stats.digestErrors++;
+                break;
+            case DECODE_INVALID:
+                // digest valid, but transmitter ID not accepted
+                // (or last sync byte mismatch - see getMessage())
+                stats.idRejects++;
+                break;
+            default:
+                stats.other++;
+                break;
+            }
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    printf("frames:           %u\n", stats.frames);
+    printf("decoded:          %u\n", stats.ok);
+    printf("no sync:          %u\n", stats.noSync);
+    printf("digest failures:  %u\n", stats.digestErrors);
+    printf("ID rejects:       %u\n", stats.idRejects);
+    if (stats.other)
+        printf("other:            %u\n", stats.other);
+    printf("JSON bytes:       %zu (%.1f per frame)\n", stats.jsonBytes,
+           stats.ok ? (double)stats.jsonBytes / stats.ok : 0.0);
+    printf("time:             %.3f s\n", seconds);
+    printf("throughput:       %.0f frames/s\n", seconds > 0 ? stats.frames / seconds : 0.0);
+
+    return 0;
+}
@@ -0,0 +1,359 @@
+///////////////////////////////////////////////////////////////////////////////
+// gw_sim.cpp
+//
+// Host build - discrete-event simulation of the transmitter's wake cycle
+//
+// Models the sequence in gw_transmitter.ino / AppLayer::getPayloadStage2():
+//
+//   boot -> initGrowatt() -> startAcquire()/poll() (MODBUS_SETTLE_TIME, planned
+//   requests for the port 1 fields separated by the Modbus frame gap; on error
+//   MODBUS_RESPONSE_TIMEOUT and MODBUS_BACKOFF, up to MODBUS_RETRIES attempts)
+//   -> beginFSK() -> transmit() -> deep sleep (SLEEP_INTERVAL)
+//
+// The register cache is not modelled, i.e. all port 1 fields are read in each cycle.
+//
+// Each phase advances the simulation clock and accumulates time and charge
+// (current draw x duration). Modbus requests fail with the given probability
+// (no response -> ModbusMaster timeout). Results are scaled to one day.
+//
+// Usage: gw_sim [options]
+//   Sweep parameters (comma separated lists, all combinations are simulated):
+//   --sleep <s,...>        sleep interval [s] (default: 60)
+//   --payload <n,...>      payload size [bytes] (default: 23, PAYLOAD_FORMAT 2)
+//   --bitrate <kbps,...>   FSK bit rate [kbps] (default: 8.21)
+//   --fail <p,...>         Modbus request failure probability (default: 0)
+//   Model parameters:
+//   --days <n>             simulated time [days] (default: 7)
+//   --latency <ms>         inverter response latency (default: 50)
+//   --boot <ms>            boot time from deep sleep to setup() (default: 300)
+//   --radio-init <ms>      beginFSK() duration (default: 15)
+//   --i-active <mA>        current draw, CPU active, radio in standby (default: 40)
+//   --i-tx <mA>            current draw while transmitting (default: 70)
+//   --i-sleep <mA>         current draw in deep sleep (board dependent, default: 0.15)
+//   --seed <n>             random seed (default: 1)
+//   --phases               print time and charge per phase
+//
+// Duty cycle: 868.0..868.6 MHz (ETSI EN 300 220, g1) allows 1% airtime,
+// i.e. 36 s per hour; the maximum per clock hour is reported.
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <growatt_cfg.h>
+#include <growattInterface.h>
+#include <FrameCodec.h>
+
+/// Modbus interface select: 0 - USB / 1 - RS485
+bool modbusRS485 = true;
+
+namespace
+{
+    const double SecondsPerDay = 86400.0;
+    const double DutyCycleLimit = 0.01;    // 1%
+    const unsigned RadioPreambleBits = 32; // beginFSK(..., preambleLength)
+    const double BitsPerChar = 11.0;       // Modbus RTU: start, 8 data, parity/stop, stop
+
+    enum Phase
+    {
+        PHASE_BOOT,
+        PHASE_MODBUS_INIT,
+        PHASE_MODBUS_READ,
+        PHASE_MODBUS_TIMEOUT,
+        PHASE_MODBUS_BACKOFF,
+        PHASE_RADIO_INIT,
+        PHASE_TX,
+        PHASE_SLEEP,
+        NUM_PHASES
+    };
+
+    const char *const phaseNames[NUM_PHASES] = {
+        "boot", "modbus init", "modbus read", "modbus timeout", "modbus back-off", "radio init", "tx", "sleep"};
+
+    struct Params
+    {
+        double sleep_s = 60;
+        unsigned payload = 23;
+        double bitrate_kbps = 8.21;
+        double fail = 0;
+        double days = 7;
+        double latency_ms = 50;
+        double boot_ms = 300;
+        double radioInit_ms = 15;
+        double iActive_mA = 40;
+        double iTx_mA = 70;
+        double iSleep_mA = 0.15;
+        unsigned seed = 1;
+    };
+
+    struct Result
+    {
+        double time[NUM_PHASES] = {};   // [s]
+        double charge[NUM_PHASES] = {}; // [mAs]
+        double simulated = 0;           // [s]
+        double awake = 0;               // [s]
+        double airtime = 0;             // [s]
+        double maxHourAirtime = 0;      // [s]
+        double frameAirtime = 0;        // [s]
+        unsigned cycles = 0;
+        unsigned modbusErrors = 0;      // cycles without valid data
+        unsigned requests = 0;
+        unsigned timeouts = 0;
+    };
+
+    /*!
+     * \brief Wake cycle simulator
+     */
+    class WakeCycleSim
+    {
+    public:
+        explicit WakeCycleSim(const Params &p) : _p(p), _rng(p.seed) {}
+
+        Result run(void)
+        {
+            _r = Result();
+            _now = 0;
+            _hourAirtime.assign((size_t)(_p.days * 24) + 2, 0);
+            _r.frameAirtime = frameAirtime();
+            while (_now < _p.days * SecondsPerDay)
+            {
+                cycle();
+            }
+            _r.simulated = _now;
+            for (double a : _hourAirtime)
+            {
+                if (a > _r.maxHourAirtime)
+                    _r.maxHourAirtime = a;
+            }
+            return _r;
+        }
+
+    private:
+        const Params &_p;
+        std::mt19937 _rng;
+        std::uniform_real_distribution<double> _uniform{0.0, 1.0};
+        Result _r;
+        double _now = 0;
+        std::vector<double> _hourAirtime;
+        GrowattRange _plan[GW_MAX_RANGES];
+        uint8_t _planSize = growattIF::planRead(GROWATT_PORT1_FIELDS, false, _plan);
+
+        double frameAirtime(void) const
+        {
+            unsigned bits = RadioPreambleBits + 8 * (FrameCodec::PreambleSize + FrameCodec::HeaderSize + _p.payload);
+            return bits / (_p.bitrate_kbps * 1000.0);
+        }
+
+        void advance(Phase phase, double duration)
+        {
+            double current;
+            switch (phase)
+            {
+            case PHASE_TX:
+                current = _p.iTx_mA;
+                break;
+            case PHASE_SLEEP:
+                current = _p.iSleep_mA;
+                break;
+            default:
+                current = _p.iActive_mA;
+                break;
+            }
+            _r.time[phase] += duration;
+            _r.charge[phase] += duration * current;
+            if (phase != PHASE_SLEEP)
+                _r.awake += duration;
+            _now += duration;
+        }
+
+        // Modbus transaction of growattIF::poll()
+        bool transaction(const GrowattRange &range)
+        {
+            double charTime = BitsPerChar / MODBUS_RATE_RS485;
+            const unsigned reqSize = 8;
+            const unsigned respSize = 5 + 2 * range.count;
+
+            _r.requests++;
+            if (_uniform(_rng) < _p.fail)
+            {
+                _r.timeouts++;
+                advance(PHASE_MODBUS_TIMEOUT, reqSize * charTime + MODBUS_RESPONSE_TIMEOUT / 1000.0);
+                return false;
+            }
+            advance(PHASE_MODBUS_READ, (reqSize + respSize) * charTime + _p.latency_ms / 1000.0);
+            return true;
+        }
+
+        // gw_transmitter.ino: setup()
+        void cycle(void)
+        {
+            double frameGap = 3.5 * BitsPerChar / MODBUS_RATE_RS485;
+
+            _r.cycles++;
+            advance(PHASE_BOOT, _p.boot_ms / 1000.0);
+            advance(PHASE_MODBUS_INIT, MODBUS_SETTLE_TIME / 1000.0);
+
+            // AppLayer::getPayloadStage2()
+            int retries = MODBUS_RETRIES - 1;
+            bool ok = true;
+            for (uint8_t i = 0; ok && (i < _planSize); i++)
+            {
+                while (!transaction(_plan[i]))
+                {
+                    if (retries-- == 0)
+                    {
+                        ok = false;
+                        break;
+                    }
+                    advance(PHASE_MODBUS_BACKOFF, std::max(frameGap, MODBUS_BACKOFF / 1000.0));
+                }
+                if (ok && (i + 1 < _planSize))
+                    advance(PHASE_MODBUS_BACKOFF, frameGap);
+            }
+            if (!ok)
+                _r.modbusErrors++;
+
+            advance(PHASE_RADIO_INIT, _p.radioInit_ms / 1000.0);
+            size_t hour = (size_t)(_now / 3600.0);
+            if (hour < _hourAirtime.size())
+                _hourAirtime[hour] += _r.frameAirtime;
+            _r.airtime += _r.frameAirtime;
+            advance(PHASE_TX, _r.frameAirtime);
+
+            advance(PHASE_SLEEP, _p.sleep_s);
+        }
+    };
+
+    std::vector<double> parseList(const char *arg)
+    {
+        std::vector<double> values;
+        std::string s(arg);
+        size_t pos = 0;
+        while (pos <= s.size())
+        {
+            size_t end = s.find(',', pos);
+            if (end == std::string::npos)
+                end = s.size();
+            if (end > pos)
+                values.push_back(atof(s.substr(pos, end - pos).c_str()));
+            pos = end + 1;
+        }
+        return values;
+    }
+
+    void printPhases(const Result &r)
+    {
+        double scale = SecondsPerDay / r.simulated;
+        for (int i = 0; i < NUM_PHASES; i++)
+        {
+            printf("    %-16s %10.1f s/day %10.2f mAh/day\n", phaseNames[i], r.time[i] * scale,
+                   r.charge[i] * scale / 3600.0);
+        }
+    }
+
+    void usage(const char *prog)
+    {
+        fprintf(stderr,
+                "Usage: %s [--sleep <s,...>] [--payload <n,...>] [--bitrate <kbps,...>] [--fail <p,...>]\n"
+                "       [--days <n>] [--latency <ms>] [--boot <ms>] [--radio-init <ms>]\n"
+                "       [--i-active <mA>] [--i-tx <mA>] [--i-sleep <mA>] [--seed <n>] [--phases]\n",
+                prog);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Params p;
+    std::vector<double> sleeps = {p.sleep_s};
+    std::vector<double> payloads = {(double)p.payload};
+    std::vector<double> bitrates = {p.bitrate_kbps};
+    std::vector<double> fails = {p.fail};
+    bool phases = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasArg = i + 1 < argc;
+        if (!strcmp(argv[i], "--sleep") && hasArg)
+            sleeps = parseList(argv[++i]);
+        else if (!strcmp(argv[i], "--payload") && hasArg)
+            payloads = parseList(argv[++i]);
+        else if (!strcmp(argv[i], "--bitrate") && hasArg)
+            bitrates = parseList(argv[++i]);
+        else if (!strcmp(argv[i], "--fail") && hasArg)
+            fails = parseList(argv[++i]);
+        else if (!strcmp(argv[i], "--days") && hasArg)
+            p.days = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--latency") && hasArg)
+            p.latency_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--boot") && hasArg)
+            p.boot_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--radio-init") && hasArg)
+            p.radioInit_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--i-active") && hasArg)
+            p.iActive_mA = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--i-tx") && hasArg)
+            p.iTx_mA = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--i-sleep") && hasArg)
+            p.iSleep_mA = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && hasArg)
+            p.seed = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--phases"))
+            phases = true;
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (sleeps.empty() || payloads.empty() || bitrates.empty() || fails.empty() || p.days <= 0)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    printf("%7s %7s %7s %6s | %8s %9s %9s %10s %8s %9s %8s %9s %8s\n", "sleep", "payload", "kbps", "fail",
+           "cycles/d", "awake s/d", "awake ms", "airtime/d", "frame ms", "duty max", "I avg", "mAh/day", "no data");
+    for (double sleep : sleeps)
+    {
+        for (double payload : payloads)
+        {
+            for (double bitrate : bitrates)
+            {
+                for (double fail : fails)
+                {
+                    p.sleep_s = sleep;
+                    p.payload = (unsigned)payload;
+                    p.bitrate_kbps = bitrate;
+                    p.fail = fail;
+
+                    WakeCycleSim sim(p);
+                    Result r = sim.run();
+
+                    double scale = SecondsPerDay / r.simulated;
+                    double charge = 0;
+                    for (int i = 0; i < NUM_PHASES; i++)
+                        charge += r.charge[i];
+
+                    printf("%6.0fs %7u %7.2f %6.3f | %8.0f %9.0f %9.1f %9.2fs %8.1f %8.3f%% %6.3fmA %9.2f %7.2f%%\n",
+                           p.sleep_s, p.payload, p.bitrate_kbps, p.fail,
+                           r.cycles * scale, r.awake * scale, r.awake / r.cycles * 1000.0,
+                           r.airtime * scale, r.frameAirtime * 1000.0,
+                           r.maxHourAirtime / 3600.0 * 100.0, charge / r.simulated,
+                           charge * scale / 3600.0, 100.0 * r.modbusErrors / r.cycles);
+                    if (r.maxHourAirtime > DutyCycleLimit * 3600.0)
+                        printf("    warning: duty cycle limit (%.0f%%) exceeded\n", DutyCycleLimit * 100.0);
+                    if (phases)
+                        printPhases(r);
+                }
+            }
+        }
+    }
+    return 0;
+}
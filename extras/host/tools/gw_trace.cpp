@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////
+// gw_trace.cpp
+//
+// Host build - trace ring buffer decoder
+//
+// Converts trace records (see src/utils/trace.h) to text. Input is either
+// the output of trace_dump() ("TRACE: XX XX ..." lines, e.g. a captured
+// serial log) or a binary file of raw records (e.g. an RTC memory dump).
+//
+// Usage: gw_trace [--bin] [file] (default: stdin)
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <utils/trace.h>
+#include "host.h"
+
+namespace
+{
+    struct Decoder
+    {
+        uint32_t lastTime = 0;
+        bool first = true;
+        uint8_t id = TRACE_NONE;
+        uint32_t time = 0;
+        std::vector<uint8_t> data;
+
+        static uint32_t le32(const uint8_t *p)
+        {
+            return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+        }
+
+        static int16_t le16(const uint8_t *p)
+        {
+            return static_cast<int16_t>(p[0] | (p[1] << 8));
+        }
+
+        void print(void)
+        {
+            const uint8_t *d = data.data();
+            size_t n = data.size();
+
+            if (id == TRACE_WAKE)
+            {
+                printf("--- wake %u ---\n", (n >= 4) ? le32(d) : 0);
+                first = true;
+            }
+            uint32_t delta = first ? 0 : time - lastTime;
+            first = false;
+            lastTime = time;
+
+            printf("%10u us %+9d us  %-12s", time, (int)delta, trace_event_name(id));
+            switch (id)
+            {
+            case TRACE_MODBUS_READ:
+                if (n >= 2)
+                    printf(" result=0x%02X retry=%u", d[0], d[1]);
+                break;
+            case TRACE_PAYLOAD:
+                if (n >= 2)
+                    printf(" port=%u size=%u", d[0], d[1]);
+                break;
+            case TRACE_RADIO_INIT:
+            case TRACE_TX_DONE:
+                if (n >= 2)
+                    printf(" state=%d", le16(d));
+                break;
+            case TRACE_DECODE:
+                if (n >= 1)
+                    printf(" status=%u", d[0]);
+                break;
+            case TRACE_SLEEP:
+                if (n >= 4)
+                    printf(" %u s", le32(d));
+                break;
+            case TRACE_WAKE:
+                break;
+            default:
+                for (size_t i = 0; i < n; i++)
+                    printf(" %02X", d[i]);
+                break;
+            }
+            printf("\n");
+        }
+
+        /// Add raw record; prints event when complete
+        void add(const uint8_t *rec)
+        {
+            uint8_t info = rec[5];
+            uint8_t size = info & TraceRecord::SizeMask;
+            if (size > TraceRecord::DataSize)
+                size = TraceRecord::DataSize;
+
+            // Continuation of the previous record?
+            if (data.empty() || rec[4] != id)
+            {
+                id = rec[4];
+                time = le32(rec);
+                data.clear();
+            }
+            data.insert(data.end(), &rec[6], &rec[6] + size);
+
+            if (!(info & TraceRecord::More))
+            {
+                print();
+                data.clear();
+            }
+        }
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    bool binary = false;
+    const char *path = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--bin"))
+            binary = true;
+        else if (argv[i][0] != '-')
+            path = argv[i];
+        else
+        {
+            fprintf(stderr, "Usage: %s [--bin] [file]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    FILE *in = path ? fopen(path, binary ? "rb" : "r") : stdin;
+    if (!in)
+    {
+        perror(path);
+        return 1;
+    }
+
+    Decoder decoder;
+    unsigned records = 0;
+    if (binary)
+    {
+        uint8_t rec[sizeof(TraceRecord)];
+        while (fread(rec, 1, sizeof(rec), in) == sizeof(rec))
+        {
+            if (rec[4] == TRACE_NONE)
+                continue; // unused slot
+            decoder.add(rec);
+            records++;
+        }
+    }
+    else
+    {
+        char line[1024];
+        std::vector<uint8_t> rec;
+        while (fgets(line, sizeof(line), in))
+        {
+            if (host::parseHexLine(line, "TRACE:", rec) && rec.size() == sizeof(TraceRecord))
+            {
+                decoder.add(rec.data());
+                records++;
+            }
+        }
+    }
+
+    fprintf(stderr, "%u records\n", records);
+    return 0;
+}
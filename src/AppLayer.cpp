@@ -36,6 +36,21 @@
 // 20240316 Implemented genPayload()
 // 20250710 Added inverter temperature to port 1 payload
 //          Added dummy data in case of modbus error
+// 20261017 Added trace points
+//          Added phase timing and getTimingPayload()
+//          Added getDiagPayload()
+//          Read only the input registers encoded for the selected port
+//          Replaced blocking Modbus read loop by non-blocking acquisition
+//          Wait for Modbus response via growattIF::wait()
+//          Added multiple inverters on the RS485 bus (GROWATT_SLAVE_IDS)
+//          Added getFamilyPayload() (GROWATT_FAMILY)
+//          Added settings snapshot refresh and getConfigPayload()
+//          Encode only the result if the inverter is unreachable (circuit breaker open)
+//          Added port 1 payload format v2 with scaled integers (PAYLOAD_FORMAT)
+//          Added port 1 payload format v3 with deltas to a keyframe in RTC memory
+//          Family specific payload starts with the family (GROWATT_FAMILY)
+//          Port 1 values clamped to the widths of their encoding
+//          Port 1 payload format v3: deltas only to keyframes acknowledged by the receiver
 //
 //
 // ToDo:
@@ -46,19 +61,157 @@
 #include "AppLayer.h"
 #include "growattInterface.h"
 #include "growatt_cfg.h"
+#include "utils/trace.h"
+#include "utils/timing.h"
+#include "utils/diag.h"
+#include "FrameCodec.h"
+#include "PayloadCodec.h"
 
 growattIF growattInterface(MAX485_RE_NEG, MAX485_DE, MAX485_RX, MAX485_TX);
+
+// Modbus slave IDs of the inverters on the RS485 bus
+static const uint8_t slaveIds[] = GROWATT_SLAVE_IDS;
+static_assert(sizeof(slaveIds) <= GROWATT_MAX_INVERTERS, "GROWATT_SLAVE_IDS exceeds GROWATT_MAX_INVERTERS");
+static_assert(GROWATT_MAX_INVERTERS <= FrameCodec::MaxIndex + 1, "GROWATT_MAX_INVERTERS exceeds FrameCodec::MaxIndex");
 //bool holdingregisters = false;
 
+#if PAYLOAD_FORMAT == 3
+// Reference values of the delta encoding per inverter; kept in RTC memory across deep sleep
+struct KeyFrame
+{
+    uint8_t valid; // 0 after power-on
+    uint8_t seq;   // sequence number of the next data frame
+    uint8_t key;   // sequence number of the keyframe
+    uint8_t age;   // data frames since the keyframe
+    uint8_t ack;   // keyframe acknowledged by the receiver
+    int32_t raw[PayloadCodec::NumValues];
+};
+RTC_DATA_ATTR static KeyFrame keyFrames[GROWATT_MAX_INVERTERS];
+#endif
+
+/*!
+ * \brief Encode port 1 values as scaled integers (payload formats 2 and 3, see AppLayer::getPayloadStage2())
+ *
+ * \param encoder uplink encoder object
+ * \param data input register values
+ * \param inverter inverter index
+ */
+static void encodeData(LoraEncoder &encoder, const growattIF::modbus_input_registers &data, uint8_t inverter)
+{
+    uint8_t buf[PayloadCodec::MaxDeltaSize];
+    uint8_t size;
+    int32_t raw[PayloadCodec::NumValues] = {
+        data.status,
+        data.faultcode,
+        PayloadCodec::toRaw(PayloadCodec::EnergyToday, data.energytoday),
+        PayloadCodec::toRaw(PayloadCodec::EnergyTotal, data.energytotal),
+        PayloadCodec::toRaw(PayloadCodec::TotalWorkTime, data.totalworktime),
+        PayloadCodec::toRaw(PayloadCodec::OutputPower, data.outputpower),
+        PayloadCodec::toRaw(PayloadCodec::GridVoltage, data.gridvoltage),
+        PayloadCodec::toRaw(PayloadCodec::GridFrequency, data.gridfrequency),
+        PayloadCodec::toRaw(PayloadCodec::TempInverter, data.tempinverter)};
+
+    // Out of range values would differ after readAbsolute() at the receiver
+    // (and in the keyframe's reference values)
+    PayloadCodec::clamp(raw);
+
+#if PAYLOAD_FORMAT == 3
+    KeyFrame &key = keyFrames[inverter];
+    size = PayloadCodec::writeDelta(buf, raw, key.raw);
+    if (key.valid && key.ack && (key.age + 1 < PAYLOAD_KEYFRAME_INTERVAL) && (size < PayloadCodec::AbsoluteSize))
+    {
+        encoder.writeUint8(FrameCodec::FormatDelta);
+        encoder.writeUint8(key.seq);
+        encoder.writeUint8(key.key);
+        encoder.writeUint8(size);
+        key.age++;
+    }
+    else
+    {
+        encoder.writeUint8(FrameCodec::FormatKey);
+        encoder.writeUint8(key.seq);
+        size = PayloadCodec::writeAbsolute(buf, raw);
+        memcpy(key.raw, raw, sizeof(raw));
+        key.valid = 1;
+        key.ack = 0;
+        key.key = key.seq;
+        key.age = 0;
+    }
+    log_d("Data frame %u: %s, %u bytes", key.seq, key.age ? "delta" : "keyframe", size);
+    key.seq++;
+#else
+    (void)inverter; // suppress warning regarding unused parameter
+    encoder.writeUint8(FrameCodec::FormatV2);
+    encoder.writeUint8(growattIF::Success);
+    size = PayloadCodec::writeAbsolute(buf, raw);
+#endif
+    for (uint8_t i = 0; i < size; i++)
+    {
+        encoder.writeUint8(buf[i]);
+    }
+}
+
+uint8_t AppLayer::getInverterCount(void)
+{
+    return sizeof(slaveIds);
+}
+
 uint8_t
 AppLayer::decodeDownlink(uint8_t port, uint8_t *payload, size_t size)
 {
+#if PAYLOAD_FORMAT == 3
+    if (port == FrameCodec::PortAck)
+    {
+        for (size_t i = 0; i + 1 < size; i += 2)
+        {
+            uint8_t inverter = payload[i];
+            if ((inverter < GROWATT_MAX_INVERTERS) && keyFrames[inverter].valid &&
+                (keyFrames[inverter].key == payload[i + 1]))
+            {
+                log_d("Keyframe %u of inverter %u acknowledged", payload[i + 1], inverter);
+                keyFrames[inverter].ack = 1;
+            }
+        }
+    }
+#else
+    (void)port;    // suppress warning regarding unused parameter
+    (void)payload; // suppress warning regarding unused parameter
+    (void)size;    // suppress warning regarding unused parameter
+#endif
     return 0;
 }
 
+bool AppLayer::ackPending(void)
+{
+#if PAYLOAD_FORMAT == 3
+    for (uint8_t i = 0; i < getInverterCount(); i++)
+    {
+        if (keyFrames[i].valid && !keyFrames[i].ack)
+        {
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
 void AppLayer::genPayload(uint8_t port, LoraEncoder &encoder)
 {
 #if defined(EMULATE_SENSORS)
+#if PAYLOAD_FORMAT >= 2
+    if (port == 1) {
+        growattIF::modbus_input_registers data = {};
+        data.energytoday = 4.4;
+        data.energytotal = 5555.5;
+        data.totalworktime = 12345678;
+        data.outputpower = 600.0;
+        data.gridvoltage = 230.0;
+        data.gridfrequency = 50.0;
+        data.tempinverter = -1.1;
+        encodeData(encoder, data, 0);
+        return;
+    }
+#endif
     // modbus
     encoder.writeUint8(0);
     if (port == 1) {
@@ -105,49 +258,91 @@ void AppLayer::getPayloadStage1(uint8_t port, LoraEncoder &encoder)
     (void)encoder; // suppress warning regarding unused parameter
 }
 
-void AppLayer::getPayloadStage2(uint8_t port, LoraEncoder &encoder)
-{
-    uint8_t result;
+// Modbus transaction statistics (see growattIF::onTransaction())
+static uint8_t modbusFailures;
 
-    growattInterface.initGrowatt();
-    delay(500);
-    /*
-    if (!holdingregisters) {
-      // Read the holding registers
-      ReadHoldingRegisters();
-    } else {
-      // Read the input registers
-      ReadInputRegisters();
+static void modbusTransaction(uint8_t result, uint32_t duration)
+{
+    timing_add(TIMING_MODBUS_READ, duration);
+    TRACE_BYTES(TRACE_MODBUS_READ, result, modbusFailures);
+    if (result != growattInterface.Success)
+    {
+        modbusFailures++;
+        timing_retry();
+        String message = growattInterface.sendModbusError(result);
+        log_e("Error: %s", message.c_str());
+    }
+    else
+    {
+        log_d("Modbus transaction: %u ms", (unsigned)duration);
     }
-    */
+}
+
+// Result of the last input register acquisition (see getFamilyPayload())
+static uint8_t inputResult;
 
-    int retries = 0;
-    do
+// Acquire the stale fields of a field set, returns the result
+static uint8_t acquire(uint32_t fields, bool holding)
+{
+    growattInterface.startAcquire(fields, MODBUS_RETRIES - 1, holding);
+    while (!growattInterface.isDone())
     {
-        result = growattInterface.ReadInputRegisters(NULL);
-        log_d("ReadInputRegisters: 0x%02x", result);
-        if ((result != growattInterface.Continue) && (result != growattInterface.Success))
+        // Waiting for the inverter - yields to other tasks (or allows light sleep)
+        uint32_t wait = growattInterface.poll();
+        if (wait)
         {
-            String message = growattInterface.sendModbusError(result);
-            log_e("Error: %s", message.c_str());
+            growattInterface.wait(wait);
         }
-        while (result == growattInterface.Continue)
+    }
+    return growattInterface.acquireResult();
+}
+
+void AppLayer::getPayloadStage2(uint8_t port, LoraEncoder &encoder, uint8_t inverter)
+{
+    uint8_t result;
+    uint32_t start = millis();
+
+    growattInterface.selectSlave(inverter, slaveIds[inverter]);
+    if (inverter == 0)
+    {
+        // The interface is initialized once for all inverters on the bus
+        growattInterface.initGrowatt();
+        TRACE(TRACE_MODBUS_INIT);
+        timing_add(TIMING_MODBUS_INIT, millis() - start);
+    }
+
+    // Input register fields encoded for this port and by getFamilyPayload()
+    uint32_t fields = ((port == 1) ? GROWATT_PORT1_FIELDS : GROWATT_PORT2_FIELDS) | GROWATT_FAMILY_FIELDS;
+
+    modbusFailures = 0;
+    growattInterface.onTransaction(modbusTransaction);
+    result = acquire(fields, false);
+    log_d("Modbus acquisition (slave %u): 0x%02x", slaveIds[inverter], result);
+    inputResult = result;
+
+    // Settings snapshot - only read at power-on, after GROWATT_TTL_STATIC cycles
+    // or if the fault code/derating mode has changed (otherwise no Modbus traffic)
+    if (result == growattInterface.Success)
+    {
+        uint8_t settingsResult = acquire(GROWATT_SETTINGS_FIELDS, true);
+        if (settingsResult != growattInterface.Success)
         {
-            delay(1000);
-            result = growattInterface.ReadInputRegisters(NULL);
-            String message = growattInterface.sendModbusError(result);
-            if (result != growattInterface.Continue && (result != growattInterface.Success))
-            {
-                log_e("Error: %s", message.c_str());
-                delay(1000);
-            }
-            else
-            {
-                log_d("%s", message.c_str());
-            }
+            log_e("Reading settings failed: 0x%02x", settingsResult);
         }
-    } while ((result != growattInterface.Success) && (++retries < MODBUS_RETRIES));
+    }
+    timing_add(TIMING_MODBUS, millis() - start);
 
+    // Payload formats 2 and 3: port 1 only; an error result is sent in format 2
+    bool scaled = (PAYLOAD_FORMAT >= 2) && (port == 1);
+    if (scaled && (result == growattInterface.Success))
+    {
+        encodeData(encoder, growattInterface.modbusdata, inverter);
+        return;
+    }
+    if (scaled)
+    {
+        encoder.writeUint8(FrameCodec::FormatV2);
+    }
     encoder.writeUint8(result);
     if (result == growattInterface.Success)
     {
@@ -175,6 +370,16 @@ void AppLayer::getPayloadStage2(uint8_t port, LoraEncoder &encoder)
             encoder.writeRawFloat(growattInterface.modbusdata.pv1energytotal);
         }
     }
+    else if (growattInterface.breakerOpen())
+    {
+        // Inverter unreachable (e.g. at night) - result only
+        log_d("Inverter unreachable (slave %u)", slaveIds[inverter]);
+    }
+    else if (scaled)
+    {
+        // The receiver does not expect any values following an error result
+        log_e("Error reading data");
+    }
     else
     {
         // If there was an error, write 0 for all values
@@ -204,9 +409,99 @@ void AppLayer::getPayloadStage2(uint8_t port, LoraEncoder &encoder)
     }
 }
 
-void AppLayer::getConfigPayload(uint8_t cmd, uint8_t &port, LoraEncoder &encoder)
+void AppLayer::getFamilyPayload(uint8_t port, LoraEncoder &encoder)
 {
-    (void)cmd;     // suppress warning regarding unused parameter
-    (void)port;    // suppress warning regarding unused parameter
+    (void)port; // suppress warning regarding unused parameter
+
+#if GROWATT_FAMILY == GW_FAMILY_MIC
     (void)encoder; // suppress warning regarding unused parameter
+#else
+    uint8_t result = inputResult;
+    const growattIF::modbus_input_registers &data = growattInterface.modbusdata;
+    bool valid = (result == growattInterface.Success);
+    if (!valid && growattInterface.breakerOpen())
+    {
+        // Inverter unreachable - no family specific frame
+        return;
+    }
+
+    // The receiver selects the decoder by the family byte
+    encoder.writeUint8(GROWATT_FAMILY);
+
+    // If there was an error, write 0 for all values
+    encoder.writeUint8(result);
+#if GROWATT_FAMILY == GW_FAMILY_MOD
+    encoder.writeUint16(valid ? (uint16_t)(data.gridvoltage2 * 10 + 0.5) : 0);
+    encoder.writeUint16(valid ? (uint16_t)(data.gridvoltage3 * 10 + 0.5) : 0);
+#elif GROWATT_FAMILY == GW_FAMILY_SPH
+    encoder.writeRawFloat(valid ? data.dischargepower : 0.0);
+    encoder.writeRawFloat(valid ? data.chargepower : 0.0);
+    encoder.writeUint16(valid ? (uint16_t)(data.batteryvoltage * 10 + 0.5) : 0);
+    encoder.writeUint8(valid ? (uint8_t)data.soc : 0);
+#endif
+#endif
+}
+
+void AppLayer::getTimingPayload(uint8_t port, LoraEncoder &encoder)
+{
+    (void)port; // suppress warning regarding unused parameter
+
+    encoder.writeUint8(min(timing_cycles(), (uint16_t)UINT8_MAX));
+    encoder.writeUint8(min(timing_retries(), (uint16_t)UINT8_MAX));
+    for (int i = 0; i < TIMING_NUM_PHASES; i++)
+    {
+        const TimingStat &s = timing_stat(static_cast<TimingPhase>(i));
+        uint32_t avg = s.count ? s.sum / s.count : 0;
+        encoder.writeUint16(min(avg, (uint32_t)UINT16_MAX));
+        encoder.writeUint16(s.max);
+    }
+}
+
+void AppLayer::getDiagPayload(uint8_t port, LoraEncoder &encoder)
+{
+    (void)port; // suppress warning regarding unused parameter
+
+    const DiagRecord &rec = diag_record();
+    encoder.writeUint8(rec.cycles);
+    encoder.writeUint8(rec.minPoint);
+    encoder.writeUint32(rec.freeHeap);
+    encoder.writeUint32(rec.minFreeHeap);
+    encoder.writeUint32(rec.minMaxAlloc);
+    encoder.writeUint32(rec.minStackFree);
+    encoder.writeUint32(rec.staticRam);
+}
+
+void AppLayer::getConfigPayload(uint8_t cmd, uint8_t &port, LoraEncoder &encoder)
+{
+    port = FrameCodec::PortConfig;
+    if ((cmd != CMD_GET_SETTINGS) && (cmd != CMD_GET_SETTINGS_CHANGED))
+    {
+        return;
+    }
+    bool changed = growattInterface.settingsChanged();
+    if ((cmd == CMD_GET_SETTINGS_CHANGED) && !changed)
+    {
+        return;
+    }
+    if (!growattInterface.loadSettings())
+    {
+        log_d("No settings snapshot");
+        return;
+    }
+
+    const growattIF::modbus_holding_registers &settings = growattInterface.modbussettings;
+    for (size_t i = 0; i < sizeof(settings.serial); i++)
+    {
+        encoder.writeUint8(settings.serial[i]);
+    }
+    for (size_t i = 0; i < sizeof(settings.firmware); i++)
+    {
+        encoder.writeUint8(settings.firmware[i]);
+    }
+    for (size_t i = 0; i < sizeof(settings.controlfirmware); i++)
+    {
+        encoder.writeUint8(settings.controlfirmware[i]);
+    }
+    encoder.writeRawFloat(settings.maxpower);
+    encoder.writeUint16((uint16_t)(settings.voltnormal * 10 + 0.5));
 }
@@ -33,6 +33,15 @@
 //
 // 20240513 Created
 // 20240607 Added getAppStatusUplinkInterval() for compatibility
+// 20261017 Added getTimingPayload() and getDiagPayload()
+//          Added getInverterCount() and inverter parameter of getPayloadStage2()
+//          Added getFamilyPayload()
+//          Implemented getConfigPayload() (inverter settings snapshot)
+//          Result only if the inverter is unreachable
+//          Port 1 payload format v2 (PAYLOAD_FORMAT)
+//          Port 1 payload format v3 (keyframe and deltas)
+//          Family byte in getFamilyPayload()
+//          Keyframe acknowledgement by decodeDownlink(), added ackPending()
 //
 // ToDo:
 // -
@@ -44,6 +53,9 @@
 
 #include <LoraMessage.h> // see https://github.com/thesolarnomad/lora-serialization
 
+// Configuration uplink requests (see getConfigPayload())
+#define CMD_GET_SETTINGS         0x20 // inverter settings snapshot
+#define CMD_GET_SETTINGS_CHANGED 0x21 // inverter settings snapshot, only if it has changed
 
 /*!
  * \brief LoRaWAN node application layer
@@ -79,9 +91,20 @@ public:
         return 0;
     };
 
+    /*!
+     * \brief Get number of inverters on the RS485 bus
+     *
+     * \returns number of entries in GROWATT_SLAVE_IDS
+     */
+    uint8_t getInverterCount(void);
+
     /*!
      * \brief Decode app layer specific downlink messages
      *
+     * FrameCodec::PortAck (payload format 3) - keyframes acknowledged by the receiver:
+     *
+     * [uint8_t inverter index][uint8_t keyframe seq] per keyframe
+     *
      * \param port downlink message port
      * \param payload downlink message payload
      * \param size payload size in bytes
@@ -90,6 +113,13 @@ public:
      */
     uint8_t decodeDownlink(uint8_t port, uint8_t *payload, size_t size);
 
+    /*!
+     * \brief Check if a keyframe awaits the receiver's acknowledgement
+     *
+     * \returns true if a keyframe (payload format 3) has not been acknowledged
+     */
+    bool ackPending(void);
+
     /*!
      * \brief Generate payload (by emulation)
      *
@@ -120,10 +150,83 @@ public:
      * - The sensor preparation has been started in stage1
      * - The data aquistion has to be done immediately before uplink
      *
+     * The Modbus interface is initialized with inverter 0, the following
+     * inverters are read back-to-back. Stale settings (GROWATT_SETTINGS_FIELDS)
+     * are read after the input registers.
+     *
+     * If the inverter is unreachable (circuit breaker open, see
+     * growattIF::breakerOpen()), the payload only contains the result.
+     *
+     * With PAYLOAD_FORMAT 2, the port 1 payload is led by FrameCodec::FormatV2
+     * and contains the values as scaled integers with the resolution of their
+     * registers (23 instead of 29 bytes); after an error, only the result is sent:
+     *
+     * [uint8_t 0xA2][uint8_t result][uint8_t status][uint8_t faultcode]
+     * [uint16_t energytoday [0.1 kWh]][uint32_t energytotal [0.1 kWh]]
+     * [uint32_t totalworktime [0.5 s]][int24_t outputpower [0.1 W]]
+     * [uint16_t gridvoltage [0.1 V]][uint16_t gridfrequency [0.01 Hz]]
+     * [int16_t tempinverter [0.1 °C]]
+     *
+     * With PAYLOAD_FORMAT 3, every PAYLOAD_KEYFRAME_INTERVAL'th frame is a
+     * keyframe with the absolute values; the frames in between contain the
+     * differences to the keyframe (see PayloadCodec.h), which is kept in RTC
+     * memory. Deltas only refer to a keyframe acknowledged by the receiver
+     * (see decodeDownlink()). The error result is sent in format 2.
+     *
+     * [uint8_t 0xA3][uint8_t seq][values as in format 2]
+     * [uint8_t 0xA4][uint8_t seq][uint8_t keyframe seq][uint8_t length][delta encoding]
+     *
      * \param port LoRaWAN port
      * \param encoder uplink encoder object
+     * \param inverter inverter index (0...getInverterCount()-1)
      */
-    void getPayloadStage2(uint8_t port, LoraEncoder &encoder);
+    void getPayloadStage2(uint8_t port, LoraEncoder &encoder, uint8_t inverter = 0);
+
+    /*!
+     * \brief Get family specific payload
+     *
+     * Encodes the GROWATT_FAMILY_FIELDS acquired by the preceding call of
+     * getPayloadStage2(); empty with GW_FAMILY_MIC or if the inverter is
+     * unreachable. The family byte (GW_FAMILY_MOD/GW_FAMILY_SPH) selects
+     * the receiver's decoder. All values little endian:
+     *
+     * [uint8_t family][uint8_t result]
+     * GW_FAMILY_MOD: [uint16_t gridvoltage2 [0.1 V]][uint16_t gridvoltage3 [0.1 V]]
+     * GW_FAMILY_SPH: [float dischargepower][float chargepower]
+     *                [uint16_t batteryvoltage [0.1 V]][uint8_t soc [%]]
+     *
+     * \param port uplink port (FrameCodec::PortFamily)
+     * \param encoder uplink encoder object
+     */
+    void getFamilyPayload(uint8_t port, LoraEncoder &encoder);
+
+    /*!
+     * \brief Get timing telemetry payload
+     *
+     * Summary of the wake cycles since the last report (see utils/timing.h),
+     * all values little endian:
+     *
+     * [uint8_t cycles][uint8_t retries]
+     * TIMING_NUM_PHASES x [uint16_t avg. duration [ms]][uint16_t max. duration [ms]]
+     *
+     * \param port uplink port (FrameCodec::PortTiming)
+     * \param encoder uplink encoder object
+     */
+    void getTimingPayload(uint8_t port, LoraEncoder &encoder);
+
+    /*!
+     * \brief Get heap/stack diagnostics payload
+     *
+     * Record of the wake cycles since the last report (see utils/diag.h),
+     * all values little endian:
+     *
+     * [uint8_t cycles][uint8_t minPoint][uint32_t freeHeap][uint32_t minFreeHeap]
+     * [uint32_t minMaxAlloc][uint32_t minStackFree][uint32_t staticRam]
+     *
+     * \param port uplink port (FrameCodec::PortDiag)
+     * \param encoder uplink encoder object
+     */
+    void getDiagPayload(uint8_t port, LoraEncoder &encoder);
 
     /*!
      * Get configuration data for uplink
@@ -131,8 +234,16 @@ public:
      * Get the configuration data requested in a downlink command and
      * prepare it as payload in a uplink response.
      *
+     * CMD_GET_SETTINGS/CMD_GET_SETTINGS_CHANGED: settings snapshot of the inverter
+     * selected by the preceding call of getPayloadStage2(), without Modbus traffic;
+     * empty if no snapshot is available (or it has not changed).
+     * All values little endian:
+     *
+     * [char serial[10]][char firmware[6]][char controlfirmware[6]]
+     * [float maxpower][uint16_t voltnormal [0.1 V]]
+     *
      * \param cmd command
-     * \param port uplink port
+     * \param port uplink port (FrameCodec::PortConfig)
      * \param encoder uplink data encoder object
      */
     void getConfigPayload(uint8_t cmd, uint8_t &port, LoraEncoder &encoder);
@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+// ExportLimiter.cpp
+//
+// Closed-loop grid export limitation via the inverter's active power limit
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ExportLimiter.h"
+
+uint8_t ExportLimiter::computeLimit(float exportW, float outputW, float targetW, float maxPower)
+{
+    float allowed = outputW - exportW + targetW;
+
+    if (allowed <= 0)
+        return 0;
+    if (allowed >= maxPower)
+        return 100;
+
+    // Round down - the export must not exceed the target
+    return (uint8_t)(allowed * 100 / maxPower);
+}
+
+float ExportLimiter::nominalPower()
+{
+    if (EXPORT_LIMIT_MAXPOWER > 0)
+        return EXPORT_LIMIT_MAXPOWER;
+
+    if ((inverter.modbussettings.maxpower <= 0) && !inverter.loadSettings())
+        return 0;
+
+    return inverter.modbussettings.maxpower;
+}
+
+uint8_t ExportLimiter::update(float exportW, float outputW)
+{
+    uint32_t start = millis();
+
+    if (!inverter.isDone() || inverter.breakerOpen())
+        return growattIF::Continue;
+
+    float maxPower = nominalPower();
+    if (maxPower <= 0)
+    {
+        log_e("Nominal power unknown");
+        return NoRating;
+    }
+
+    uint8_t pct = computeLimit(exportW, outputW, target, maxPower);
+
+    if (currentLimit != 0xFF)
+    {
+        uint8_t step = (pct > currentLimit) ? (pct - currentLimit) : (currentLimit - pct);
+
+        // Export above target is corrected regardless of the hysteresis
+        bool exceeded = (exportW > target) && (pct < currentLimit);
+        if ((pct == currentLimit) || ((step <= EXPORT_LIMIT_HYSTERESIS) && !exceeded))
+            return growattIF::Success;
+    }
+
+    uint8_t result = inverter.writeRegister(growattIF::regMaxOutputActive, pct);
+    if (result != growattIF::Success)
+    {
+        log_e("Writing power limit %u%% failed (0x%02X)", pct, result);
+        return result;
+    }
+
+    uint16_t value;
+    result = inverter.readRegister(growattIF::regMaxOutputActive, value);
+    if (result != growattIF::Success)
+    {
+        log_e("Reading back power limit failed (0x%02X)", result);
+        return result;
+    }
+    if (value != pct)
+    {
+        log_e("Power limit %u%% written, %u%% read back", pct, value);
+        currentLimit = 0xFF;
+        return Mismatch;
+    }
+
+    currentLimit = pct;
+    inverter.modbussettings.maxoutputactivepp = pct;
+    lastLatency = millis() - start;
+    if (lastLatency > peakLatency)
+        peakLatency = lastLatency;
+    writeCount++;
+    log_d("Power limit: %u%% (%lu ms)", pct, (unsigned long)lastLatency);
+
+    return growattIF::Success;
+}
@@ -0,0 +1,153 @@
+///////////////////////////////////////////////////////////////////////////////
+// ExportLimiter.h
+//
+// Closed-loop grid export limitation via the inverter's active power limit
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_EXPORTLIMITER_H)
+#define _EXPORTLIMITER_H
+
+#include <Arduino.h>
+#include "growattInterface.h"
+
+/*!
+ * \brief Closed-loop grid export limiter (e.g. zero export)
+ *
+ * Computes the inverter's active power limit (holding register
+ * maxoutputactivepp, growattIF::regMaxOutputActive) [% of the nominal power]
+ * from the inverter's output power and the power exported to the grid:
+ *
+ *   load  = output power - export
+ *   limit = (load + target) / nominal power * 100 %
+ *
+ * The export is measured at the grid connection point (e.g. by a smart meter)
+ * and supplied by the caller. The limit is written only if it differs from
+ * the current limit by more than EXPORT_LIMIT_HYSTERESIS percent - or if the
+ * export exceeds the target, which is corrected immediately. Each write is
+ * confirmed by reading the register back.
+ *
+ * The nominal power is EXPORT_LIMIT_MAXPOWER or, if 0, taken from the
+ * inverter's settings snapshot (growattIF::loadSettings()).
+ *
+ * The limiter uses blocking Modbus requests and must not be called while a
+ * non-blocking acquisition (growattIF::startAcquire()) is in progress.
+ */
+class ExportLimiter
+{
+public:
+    /*!
+     * \brief Constructor
+     *
+     * \param inverter  Modbus interface of the inverter (selected slave)
+     */
+    ExportLimiter(growattIF &inverter) : inverter(inverter) {};
+
+    // Result codes (in addition to growattIF::Success/Continue and Modbus errors)
+    static const uint8_t NoRating = 0x10; //!< nominal power unknown
+    static const uint8_t Mismatch = 0x11; //!< read-back value differs from written value
+
+    /*!
+     * \brief Set the max. power exported to the grid
+     *
+     * \param exportW  target export [W] (0: zero export)
+     */
+    void setTarget(float exportW)
+    {
+        target = exportW;
+    }
+
+    /*!
+     * \brief Update the power limit from the latest readings
+     *
+     * \param exportW  power exported to the grid [W] (negative: import)
+     * \param outputW  inverter output power [W] (growattIF::modbusdata.outputpower)
+     *
+     * \returns growattIF::Success if the limit is unchanged or has been written
+     *          and confirmed, growattIF::Continue if an acquisition is in progress
+     *          or the inverter is unreachable, NoRating, Mismatch or Modbus error code
+     */
+    uint8_t update(float exportW, float outputW);
+
+    /// Get the current power limit [%] (0xFF: unknown)
+    uint8_t limit() const
+    {
+        return currentLimit;
+    }
+
+    /// Get the latency of the last confirmed write (update() to read-back) [ms]
+    uint32_t latency() const
+    {
+        return lastLatency;
+    }
+
+    /// Get the max. latency of all confirmed writes [ms]
+    uint32_t maxLatency() const
+    {
+        return peakLatency;
+    }
+
+    /// Get no. of confirmed writes
+    uint16_t writes() const
+    {
+        return writeCount;
+    }
+
+    /*!
+     * \brief Compute the power limit
+     *
+     * \param exportW   power exported to the grid [W]
+     * \param outputW   inverter output power [W]
+     * \param targetW   target export [W]
+     * \param maxPower  nominal power [W]
+     *
+     * \returns power limit [%] (0...100)
+     */
+    static uint8_t computeLimit(float exportW, float outputW, float targetW, float maxPower);
+
+private:
+    growattIF &inverter;
+    float target = EXPORT_LIMIT_TARGET;
+    uint8_t currentLimit = 0xFF;
+    uint32_t lastLatency = 0;
+    uint32_t peakLatency = 0;
+    uint16_t writeCount = 0;
+
+    float nominalPower();
+};
+
+#endif // _EXPORTLIMITER_H
@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////
+// FrameCodec.cpp
+//
+// Radio frame codec - preamble, digest, transmitter ID and whitening
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created from gw_transmitter.ino / gw_receiver.ino
+//          Added port in header byte 2 and zero padding to PayloadSize
+//          Replaced zero padding by payload length in header byte 2
+//          decode() accepts frames without payload length (6-byte header),
+//          distinguished by the final xor of the digest
+//          encode() rejects payloads exceeding PayloadSize
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameCodec.h"
+
+uint8_t FrameCodec::begin(uint8_t *msg)
+{
+    const uint8_t preamble[] = {0xAA, 0xAA, 0xAA, 0xAA};
+    const uint8_t syncword[] = {0x2D, 0xD4};
+
+    memcpy(msg, preamble, sizeof(preamble));
+    memcpy(&msg[sizeof(preamble)], syncword, sizeof(syncword));
+
+    return sizeof(preamble) + sizeof(syncword);
+}
+
+uint8_t FrameCodec::encode(uint8_t *frame, uint8_t port, uint32_t id, uint8_t payloadSize)
+{
+    // The receiver captures at most PayloadSize payload bytes
+    if (payloadSize > PayloadSize)
+    {
+        log_e("Payload size %u exceeds %u", payloadSize, PayloadSize);
+        return 0;
+    }
+    uint8_t frameSize = HeaderSize + payloadSize;
+
+    frame[2] = payloadSize;
+    frame[3] = port;
+    for (int i = 0; i < 3; i++)
+    {
+        frame[4 + i] = (id >> (16 - i * 8)) & 0xFF;
+    }
+
+    // Digest over payload length, port, transmitter ID and payload, whitening on the fly
+    uint16_t digest = 0;
+    for (uint8_t i = frameSize; i > 2;)
+    {
+        --i;
+        digest = Digest::step(digest, frame[i]);
+        frame[i] ^= Whitening;
+    }
+    digest ^= DigestXor;
+
+    frame[0] = (digest >> 8) ^ Whitening;
+    frame[1] = (digest & 0xFF) ^ Whitening;
+
+    return frameSize;
+}
+
+uint8_t FrameCodec::decode(uint8_t *frame, uint8_t bufferSize)
+{
+    if (bufferSize < HeaderSize)
+        return 0;
+
+    // The payload length limits de-whitening and digest to the frame
+    uint8_t length = frame[2] ^ Whitening;
+    if ((length <= PayloadSize) && (length <= bufferSize - HeaderSize))
+    {
+        uint8_t frameSize = HeaderSize + length;
+        if (dewhiten(frame, frameSize, DigestXor))
+        {
+            return frameSize;
+        }
+
+        // Restore the received frame
+        for (uint8_t i = 0; i < frameSize; i++)
+        {
+            frame[i] ^= Whitening;
+        }
+    }
+
+    // Frame without payload length (6-byte header, padded payload); the
+    // converted frame needs one more byte
+    if ((bufferSize < HeaderSize + PayloadSize) || !dewhiten(frame, LegacyFrameSize, LegacyDigestXor))
+    {
+        log_d("Digest check failed");
+        return 0;
+    }
+    memmove(&frame[3], &frame[2], LegacyFrameSize - 2);
+    frame[2] = PayloadSize;
+
+    return HeaderSize + PayloadSize;
+}
+
+bool FrameCodec::dewhiten(uint8_t *frame, uint8_t frameSize, uint16_t digestXor)
+{
+    // De-whitening and digest over payload length, port, transmitter ID and payload
+    uint16_t digest = 0;
+    for (uint8_t i = frameSize; i > 2;)
+    {
+        --i;
+        frame[i] ^= Whitening;
+        digest = Digest::step(digest, frame[i]);
+    }
+    frame[0] ^= Whitening;
+    frame[1] ^= Whitening;
+
+    uint16_t chkdgst = (frame[0] << 8) | frame[1];
+    return (chkdgst ^ digest) == digestXor;
+}
@@ -0,0 +1,249 @@
+///////////////////////////////////////////////////////////////////////////////
+// FrameCodec.h
+//
+// Radio frame codec - preamble, digest, transmitter ID and whitening
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created from gw_transmitter.ino / gw_receiver.ino
+//          Header byte 2 carries the port, transmitter ID reduced to 24 bits
+//          Upper nibble of the port byte carries the inverter index
+//          Added PortFamily
+//          Added PortConfig
+//          Added FormatV2
+//          Added FormatKey and FormatDelta
+//          Payload length in header byte 2, no padding (variable frame length)
+//          Added PortAck
+//          Frames without payload length (6-byte header) accepted by decode()
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_FRAMECODEC_H)
+#define _FRAMECODEC_H
+
+#include <Arduino.h>
+#include "utils/utils.h"
+
+/*!
+ * \brief Radio frame codec shared by transmitter and receiver
+ *
+ * Frame layout (following preamble and sync word):
+ *
+ * | byte0  | byte1  | byte2   | byte3   | byte4   | byte5   | byte6   | byte7 | ... | byteN |
+ * |--------|--------|---------|---------|---------|---------|---------|-------|-----|-------|
+ * | digest | digest | payload | index/  | chip_id | chip_id | chip_id |    <- payload ->    |
+ * | [15:8] |  [7:0] | length  | port    | [23:16] |  [15:8] |   [7:0] |                     |
+ * | <------------- whitening ---------------------------------------------------------> |
+ *
+ * Digest: LFSR-16, generator 0x8005, key 0xba95, final xor 0x93a5,
+ * calculated over payload length, port, transmitter ID and payload.
+ *
+ * The port selects the payload format (like the LoRaWAN fPort). Port 0 is
+ * treated as PortData.
+ *
+ * Transmitters built before the payload length was added send a 6-byte
+ * header (digest, port, transmitter ID) and a payload padded to PayloadSize
+ * (LegacyFrameSize). Their byte 2 is the port, or the (always zero) upper
+ * byte of the 32-bit chip ID with the original transmitter's v1 payload.
+ * Their digest uses the final xor 0x6df1: trailing zero bytes do not change
+ * the LFSR digest, so with the same final xor a padded frame could pass as
+ * a shorter frame with payload length and vice versa. decode() accepts these
+ * frames, too, and inserts the payload length, so the decoded frame has the
+ * layout above.
+ *
+ * With several inverters on the RS485 bus, each inverter's data is sent in
+ * a separate PortData (and PortFamily) frame; the upper nibble of the port
+ * byte is the inverter index (0 with a single inverter, so the byte is unchanged).
+ *
+ * The receiver acknowledges keyframes (payload format 3) with a PortAck frame;
+ * its ID field is the ID of the addressed transmitter.
+ *
+ * Frames are not padded, so the airtime follows the payload size. The
+ * receiver captures a fixed number of bytes (its sync word ends before the
+ * frame, so the radio's variable packet length mode cannot be used) and
+ * ignores the bytes following the frame.
+ *
+ * Whitening and digest calculation are done in a single in-place pass
+ * over the caller's buffer, running from the last byte to the first.
+ */
+class FrameCodec
+{
+public:
+    static const uint8_t PreambleSize = 6; //!< preamble (4 bytes) + sync word (2 bytes)
+    static const uint8_t HeaderSize = 7;   //!< digest (2 bytes) + length (1 byte) + port (1 byte) + transmitter ID (3 bytes)
+    static const uint8_t PayloadSize = 29; //!< max. payload size
+    static const uint8_t PortData = 1;     //!< inverter data (AppLayer::getPayloadStage2())
+    static const uint8_t PortFamily = 2;   //!< family specific inverter data (AppLayer::getFamilyPayload())
+    static const uint8_t PortTiming = 3;   //!< timing telemetry (AppLayer::getTimingPayload())
+    static const uint8_t PortDiag = 4;     //!< heap/stack diagnostics (AppLayer::getDiagPayload())
+    static const uint8_t PortConfig = 5;   //!< inverter settings (AppLayer::getConfigPayload())
+    static const uint8_t PortAck = 6;      //!< keyframe acknowledgement, receiver to transmitter (AppLayer::decodeDownlink())
+    static const uint8_t MaxIndex = 15;    //!< max. inverter index
+    static const uint8_t CaptureSize = 1 + HeaderSize + PayloadSize; //!< fixed length reception: last sync word byte + max. frame
+    static const uint8_t LegacyFrameSize = HeaderSize - 1 + PayloadSize; //!< frame without payload length (padded payload)
+
+    /*!
+     * \brief First byte of a v2 PortData payload (PAYLOAD_FORMAT 2)
+     *
+     * A v1 payload starts with the Modbus result, which is never 0xA2.
+     */
+    static const uint8_t FormatV2 = 0xA2;
+    static const uint8_t FormatKey = 0xA3;   //!< first byte of a v3 PortData keyframe payload
+    static const uint8_t FormatDelta = 0xA4; //!< first byte of a v3 PortData delta payload
+
+    /*!
+     * \brief Write preamble and sync word
+     *
+     * \param msg message buffer
+     *
+     * \returns number of bytes written (PreambleSize)
+     */
+    static uint8_t begin(uint8_t *msg);
+
+    /*!
+     * \brief Encode frame in-place
+     *
+     * The payload must already be in place at frame[HeaderSize].
+     * Payload length, port, transmitter ID and digest are written and the
+     * whole frame is whitened.
+     *
+     * \param frame frame buffer (following preamble and sync word)
+     * \param port port (payload format, see dataPort())
+     * \param id transmitter ID (24 bits)
+     * \param payloadSize payload size in bytes (max. PayloadSize)
+     *
+     * \returns frame size (HeaderSize + payloadSize) or 0 if payloadSize
+     *          exceeds PayloadSize (nothing written)
+     */
+    static uint8_t encode(uint8_t *frame, uint8_t port, uint32_t id, uint8_t payloadSize);
+
+    /*!
+     * \brief Decode frame in-place
+     *
+     * The frame is de-whitened and the digest is checked. Bytes following
+     * the frame (payload length in the header) are left untouched.
+     * If the digest check fails, the frame is checked as a frame without
+     * payload length (LegacyFrameSize); a valid one is converted to the
+     * current layout (payload length PayloadSize).
+     * The frame buffer is modified even if the digest check fails.
+     *
+     * \param frame frame buffer
+     * \param bufferSize size of the received data in bytes (at least header + payload;
+     *                   HeaderSize + PayloadSize for frames without payload length)
+     *
+     * \returns frame size (HeaderSize + payload length) or 0 if the length
+     *          exceeds the buffer or the digest is invalid
+     */
+    static uint8_t decode(uint8_t *frame, uint8_t bufferSize);
+
+    /*!
+     * \brief Get transmitter ID from decoded frame
+     *
+     * \param frame decoded frame buffer
+     *
+     * \returns transmitter ID (24 bits)
+     */
+    static uint32_t getId(const uint8_t *frame)
+    {
+        return ((uint32_t)frame[4] << 16) | ((uint32_t)frame[5] << 8) | frame[6];
+    };
+
+    /*!
+     * \brief Get payload length from decoded frame
+     *
+     * \param frame decoded frame buffer
+     *
+     * \returns payload length in bytes
+     */
+    static uint8_t getLength(const uint8_t *frame)
+    {
+        return frame[2];
+    };
+
+    /*!
+     * \brief Get port from decoded frame
+     *
+     * \param frame decoded frame buffer
+     *
+     * \returns port (0 from the original transmitter without port support, see
+     *          LegacyFrameSize, is mapped to PortData)
+     */
+    static uint8_t getPort(const uint8_t *frame)
+    {
+        return (frame[3] & 0x0F) ? (frame[3] & 0x0F) : PortData;
+    };
+
+    /*!
+     * \brief Get inverter index from decoded frame
+     *
+     * \param frame decoded frame buffer
+     *
+     * \returns inverter index (0...MaxIndex)
+     */
+    static uint8_t getIndex(const uint8_t *frame)
+    {
+        return frame[3] >> 4;
+    };
+
+    /*!
+     * \brief Get port byte of an inverter's data frame
+     *
+     * \param index inverter index (0...MaxIndex)
+     * \param port PortData, PortFamily or PortConfig
+     *
+     * \returns port byte for encode()
+     */
+    static uint8_t dataPort(uint8_t index, uint8_t port = PortData)
+    {
+        return (uint8_t)((index & MaxIndex) << 4) | port;
+    };
+
+private:
+    /*!
+     * \brief De-whiten frame in-place and check its digest
+     *
+     * \param frame frame buffer
+     * \param frameSize frame size in bytes
+     * \param digestXor final xor of the digest
+     *
+     * \returns true if the digest over frame[2...frameSize - 1] is valid
+     */
+    static bool dewhiten(uint8_t *frame, uint8_t frameSize, uint16_t digestXor);
+
+    static const uint8_t Whitening = 0xAA;
+    static const uint16_t DigestXor = 0x93A5;       // frames with payload length
+    static const uint16_t LegacyDigestXor = 0x6DF1; // frames without payload length
+    typedef LfsrDigest16<0x8005, 0xBA95> Digest;
+};
+#endif // _FRAMECODEC_H
@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+// PayloadCodec.cpp
+//
+// Data frame values as scaled integers - absolute and delta encoding
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//          Added clamp()
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PayloadCodec.h"
+
+const uint8_t PayloadCodec::Width[NumValues] = {1, 1, 2, 4, 4, 3, 2, 2, 2};
+const bool PayloadCodec::Signed[NumValues] = {false, false, false, false, false, true, false, false, true};
+const float PayloadCodec::Scale[NumValues] = {1, 1, 10, 10, 2, 10, 10, 100, 10};
+
+void PayloadCodec::clamp(int32_t *raw)
+{
+    for (uint8_t i = 0; i < NumValues; i++)
+    {
+        // 4 byte values are limited to the int32_t range
+        int32_t max = (Width[i] == 4) ? INT32_MAX : (1L << (8 * Width[i] - Signed[i])) - 1;
+        int32_t min = Signed[i] ? -max - 1 : 0;
+        if (raw[i] > max)
+        {
+            raw[i] = max;
+        }
+        else if (raw[i] < min)
+        {
+            raw[i] = min;
+        }
+    }
+}
+
+uint8_t PayloadCodec::writeAbsolute(uint8_t *buf, const int32_t *raw)
+{
+    uint8_t *p = buf;
+
+    for (uint8_t i = 0; i < NumValues; i++)
+    {
+        for (uint8_t b = 0; b < Width[i]; b++)
+        {
+            *p++ = (raw[i] >> (8 * b)) & 0xFF;
+        }
+    }
+    return p - buf;
+}
+
+uint8_t PayloadCodec::readAbsolute(const uint8_t *buf, int32_t *raw)
+{
+    const uint8_t *p = buf;
+
+    for (uint8_t i = 0; i < NumValues; i++)
+    {
+        uint32_t value = 0;
+        for (uint8_t b = 0; b < Width[i]; b++)
+        {
+            value |= (uint32_t)*p++ << (8 * b);
+        }
+        // Sign extension
+        uint8_t shift = 32 - 8 * Width[i];
+        raw[i] = (Signed[i] && shift) ? (int32_t)(value << shift) >> shift : (int32_t)value;
+    }
+    return p - buf;
+}
+
+uint8_t PayloadCodec::writeDelta(uint8_t *buf, const int32_t *raw, const int32_t *ref)
+{
+    uint8_t *p = &buf[2];
+    uint16_t mask = 0;
+
+    for (uint8_t i = 0; i < NumValues; i++)
+    {
+        int32_t delta = (int32_t)((uint32_t)raw[i] - (uint32_t)ref[i]);
+        if (delta == 0)
+        {
+            continue;
+        }
+        mask |= 1 << i;
+
+        uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+        while (zigzag >= 0x80)
+        {
+            *p++ = (zigzag & 0x7F) | 0x80;
+            zigzag >>= 7;
+        }
+        *p++ = zigzag;
+    }
+    buf[0] = mask & 0xFF;
+    buf[1] = mask >> 8;
+    return p - buf;
+}
+
+uint8_t PayloadCodec::readDelta(const uint8_t *buf, uint8_t size, const int32_t *ref, int32_t *raw)
+{
+    if (size < 2)
+    {
+        return 0;
+    }
+    uint16_t mask = buf[0] | (buf[1] << 8);
+    uint8_t pos = 2;
+
+    for (uint8_t i = 0; i < NumValues; i++)
+    {
+        raw[i] = ref[i];
+        if (!(mask & (1 << i)))
+        {
+            continue;
+        }
+
+        uint32_t zigzag = 0;
+        uint8_t shift = 0;
+        uint8_t c;
+        do
+        {
+            if ((pos >= size) || (shift > 28))
+            {
+                return 0;
+            }
+            c = buf[pos++];
+            zigzag |= (uint32_t)(c & 0x7F) << shift;
+            shift += 7;
+        } while (c & 0x80);
+
+        int32_t delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+        raw[i] = (int32_t)((uint32_t)ref[i] + (uint32_t)delta);
+    }
+    return pos;
+}
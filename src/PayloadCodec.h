@@ -0,0 +1,159 @@
+///////////////////////////////////////////////////////////////////////////////
+// PayloadCodec.h
+//
+// Data frame values as scaled integers - absolute and delta encoding
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//          Added clamp()
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_PAYLOADCODEC_H)
+#define _PAYLOADCODEC_H
+
+#include <Arduino.h>
+
+/*!
+ * \brief Data frame (port 1) values as scaled integers, shared by transmitter and receiver
+ *
+ * Each value is an integer with the resolution of its Modbus register
+ * (see inputMap in growattInterface.cpp).
+ *
+ * Absolute encoding (payload formats 2 and 3 keyframe): each value with a fixed
+ * width, little endian.
+ *
+ * Delta encoding (payload format 3): difference to a reference (keyframe),
+ * preceded by a 16 bit mask (little endian) of the values which differ;
+ * each difference is zigzag encoded (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...)
+ * and written as varint (7 bits per byte, least significant group first,
+ * bit 7 set if more bytes follow).
+ */
+class PayloadCodec
+{
+public:
+    /// Values in payload order
+    enum Value : uint8_t
+    {
+        Status,        //!< uint8
+        FaultCode,     //!< uint8
+        EnergyToday,   //!< uint16 [0.1 kWh]
+        EnergyTotal,   //!< uint32 [0.1 kWh]
+        TotalWorkTime, //!< uint32 [0.5 s]
+        OutputPower,   //!< int24 [0.1 W]
+        GridVoltage,   //!< uint16 [0.1 V]
+        GridFrequency, //!< uint16 [0.01 Hz]
+        TempInverter,  //!< int16 [0.1 °C]
+        NumValues
+    };
+
+    static const uint8_t AbsoluteSize = 21;                //!< size of absolute encoding
+    static const uint8_t MaxDeltaSize = 2 + 5 * NumValues; //!< max. size of delta encoding
+
+    /*!
+     * \brief Convert physical value to scaled integer
+     */
+    static int32_t toRaw(Value value, float physical)
+    {
+        return lroundf(physical * Scale[value]);
+    };
+
+    /*!
+     * \brief Convert scaled integer to physical value
+     */
+    static float toPhysical(Value value, int32_t raw)
+    {
+        return (double)raw / Scale[value];
+    };
+
+    /*!
+     * \brief Limit values to the ranges of their widths
+     *
+     * Must be applied before writeAbsolute() and writeDelta() (and to the
+     * reference values), so both encodings yield the values which
+     * readAbsolute() returns.
+     *
+     * \param raw values (NumValues)
+     */
+    static void clamp(int32_t *raw);
+
+    /*!
+     * \brief Write values with fixed widths
+     *
+     * \param buf output buffer (AbsoluteSize bytes)
+     * \param raw values (NumValues, see clamp())
+     *
+     * \returns AbsoluteSize
+     */
+    static uint8_t writeAbsolute(uint8_t *buf, const int32_t *raw);
+
+    /*!
+     * \brief Read values with fixed widths
+     *
+     * \param buf input buffer (AbsoluteSize bytes)
+     * \param raw values (NumValues)
+     *
+     * \returns AbsoluteSize
+     */
+    static uint8_t readAbsolute(const uint8_t *buf, int32_t *raw);
+
+    /*!
+     * \brief Write differences to reference values
+     *
+     * \param buf output buffer (MaxDeltaSize bytes)
+     * \param raw values (NumValues, see clamp())
+     * \param ref reference values (NumValues, see clamp())
+     *
+     * \returns number of bytes written
+     */
+    static uint8_t writeDelta(uint8_t *buf, const int32_t *raw, const int32_t *ref);
+
+    /*!
+     * \brief Read differences and add reference values
+     *
+     * \param buf input buffer
+     * \param size input buffer size in bytes
+     * \param ref reference values (NumValues)
+     * \param raw values (NumValues)
+     *
+     * \returns number of bytes read (0: invalid encoding)
+     */
+    static uint8_t readDelta(const uint8_t *buf, uint8_t size, const int32_t *ref, int32_t *raw);
+
+private:
+    static const uint8_t Width[NumValues];
+    static const bool Signed[NumValues];
+    static const float Scale[NumValues];
+};
+#endif // _PAYLOADCODEC_H
@@ -7,8 +7,367 @@
 //                      The code was originally executed on ESP8266 in a timer interrupt handler;
 //                      will now be run on ESP32 in main execution loop.
 // 20230408 matthias-bs Added Modbus serial interface selection
+// 20261017 matthias-bs Replaced hand-written decoding by register maps (see growattRegisters.h)
+//                      Read only the register ranges required by the selected fields (see growatt_plan())
+//                      Added register cache in RTC memory with per-field TTL
+//                      Added non-blocking acquisition with Modbus RTU framing derived from the data rate
+//                      Added event-driven reception using the UART RX timeout (MODBUS_UART_EVENTS)
+//                      Added RS485 direction control by the UART (MODBUS_RS485_HALF_DUPLEX)
+//                      Added multiple inverters on the RS485 bus (selectSlave())
+//                      Added family specific input registers (GROWATT_FAMILY)
+//                      Added holding register snapshot in NVS (GROWATT_SETTINGS_NVS)
+//                      Added circuit breaker for unreachable inverters (MODBUS_BREAKER_THRESHOLD)
+//                      Replaced quadratic sprintf() JSON generation by bounded JsonWriter
+//                      Added readRegister() with result code (export limiter read-back)
+//                      Added raw Modbus transaction capture (MODBUS_CAPTURE)
+//                      Fixed addresses of deratingmode (104) and faultbitcode (106/107)
+//                      UART event callback only reads the UART while an acquisition waits for a response
+//                      ReadInputRegisters()/ReadHoldingRegisters() run the non-blocking acquisition to completion
+//                      Input register map entries not in GROWATT_INPUT_FIELDS dropped at compile time
+//                      Response handoff from the UART event task guarded by a critical section
+//                      MODBUS_UART_EVENTS falls back to polled reception on targets other than ESP32
 
+#include <stddef.h>
+#include <string.h>
 #include "growattInterface.h"
+#include "growatt_cfg.h"
+#include "utils/jsonwriter.h"
+#if defined(MODBUS_RS485_HALF_DUPLEX) && defined(ESP32)
+#include "soc/gpio_sig_map.h"
+#endif
+#if defined(GROWATT_SETTINGS_NVS)
+#include <Preferences.h>
+#endif
+
+#if !defined(GROWATT_INPUT_FIELDS)
+#define GROWATT_INPUT_FIELDS GW_INPUT_ALL
+#endif
+#if !defined(GROWATT_TTL_SLOW)
+#define GROWATT_TTL_SLOW 0
+#endif
+#if !defined(GROWATT_TTL_STATIC)
+#define GROWATT_TTL_STATIC 0
+#endif
+
+#if !defined(GROWATT_MAX_INVERTERS)
+#define GROWATT_MAX_INVERTERS 1
+#endif
+#if !defined(GROWATT_SETTINGS_FIELDS)
+#define GROWATT_SETTINGS_FIELDS GW_HOLDING_ALL
+#endif
+
+#if !defined(MODBUS_SETTLE_TIME)
+#define MODBUS_SETTLE_TIME 500
+#endif
+#if !defined(MODBUS_RESPONSE_TIMEOUT)
+#define MODBUS_RESPONSE_TIMEOUT 2000
+#endif
+#if !defined(MODBUS_BACKOFF)
+#define MODBUS_BACKOFF 1000
+#endif
+#if !defined(MODBUS_BREAKER_THRESHOLD)
+#define MODBUS_BREAKER_THRESHOLD 0
+#endif
+#if !defined(MODBUS_PROBE_TIMEOUT)
+#define MODBUS_PROBE_TIMEOUT 100
+#endif
+
+#define GROWATT_CACHE_MAGIC 0x47574331 // "GWC1"
+
+// UART RX timeout [characters] signalling the end of a response frame;
+// between the max. gap within a frame (1.5) and the min. gap between frames (3.5)
+#define MODBUS_RX_TIMEOUT 3
+
+// Event-driven reception requires the ESP32 UART event API (HardwareSerial::onReceive());
+// the host build provides it by its HardwareSerial shim
+#if defined(MODBUS_UART_EVENTS) && defined(ARDUINO) && !defined(ESP32)
+#warning "MODBUS_UART_EVENTS requires ESP32 - using polled reception"
+#undef MODBUS_UART_EVENTS
+#endif
+
+#if defined(MODBUS_UART_EVENTS) && defined(ESP32)
+// Given by the UART event task when a response frame has been received
+static SemaphoreHandle_t rxEvent;
+
+// Guards the response handoff (rxFrame, rxSize, rxCrc, rxDone, rxSeq) between
+// the UART event task and poll()
+static portMUX_TYPE rxMux = portMUX_INITIALIZER_UNLOCKED;
+#define RX_LOCK() portENTER_CRITICAL(&rxMux)
+#define RX_UNLOCK() portEXIT_CRITICAL(&rxMux)
+#else
+// Host build: the UART event is raised in the calling thread
+#define RX_LOCK()
+#define RX_UNLOCK()
+#endif
+
+typedef growattIF::modbus_input_registers InputRecord;
+typedef growattIF::modbus_holding_registers HoldingRecord;
+
+// Input register map of all fields (order: GrowattInputField)
+static constexpr GrowattRegister inputRegisters[] = {
+  // Status and PV data
+  gwInt(0, GW_U16, offsetof(InputRecord, status)),
+  gwFloat(1, GW_S32F, 0.1, offsetof(InputRecord, solarpower)),
+  gwFloat(3, GW_U16F, 0.1, offsetof(InputRecord, pv1voltage)),
+  gwFloat(4, GW_U16F, 0.1, offsetof(InputRecord, pv1current)),
+  gwFloat(5, GW_S32F, 0.1, offsetof(InputRecord, pv1power)),
+  gwFloat(7, GW_U16F, 0.1, offsetof(InputRecord, pv2voltage)),
+  gwFloat(8, GW_U16F, 0.1, offsetof(InputRecord, pv2current)),
+  gwFloat(9, GW_S32F, 0.1, offsetof(InputRecord, pv2power)),
+
+  // Output
+  gwFloat(35, GW_S32F, 0.1, offsetof(InputRecord, outputpower)),
+  gwFloat(37, GW_U16F, 0.01, offsetof(InputRecord, gridfrequency)),
+  gwFloat(38, GW_U16F, 0.1, offsetof(InputRecord, gridvoltage)),
+
+  // Energy
+  gwFloat(53, GW_S32F, 0.1, offsetof(InputRecord, energytoday)),
+  gwFloat(55, GW_S32F, 0.1, offsetof(InputRecord, energytotal), GROWATT_TTL_SLOW),
+  gwFloat(57, GW_S32F, 0.5, offsetof(InputRecord, totalworktime), GROWATT_TTL_SLOW),
+  gwFloat(59, GW_S32F, 0.1, offsetof(InputRecord, pv1energytoday)),
+  gwFloat(61, GW_S32F, 0.1, offsetof(InputRecord, pv1energytotal), GROWATT_TTL_SLOW),
+  gwFloat(63, GW_S32F, 0.1, offsetof(InputRecord, pv2energytoday)),
+  gwFloat(65, GW_S32F, 0.1, offsetof(InputRecord, pv2energytotal), GROWATT_TTL_SLOW),
+
+  // Temperatures
+  gwFloat(93, GW_U16F, 0.1, offsetof(InputRecord, tempinverter)),
+  gwFloat(94, GW_U16F, 0.1, offsetof(InputRecord, tempipm)),
+  gwFloat(95, GW_U16F, 0.1, offsetof(InputRecord, tempboost)),
+
+  // Diag data
+  gwInt(100, GW_U16, offsetof(InputRecord, ipf)),
+  gwInt(101, GW_U16, offsetof(InputRecord, realoppercent)),
+  gwFloat(102, GW_S32F, 0.1, offsetof(InputRecord, opfullpower), GROWATT_TTL_STATIC),
+
+  gwInt(104, GW_U16, offsetof(InputRecord, deratingmode)),
+  //  0:no derate;
+  //  1:PV;
+  //  2:*;
+  //  3:Vac;
+  //  4:Fac;
+  //  5:Tboost;
+  //  6:Tinv;
+  //  7:Control;
+  //  8:*;
+  //  9:*OverBack
+  //  ByTime;
+
+  gwInt(105, GW_U16, offsetof(InputRecord, faultcode)),
+  //  1~23 " Error: 99+x
+  //  24 "Auto Test
+  //  25 "No AC
+  //  26 "PV Isolation Low",
+  //  27 " Residual I
+  //  28 " Output High
+  //  29 " PV Voltage
+  //  30 " AC V Outrange
+  //  31 " AC F Outrange
+  //  32 " Module Hot
+
+  gwInt(106, GW_S32, offsetof(InputRecord, faultbitcode)),
+  //  0x00000001 %
+  //  0x00000002 Communication error
+  //  0x00000004 %
+  //  0x00000008 StrReverse or StrShort fault
+  //  0x00000010 Model Init fault
+  //  0x00000020 Grid Volt Sample diffirent
+  //  0x00000040 ISO Sample diffirent
+  //  0x00000080 GFCI Sample diffirent
+  //  0x00000100 %
+  //  0x00000200 %
+  //  0x00000400 %
+  //  0x00000800 %
+  //  0x00001000 AFCI Fault
+  //  0x00002000 %
+  //  0x00004000 AFCI Module fault
+  //  0x00008000 %
+  //  0x00010000 %
+  //  0x00020000 Relay check fault
+  //  0x00040000 %
+  //  0x00080000 %
+  //  0x00100000 %
+  //  0x00200000 Communication error
+  //  0x00400000 Bus Voltage error
+  //  0x00800000 AutoTest fail
+  //  0x01000000 No Utility
+  //  0x02000000 PV Isolation Low
+  //  0x04000000 Residual I High
+  //  0x08000000 Output High DCI
+  //  0x10000000 PV Voltage high
+  //  0x20000000 AC V Outrange
+  //  0x40000000 AC F Outrange
+  //  0x80000000 TempratureHigh
+
+  gwInt(110, GW_S32, offsetof(InputRecord, warningbitcode)),
+  //  0x0001 Fan warning
+  //  0x0002 String communication abnormal
+  //  0x0004 StrPIDconfig Warning
+  //  0x0008 %
+  //  0x0010 DSP and COM firmware unmatch
+  //  0x0020 %
+  //  0x0040 SPD abnormal
+  //  0x0080 GND and N connect abnormal
+  //  0x0100 PV1 or PV2 circuit short
+  //  0x0200 PV1 or PV2 boost driver broken
+  //  0x0400 %
+  //  0x0800 %
+  //  0x1000 %
+  //  0x2000 %
+  //  0x4000 %
+  //  0x8000 %
+
+#if GROWATT_FAMILY == GW_FAMILY_MOD
+  // MOD/MAX (TL3-X): phase 2 and 3 of the grid connection (phase 1: gridvoltage)
+  gwFloat(42, GW_U16F, 0.1, offsetof(InputRecord, gridvoltage2)),
+  gwFloat(46, GW_U16F, 0.1, offsetof(InputRecord, gridvoltage3)),
+#elif GROWATT_FAMILY == GW_FAMILY_SPH
+  // SPH: battery (storage input registers 1000...1124)
+  gwFloat(1009, GW_S32F, 0.1, offsetof(InputRecord, dischargepower)),
+  gwFloat(1011, GW_S32F, 0.1, offsetof(InputRecord, chargepower)),
+  gwFloat(1013, GW_U16F, 0.1, offsetof(InputRecord, batteryvoltage)),
+  gwInt(1014, GW_U16, offsetof(InputRecord, soc)),                     // [%]
+#endif
+};
+static_assert(sizeof(inputRegisters) / sizeof(inputRegisters[0]) == GW_NUM_INPUT_FIELDS, "inputRegisters does not match GrowattInputField");
+
+// Input register map of GROWATT_INPUT_FIELDS; the other entries are dropped at compile time
+static constexpr auto inputMap =
+  growatt_select<growatt_count(GROWATT_INPUT_FIELDS, GW_NUM_INPUT_FIELDS)>(inputRegisters, GROWATT_INPUT_FIELDS);
+
+// Holding register map of all fields (order: GrowattHoldingField)
+static constexpr GrowattRegister holdingRegisters[] = {
+  gwInt(0, GW_U16, offsetof(HoldingRecord, enable), GROWATT_TTL_SLOW),
+  gwInt(1, GW_U16, offsetof(HoldingRecord, safetyfuncen), GROWATT_TTL_STATIC), // Safety Function Enabled
+  //  Bit0: SPI enable
+  //  Bit1: AutoTestStart
+  //  Bit2: LVFRT enable
+  //  Bit3: FreqDerating Enable
+  //  Bit4: Softstart enable
+  //  Bit5: DRMS enable
+  //  Bit6: Power Volt Func Enable
+  //  Bit7: HVFRT enable
+  //  Bit8: ROCOF enable
+  //  Bit9: Recover FreqDerating Mode Enable
+  //  Bit10~15: Reserved
+  gwInt(3, GW_U16, offsetof(HoldingRecord, maxoutputactivepp), GROWATT_TTL_SLOW),   // Inverter M ax output active power percent  0-100: %, 255: not limited
+  gwInt(4, GW_U16, offsetof(HoldingRecord, maxoutputreactivepp), GROWATT_TTL_SLOW), // Inverter M ax output reactive power percent  0-100: %, 255: not limited
+  gwFloat(6, GW_S32F, 0.1, offsetof(HoldingRecord, maxpower), GROWATT_TTL_STATIC),
+  gwFloat(8, GW_U16F, 0.1, offsetof(HoldingRecord, voltnormal), GROWATT_TTL_STATIC),
+  gwString(9, 6, offsetof(HoldingRecord, firmware), GROWATT_TTL_STATIC),
+  gwString(12, 6, offsetof(HoldingRecord, controlfirmware), GROWATT_TTL_STATIC),
+  gwFloat(17, GW_U16F, 0.1, offsetof(HoldingRecord, startvoltage), GROWATT_TTL_STATIC),
+  gwString(23, 10, offsetof(HoldingRecord, serial), GROWATT_TTL_STATIC),
+  gwFloat(52, GW_U16F, 0.1, offsetof(HoldingRecord, gridvoltlowlimit), GROWATT_TTL_STATIC),
+  gwFloat(53, GW_U16F, 0.1, offsetof(HoldingRecord, gridvolthighlimit), GROWATT_TTL_STATIC),
+  gwFloat(54, GW_U16F, 0.01, offsetof(HoldingRecord, gridfreqlowlimit), GROWATT_TTL_STATIC),
+  gwFloat(55, GW_U16F, 0.01, offsetof(HoldingRecord, gridfreqhighlimit), GROWATT_TTL_STATIC),
+  gwFloat(64, GW_U16F, 0.1, offsetof(HoldingRecord, gridvoltlowconnlimit), GROWATT_TTL_STATIC),
+  gwFloat(65, GW_U16F, 0.1, offsetof(HoldingRecord, gridvolthighconnlimit), GROWATT_TTL_STATIC),
+  gwFloat(66, GW_U16F, 0.01, offsetof(HoldingRecord, gridfreqlowconnlimit), GROWATT_TTL_STATIC),
+  gwFloat(67, GW_U16F, 0.01, offsetof(HoldingRecord, gridfreqhighconnlimit), GROWATT_TTL_STATIC),
+  gwInt(121, GW_U16, offsetof(HoldingRecord, modul), GROWATT_TTL_STATIC)
+};
+static_assert(sizeof(holdingRegisters) / sizeof(holdingRegisters[0]) == GW_NUM_HOLDING_FIELDS, "holdingRegisters does not match GrowattHoldingField");
+
+// Holding register map (all fields: settings, power limits)
+static constexpr auto holdingMap = growatt_select<GW_NUM_HOLDING_FIELDS>(holdingRegisters, GW_HOLDING_ALL);
+
+// Decoded values and field ages; kept in RTC memory across deep sleep
+template <typename Record, size_t Fields>
+struct GrowattCache
+{
+  uint32_t magic;
+  uint8_t age[Fields];
+  Record data;
+};
+
+RTC_DATA_ATTR static GrowattCache<InputRecord, GW_NUM_INPUT_FIELDS> inputCache[GROWATT_MAX_INVERTERS];
+RTC_DATA_ATTR static GrowattCache<HoldingRecord, GW_NUM_HOLDING_FIELDS> holdingCache[GROWATT_MAX_INVERTERS];
+
+// Restore the record from the cache (or invalidate the cache after power-on)
+template <typename Record, size_t Fields>
+static void cacheLoad(GrowattCache<Record, Fields> &cache, Record &record) {
+  if (cache.magic != GROWATT_CACHE_MAGIC) {
+    memset(cache.age, GW_AGE_UNKNOWN, sizeof(cache.age));
+    cache.magic = GROWATT_CACHE_MAGIC;
+    return;
+  }
+  memcpy(&record, &cache.data, sizeof(Record));
+}
+
+// Save the record and update the field ages after an acquisition
+template <typename Record, size_t Fields>
+static void cacheStore(GrowattCache<Record, Fields> &cache, const Record &record, uint32_t fields, uint32_t refreshed) {
+  growatt_age(Fields, fields, refreshed, cache.age);
+  memcpy(&cache.data, &record, sizeof(Record));
+  log_d("Fields read: %d, cached: %d", __builtin_popcount(refreshed), __builtin_popcount(fields & ~refreshed));
+}
+
+// Consecutive response timeouts per inverter (circuit breaker) - kept in RTC memory
+RTC_DATA_ATTR static uint8_t timeouts[GROWATT_MAX_INVERTERS];
+
+// Fingerprint of the settings snapshot (GROWATT_SETTINGS_FIELDS; 0: no snapshot) - kept in RTC memory
+RTC_DATA_ATTR static uint32_t settingsHash[GROWATT_MAX_INVERTERS];
+
+// FNV-1a hash of the GROWATT_SETTINGS_FIELDS in the record (never 0)
+static uint32_t settingsFingerprint(const HoldingRecord &record) {
+  uint32_t hash = 0x811C9DC5UL;
+  for (const GrowattRegister &reg : holdingMap.reg) {
+    if (!(GROWATT_SETTINGS_FIELDS & GW_FIELD(reg.field))) {
+      continue;
+    }
+    size_t size = (reg.type == GW_STR) ? 2 * reg.words : ((reg.type == GW_U16F) || (reg.type == GW_S32F)) ? sizeof(float) : sizeof(int);
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(&record) + reg.offset;
+    for (size_t j = 0; j < size; j++) {
+      hash = (hash ^ p[j]) * 0x01000193UL;
+    }
+  }
+  return hash ? hash : 1;
+}
+
+#if defined(GROWATT_SETTINGS_NVS)
+#define GROWATT_NVS_NAMESPACE "growatt"
+
+// Settings snapshot in NVS (key "hold<inverter index>")
+struct GrowattSnapshot
+{
+  uint32_t fingerprint;
+  HoldingRecord data;
+};
+
+// Restore the record from NVS, returns its fingerprint (0: no valid snapshot)
+static uint32_t snapshotLoad(uint8_t index, HoldingRecord &record) {
+  Preferences prefs;
+  GrowattSnapshot snapshot;
+  char key[8];
+  snprintf(key, sizeof(key), "hold%u", index);
+  prefs.begin(GROWATT_NVS_NAMESPACE, true);
+  size_t size = prefs.getBytes(key, &snapshot, sizeof(snapshot));
+  prefs.end();
+  if ((size != sizeof(snapshot)) || (settingsFingerprint(snapshot.data) != snapshot.fingerprint)) {
+    log_d("No settings snapshot in NVS (inverter %u)", index);
+    return 0;
+  }
+  memcpy(&record, &snapshot.data, sizeof(HoldingRecord));
+  log_d("Settings snapshot restored from NVS (inverter %u)", index);
+  return snapshot.fingerprint;
+}
+
+// Save the record in NVS
+static void snapshotStore(uint8_t index, const HoldingRecord &record, uint32_t fingerprint) {
+  Preferences prefs;
+  GrowattSnapshot snapshot;
+  char key[8];
+  snprintf(key, sizeof(key), "hold%u", index);
+  snapshot.fingerprint = fingerprint;
+  memcpy(&snapshot.data, &record, sizeof(HoldingRecord));
+  prefs.begin(GROWATT_NVS_NAMESPACE, false);
+  if (prefs.putBytes(key, &snapshot, sizeof(snapshot)) != sizeof(snapshot)) {
+    log_e("Writing settings snapshot to NVS failed");
+  }
+  prefs.end();
+}
+#endif
 
 extern bool modbusRS485;
 
@@ -28,11 +387,33 @@ growattIF::growattIF(int _PinMAX485_RE_NEG, int _PinMAX485_DE, int _PinMAX485_RX
 void growattIF::initGrowatt() {
   if (modbusRS485) {
     Serial2.begin(MODBUS_RATE_RS485, SERIAL_8N1, PinMAX485_RX, PinMAX485_TX);
-    growattInterface.begin(SLAVE_ID, Serial2);
+    growattInterface.begin(slaveId, Serial2);
+    serial = &Serial2;
+    baudRate = MODBUS_RATE_RS485;
+#if defined(MODBUS_RS485_HALF_DUPLEX)
+    // The UART drives DE via RTS - asserted with the start bit of the first character
+    // and released right after the stop bit of the last character
+    Serial2.setPins(PinMAX485_RX, PinMAX485_TX, -1, PinMAX485_DE);
+    hwDirection = Serial2.setMode(UART_MODE_RS485_HALF_DUPLEX);
+#if defined(ESP32)
+    if (hwDirection) {
+      // RE (active low) follows DE - receiver disabled while transmitting
+      pinMatrixOutAttach(PinMAX485_RE_NEG, U2RTS_OUT_IDX, false, false);
+    }
+#endif
+    if (!hwDirection) {
+      log_e("RS485 half-duplex mode not available, using software direction control");
+    }
+#endif
   } else {
     Serial.begin(MODBUS_RATE_USB, SERIAL_8N1);
-    growattInterface.begin(SLAVE_ID, Serial);
+    growattInterface.begin(slaveId, Serial);
+    serial = &Serial;
+    baudRate = MODBUS_RATE_USB;
   }
+  initTime = micros();
+  acqState = AcqIdle;
+
   
   static growattIF* obj = this;                              //pointer to the object
   // Callbacks allow us to configure the RS485 transceiver correctly
@@ -44,9 +425,123 @@ void growattIF::initGrowatt() {
     obj->postTransmission();
   });
 
+#if defined(MODBUS_UART_EVENTS)
+  // End of frame is detected by the UART (RX timeout) and handled in the UART event task
+#if defined(ESP32)
+  if (!rxEvent) {
+    rxEvent = xSemaphoreCreateBinary();
+  }
+#endif
+  serial->setRxTimeout(MODBUS_RX_TIMEOUT);
+  serial->onReceive([]() {
+    obj->onUartReceive();
+  }, true);
+#endif
+
+}
+
+void growattIF::selectSlave(uint8_t index, uint8_t id) {
+  if (index >= GROWATT_MAX_INVERTERS) {
+    log_e("Inverter index %u exceeds GROWATT_MAX_INVERTERS", index);
+    index = GROWATT_MAX_INVERTERS - 1;
+  }
+  slaveIndex = index;
+  slaveId = id;
+  carry = {};
+  if (serial) {
+    growattInterface.begin(slaveId, *serial);
+  }
+}
+
+bool growattIF::loadSettings() {
+  bool powerOn = (holdingCache[slaveIndex].magic != GROWATT_CACHE_MAGIC);
+
+  cacheLoad(holdingCache[slaveIndex], modbussettings);
+  if (powerOn) {
+    // The settings are re-read after power-on - until then, the snapshot from NVS is used
+    settingsHash[slaveIndex] = 0;
+#if defined(GROWATT_SETTINGS_NVS)
+    settingsHash[slaveIndex] = snapshotLoad(slaveIndex, holdingCache[slaveIndex].data);
+    memcpy(&modbussettings, &holdingCache[slaveIndex].data, sizeof(HoldingRecord));
+#endif
+  }
+  return settingsHash[slaveIndex] != 0;
+}
+
+bool growattIF::settingsChanged() {
+  bool changed = changedSettings & (1 << slaveIndex);
+  changedSettings &= ~(1 << slaveIndex);
+  return changed;
+}
+
+void growattIF::storeSettings() {
+  if (!(planFields & GROWATT_SETTINGS_FIELDS)) {
+    // Nothing read - the snapshot is unchanged
+    return;
+  }
+  // The snapshot is only taken when all of its fields have been read
+  for (size_t i = 0; i < GW_NUM_HOLDING_FIELDS; i++) {
+    if ((GROWATT_SETTINGS_FIELDS & GW_FIELD(i)) && (holdingCache[slaveIndex].age[i] == GW_AGE_UNKNOWN)) {
+      return;
+    }
+  }
+  uint32_t fingerprint = settingsFingerprint(modbussettings);
+  if (fingerprint == settingsHash[slaveIndex]) {
+    return;
+  }
+  log_i("Settings changed (slave %u): 0x%08lx", slaveId, (unsigned long)fingerprint);
+  settingsHash[slaveIndex] = fingerprint;
+  changedSettings |= 1 << slaveIndex;
+#if defined(GROWATT_SETTINGS_NVS)
+  snapshotStore(slaveIndex, modbussettings, fingerprint);
+#endif
+}
+
+void growattIF::checkSettingsHint() {
+  // A changed fault code or derating mode may come along with changed settings (e.g. grid code)
+  const GrowattCache<InputRecord, GW_NUM_INPUT_FIELDS> &cache = inputCache[slaveIndex];
+  bool changed = ((planFields & GW_FIELD(GW_FAULTCODE)) && (cache.age[GW_FAULTCODE] != GW_AGE_UNKNOWN) &&
+                  (cache.data.faultcode != modbusdata.faultcode)) ||
+                 ((planFields & GW_FIELD(GW_DERATINGMODE)) && (cache.age[GW_DERATINGMODE] != GW_AGE_UNKNOWN) &&
+                  (cache.data.deratingmode != modbusdata.deratingmode));
+  if (changed) {
+    log_d("Fault code or derating mode changed - settings will be re-read");
+    memset(holdingCache[slaveIndex].age, GW_AGE_UNKNOWN, sizeof(holdingCache[slaveIndex].age));
+  }
+}
+
+bool growattIF::breakerOpen() const {
+  return (MODBUS_BREAKER_THRESHOLD > 0) && (timeouts[slaveIndex] >= MODBUS_BREAKER_THRESHOLD);
+}
+
+void growattIF::updateBreaker(uint8_t result) {
+  if (result != ModbusMaster::ku8MBResponseTimedOut) {
+    // Any response - the inverter is reachable
+    if (breakerOpen()) {
+      log_i("Circuit breaker closed (slave %u)", slaveId);
+    }
+    timeouts[slaveIndex] = 0;
+    return;
+  }
+  if (timeouts[slaveIndex] < UINT8_MAX) {
+    timeouts[slaveIndex]++;
+  }
+  if (breakerOpen()) {
+    if (timeouts[slaveIndex] == MODBUS_BREAKER_THRESHOLD) {
+      log_i("Circuit breaker opened (slave %u)", slaveId);
+    }
+    // No further retries while the inverter is unreachable
+    acqRetries = 0;
+  }
 }
 
 uint8_t growattIF::writeRegister(uint16_t reg, uint16_t message) {
+  // Force re-read of the cached holding register field
+  for (const GrowattRegister &entry : holdingMap.reg) {
+    if ((reg >= entry.addr) && (reg < entry.addr + entry.words)) {
+      holdingCache[slaveIndex].age[entry.field] = GW_AGE_UNKNOWN;
+    }
+  }
   return growattInterface.writeSingleRegister(reg, message);
 }
 
@@ -55,297 +550,524 @@ uint16_t growattIF::readRegister(uint16_t reg) {
   return growattInterface.getResponseBuffer(0);				// returns 16bit
 }
 
+uint8_t growattIF::readRegister(uint16_t reg, uint16_t &value) {
+  uint8_t result = growattInterface.readHoldingRegisters(reg, 1);
+  if (result == growattInterface.ku8MBSuccess) {
+    value = growattInterface.getResponseBuffer(0);
+  }
+  return result;
+}
+
 void growattIF::preTransmission() {
+  if (hwDirection) {
+    return;
+  }
   digitalWrite(PinMAX485_RE_NEG, 1);
   digitalWrite(PinMAX485_DE, 1);
 }
 
 void growattIF::postTransmission() {
+  if (hwDirection) {
+    return;
+  }
   digitalWrite(PinMAX485_RE_NEG, 0);
   digitalWrite(PinMAX485_DE, 0);
 }
 
-uint8_t growattIF::ReadInputRegisters(char* json) {
-  uint8_t result;
+size_t growattIF::inputJson(char *json, size_t size) const {
+  JsonWriter writer(json, size);
 
-  //ESP.wdtDisable();
-  result = growattInterface.readInputRegisters(setcounter * 64, 64);
-  //ESP.wdtEnable(1);
+  writer.add("status", modbusdata.status);
+  writer.add("solarpower", modbusdata.solarpower, 1);
+  writer.add("pv1voltage", modbusdata.pv1voltage, 1);
+  writer.add("pv1current", modbusdata.pv1current, 1);
+  writer.add("pv1power", modbusdata.pv1power, 1);
+  writer.add("pv2voltage", modbusdata.pv2voltage, 1);
+  writer.add("pv2current", modbusdata.pv2current, 1);
+  writer.add("pv2power", modbusdata.pv2power, 1);
 
-  if (result == growattInterface.ku8MBSuccess)   {
-    if (setcounter == 0) {    //register 0-63
-      // Status and PV data
-      modbusdata.status = growattInterface.getResponseBuffer(0);
-      modbusdata.solarpower = ((growattInterface.getResponseBuffer(1) << 16) | growattInterface.getResponseBuffer(2)) * 0.1;
+  writer.add("outputpower", modbusdata.outputpower, 1);
+  writer.add("gridfrequency", modbusdata.gridfrequency, 2);
+  writer.add("gridvoltage", modbusdata.gridvoltage, 1);
 
-      modbusdata.pv1voltage = growattInterface.getResponseBuffer(3) * 0.1;
-      modbusdata.pv1current = growattInterface.getResponseBuffer(4) * 0.1;
-      modbusdata.pv1power = ((growattInterface.getResponseBuffer(5) << 16) | growattInterface.getResponseBuffer(6)) * 0.1;
+  writer.add("energytoday", modbusdata.energytoday, 1);
+  writer.add("energytotal", modbusdata.energytotal, 1);
+  writer.add("totalworktime", modbusdata.totalworktime, 1);
+  writer.add("pv1energytoday", modbusdata.pv1energytoday, 1);
+  writer.add("pv1energytotal", modbusdata.pv1energytotal, 1);
+  writer.add("pv2energytoday", modbusdata.pv2energytoday, 1);
+  writer.add("pv2energytotal", modbusdata.pv2energytotal, 1);
+  writer.add("opfullpower", modbusdata.opfullpower, 1);
 
-      modbusdata.pv2voltage = growattInterface.getResponseBuffer(7) * 0.1;
-      modbusdata.pv2current = growattInterface.getResponseBuffer(8) * 0.1;
-      modbusdata.pv2power = ((growattInterface.getResponseBuffer(9) << 16) | growattInterface.getResponseBuffer(10)) * 0.1;
+  writer.add("tempinverter", modbusdata.tempinverter, 1);
+  writer.add("tempipm", modbusdata.tempipm, 1);
+  writer.add("tempboost", modbusdata.tempboost, 1);
 
-      // Output
-      modbusdata.outputpower = ((growattInterface.getResponseBuffer(35) << 16) | growattInterface.getResponseBuffer(36)) * 0.1;
-      modbusdata.gridfrequency = growattInterface.getResponseBuffer(37) * 0.01;
-      modbusdata.gridvoltage = growattInterface.getResponseBuffer(38) * 0.1;
+  writer.add("ipf", modbusdata.ipf);
+  writer.add("realoppercent", modbusdata.realoppercent);
+  writer.add("deratingmode", modbusdata.deratingmode);
+  writer.add("faultcode", modbusdata.faultcode);
+  writer.add("faultbitcode", modbusdata.faultbitcode);
+#if GROWATT_FAMILY == GW_FAMILY_MOD
+  writer.add("gridvoltage2", modbusdata.gridvoltage2, 1);
+  writer.add("gridvoltage3", modbusdata.gridvoltage3, 1);
+#elif GROWATT_FAMILY == GW_FAMILY_SPH
+  writer.add("dischargepower", modbusdata.dischargepower, 1);
+  writer.add("chargepower", modbusdata.chargepower, 1);
+  writer.add("batteryvoltage", modbusdata.batteryvoltage, 1);
+  writer.add("soc", modbusdata.soc);
+#endif
+  writer.add("warningbitcode", modbusdata.warningbitcode);
 
-      // Energy
-      modbusdata.energytoday = ((growattInterface.getResponseBuffer(53) << 16) | growattInterface.getResponseBuffer(54)) * 0.1;
-      modbusdata.energytotal = ((growattInterface.getResponseBuffer(55) << 16) | growattInterface.getResponseBuffer(56)) * 0.1;
-      modbusdata.totalworktime = ((growattInterface.getResponseBuffer(57) << 16) | growattInterface.getResponseBuffer(58)) * 0.5;
+  size_t len = writer.end();
+  if (writer.overflow()) {
+    log_e("JSON buffer too small");
+  }
+  return len;
+}
 
-      modbusdata.pv1energytoday = ((growattInterface.getResponseBuffer(59) << 16) | growattInterface.getResponseBuffer(60)) * 0.1;
-      modbusdata.pv1energytotal = ((growattInterface.getResponseBuffer(61) << 16) | growattInterface.getResponseBuffer(62)) * 0.1;
-      overflow = growattInterface.getResponseBuffer(63);
-      setcounter ++;
-      return Continue;
-    }
+size_t growattIF::holdingJson(char *json, size_t size) const {
+  JsonWriter writer(json, size);
 
-    if (setcounter == 1) {    //register 64 -127
-      modbusdata.pv2energytoday = ((overflow << 16) | growattInterface.getResponseBuffer(64 - 64)) * 0.1;
-      modbusdata.pv2energytotal = ((growattInterface.getResponseBuffer(65 - 64) << 16) | growattInterface.getResponseBuffer(66 - 64)) * 0.1;
-
-      // Temperatures
-      modbusdata.tempinverter = growattInterface.getResponseBuffer(93 - 64) * 0.1;
-      modbusdata.tempipm = growattInterface.getResponseBuffer(94 - 64) * 0.1;
-      modbusdata.tempboost = growattInterface.getResponseBuffer(95 - 64) * 0.1;
-
-      // Diag data
-      modbusdata.ipf = growattInterface.getResponseBuffer(100 - 64);
-      modbusdata.realoppercent = growattInterface.getResponseBuffer(101 - 64);
-      modbusdata.opfullpower = ((growattInterface.getResponseBuffer(102 - 64) << 16) | growattInterface.getResponseBuffer(103 - 64)) * 0.1;
-      modbusdata.deratingmode = growattInterface.getResponseBuffer(103 - 64);
-      //  0:no derate;
-      //  1:PV;
-      //  2:*;
-      //  3:Vac;
-      //  4:Fac;
-      //  5:Tboost;
-      //  6:Tinv;
-      //  7:Control;
-      //  8:*;
-      //  9:*OverBack
-      //  ByTime;
-
-      modbusdata.faultcode = growattInterface.getResponseBuffer(105 - 64);
-      //  1~23 " Error: 99+x
-      //  24 "Auto Test
-      //  25 "No AC
-      //  26 "PV Isolation Low",
-      //  27 " Residual I
-      //  28 " Output High
-      //  29 " PV Voltage
-      //  30 " AC V Outrange
-      //  31 " AC F Outrange
-      //  32 " Module Hot
-
-
-      modbusdata.faultbitcode = ((growattInterface.getResponseBuffer(105 - 64) << 16) | growattInterface.getResponseBuffer(106 - 64));
-      //  0x00000001 %
-      //  0x00000002 Communication error
-      //  0x00000004 %
-      //  0x00000008 StrReverse or StrShort fault
-      //  0x00000010 Model Init fault
-      //  0x00000020 Grid Volt Sample diffirent
-      //  0x00000040 ISO Sample diffirent
-      //  0x00000080 GFCI Sample diffirent
-      //  0x00000100 %
-      //  0x00000200 %
-      //  0x00000400 %
-      //  0x00000800 %
-      //  0x00001000 AFCI Fault
-      //  0x00002000 %
-      //  0x00004000 AFCI Module fault
-      //  0x00008000 %
-      //  0x00010000 %
-      //  0x00020000 Relay check fault
-      //  0x00040000 %
-      //  0x00080000 %
-      //  0x00100000 %
-      //  0x00200000 Communication error
-      //  0x00400000 Bus Voltage error
-      //  0x00800000 AutoTest fail
-      //  0x01000000 No Utility
-      //  0x02000000 PV Isolation Low
-      //  0x04000000 Residual I High
-      //  0x08000000 Output High DCI
-      //  0x10000000 PV Voltage high
-      //  0x20000000 AC V Outrange
-      //  0x40000000 AC F Outrange
-      //  0x80000000 TempratureHigh
-
-      modbusdata.warningbitcode = ((growattInterface.getResponseBuffer(110 - 64) << 16) | growattInterface.getResponseBuffer(111 - 64));
-      //  0x0001 Fan warning
-      //  0x0002 String communication abnormal
-      //  0x0004 StrPIDconfig Warning
-      //  0x0008 %
-      //  0x0010 DSP and COM firmware unmatch
-      //  0x0020 %
-      //  0x0040 SPD abnormal
-      //  0x0080 GND and N connect abnormal
-      //  0x0100 PV1 or PV2 circuit short
-      //  0x0200 PV1 or PV2 boost driver broken
-      //  0x0400 %
-      //  0x0800 %
-      //  0x1000 %
-      //  0x2000 %
-      //  0x4000 %
-      //  0x8000 %
-      setcounter = 0;
-    }
-  } else {
-    return result;
+  writer.add("enable", modbussettings.enable);
+  writer.add("safetyfuncen", modbussettings.safetyfuncen);
+  writer.add("maxoutputactivepp", modbussettings.maxoutputactivepp);
+  writer.add("maxoutputreactivepp", modbussettings.maxoutputreactivepp);
+
+  writer.add("maxpower", modbussettings.maxpower, 1);
+  writer.add("voltnormal", modbussettings.voltnormal, 1);
+  writer.add("startvoltage", modbussettings.startvoltage, 1);
+  writer.add("gridvoltlowlimit", modbussettings.gridvoltlowlimit, 1);
+  writer.add("gridvolthighlimit", modbussettings.gridvolthighlimit, 1);
+  writer.add("gridfreqlowlimit", modbussettings.gridfreqlowlimit, 1);
+  writer.add("gridfreqhighlimit", modbussettings.gridfreqhighlimit, 1);
+  writer.add("gridvoltlowconnlimit", modbussettings.gridvoltlowconnlimit, 1);
+  writer.add("gridvolthighconnlimit", modbussettings.gridvolthighconnlimit, 1);
+  writer.add("gridfreqlowconnlimit", modbussettings.gridfreqlowconnlimit, 1);
+  writer.add("gridfreqhighconnlimit", modbussettings.gridfreqhighconnlimit, 1);
+
+  // Not NUL terminated
+  writer.add("firmware", modbussettings.firmware, sizeof(modbussettings.firmware));
+  writer.add("controlfirmware", modbussettings.controlfirmware, sizeof(modbussettings.controlfirmware));
+  writer.add("serial", modbussettings.serial, sizeof(modbussettings.serial));
+  writer.addHex("modulPower", modbussettings.modul, 4);
+
+  size_t len = writer.end();
+  if (writer.overflow()) {
+    log_e("JSON buffer too small");
   }
-  
+  return len;
+}
+
+uint8_t growattIF::acquire(uint32_t fields, bool holding) {
+  startAcquire(fields, 0, holding);
+  while (!isDone()) {
+    wait(poll());
+  }
+  return acqResult;
+}
+
+uint8_t growattIF::ReadInputRegisters(char* json, size_t size, uint32_t fields) {
+  uint8_t result = acquire(fields, false);
+
   #ifdef ENABLE_JSON
-    // Generate the modbus JSON string
-    sprintf(json, "{", json);
-    sprintf(json, "%s \"status\":%d,", json, modbusdata.status);
-    sprintf(json, "%s \"solarpower\":%.1f,", json, modbusdata.solarpower);
-    sprintf(json, "%s \"pv1voltage\":%.1f,", json, modbusdata.pv1voltage);
-    sprintf(json, "%s \"pv1current\":%.1f,", json, modbusdata.pv1current);
-    sprintf(json, "%s \"pv1power\":%.1f,", json, modbusdata.pv1power);
-    sprintf(json, "%s \"pv2voltage\":%.1f,", json, modbusdata.pv2voltage);
-    sprintf(json, "%s \"pv2current\":%.1f,", json, modbusdata.pv2current);
-    sprintf(json, "%s \"pv2power\":%.1f,", json, modbusdata.pv2power);
-
-    sprintf(json, "%s \"outputpower\":%.1f,", json, modbusdata.outputpower);
-    sprintf(json, "%s \"gridfrequency\":%.2f,", json, modbusdata.gridfrequency);
-    sprintf(json, "%s \"gridvoltage\":%.1f,", json, modbusdata.gridvoltage);
-
-    sprintf(json, "%s \"energytoday\":%.1f,", json, modbusdata.energytoday);
-    sprintf(json, "%s \"energytotal\":%.1f,", json, modbusdata.energytotal);
-    sprintf(json, "%s \"totalworktime\":%.1f,", json, modbusdata.totalworktime);
-    sprintf(json, "%s \"pv1energytoday\":%.1f,", json, modbusdata.pv1energytoday);
-    sprintf(json, "%s \"pv1energytotal\":%.1f,", json, modbusdata.pv1energytotal);
-    sprintf(json, "%s \"pv2energytoday\":%.1f,", json, modbusdata.pv2energytoday);
-    sprintf(json, "%s \"pv2energytotal\":%.1f,", json, modbusdata.pv2energytotal);
-    sprintf(json, "%s \"opfullpower\":%.1f,", json, modbusdata.opfullpower);
-
-    sprintf(json, "%s \"tempinverter\":%.1f,", json, modbusdata.tempinverter);
-    sprintf(json, "%s \"tempipm\":%.1f,", json, modbusdata.tempipm);
-    sprintf(json, "%s \"tempboost\":%.1f,", json, modbusdata.tempboost);
-
-    sprintf(json, "%s \"ipf\":%d,", json, modbusdata.ipf);
-    sprintf(json, "%s \"realoppercent\":%d,", json, modbusdata.realoppercent);
-    sprintf(json, "%s \"deratingmode\":%d,", json, modbusdata.deratingmode);
-    sprintf(json, "%s \"faultcode\":%d,", json, modbusdata.faultcode);
-    sprintf(json, "%s \"faultbitcode\":%d,", json, modbusdata.faultbitcode);
-    sprintf(json, "%s \"warningbitcode\":%d }", json, modbusdata.warningbitcode);
+    if (result == Success) {
+      inputJson(json, size);
+    }
   #endif
   return result;
 }
 
-uint8_t growattIF::ReadHoldingRegisters(char* json) {
-  uint8_t result;
-  //ESP.wdtDisable();
-  result = growattInterface.readHoldingRegisters(setcounter * 64, 64);
-  //ESP.wdtEnable(1);
-
-  if (result == growattInterface.ku8MBSuccess)   {
-    if (setcounter == 0) {      //register 0-63
-      modbussettings.enable = growattInterface.getResponseBuffer(0);
-      modbussettings.safetyfuncen = growattInterface.getResponseBuffer(1); // Safety Function Enabled
-      //  Bit0: SPI enable
-      //  Bit1: AutoTestStart
-      //  Bit2: LVFRT enable
-      //  Bit3: FreqDerating Enable
-      //  Bit4: Softstart enable
-      //  Bit5: DRMS enable
-      //  Bit6: Power Volt Func Enable
-      //  Bit7: HVFRT enable
-      //  Bit8: ROCOF enable
-      //  Bit9: Recover FreqDerating Mode Enable
-      //  Bit10~15: Reserved
-      modbussettings.maxoutputactivepp = growattInterface.getResponseBuffer(3); // Inverter M ax output active power percent  0-100: %, 255: not limited
-      modbussettings.maxoutputreactivepp = growattInterface.getResponseBuffer(4); // Inverter M ax output reactive power percent  0-100: %, 255: not limited
-      modbussettings.maxpower = ((growattInterface.getResponseBuffer(6) << 16) | growattInterface.getResponseBuffer(7)) * 0.1;
-      modbussettings.voltnormal = growattInterface.getResponseBuffer(8) * 0.1;
-      //strncpy(modbussettings.firmware, "      ", 6);
-      modbussettings.firmware[0] = growattInterface.getResponseBuffer(9) >> 8;
-      modbussettings.firmware[1] = growattInterface.getResponseBuffer(9) & 0xff;
-      modbussettings.firmware[2] = growattInterface.getResponseBuffer(10) >> 8;
-      modbussettings.firmware[3] = growattInterface.getResponseBuffer(10) & 0xff;
-      modbussettings.firmware[4] = growattInterface.getResponseBuffer(11) >> 8;
-      modbussettings.firmware[5] = growattInterface.getResponseBuffer(11) & 0xff;
-
-      //strncpy(modbussettings.controlfirmware, "      ", 6);
-      modbussettings.controlfirmware[0] = growattInterface.getResponseBuffer(12) >> 8;
-      modbussettings.controlfirmware[1] = growattInterface.getResponseBuffer(12) & 0xff;
-      modbussettings.controlfirmware[2] = growattInterface.getResponseBuffer(13) >> 8;
-      modbussettings.controlfirmware[3] = growattInterface.getResponseBuffer(13) & 0xff;
-      modbussettings.controlfirmware[4] = growattInterface.getResponseBuffer(14) >> 8;
-      modbussettings.controlfirmware[5] = growattInterface.getResponseBuffer(14) & 0xff;
-
-      modbussettings.startvoltage = growattInterface.getResponseBuffer(17) * 0.1;
-
-      //strncpy(modbussettings.serial, "          ", 10);
-      modbussettings.serial[0] = growattInterface.getResponseBuffer(23) >> 8;
-      modbussettings.serial[1] = growattInterface.getResponseBuffer(23) & 0xff;
-      modbussettings.serial[2] = growattInterface.getResponseBuffer(24) >> 8;
-      modbussettings.serial[3] = growattInterface.getResponseBuffer(24) & 0xff;
-      modbussettings.serial[4] = growattInterface.getResponseBuffer(25) >> 8;
-      modbussettings.serial[5] = growattInterface.getResponseBuffer(25) & 0xff;
-      modbussettings.serial[6] = growattInterface.getResponseBuffer(26) >> 8;
-      modbussettings.serial[7] = growattInterface.getResponseBuffer(26) & 0xff;
-      modbussettings.serial[8] = growattInterface.getResponseBuffer(27) >> 8;
-      modbussettings.serial[9] = growattInterface.getResponseBuffer(27) & 0xff;
-
-      modbussettings.gridvoltlowlimit = growattInterface.getResponseBuffer(52) * 0.1;
-      modbussettings.gridvolthighlimit = growattInterface.getResponseBuffer(53) * 0.1;
-      modbussettings.gridfreqlowlimit = growattInterface.getResponseBuffer(54) * 0.01;
-      modbussettings.gridfreqhighlimit = growattInterface.getResponseBuffer(55) * 0.01;
-      setcounter ++;
-      return Continue;
+uint8_t growattIF::ReadHoldingRegisters(char* json, size_t size, uint32_t fields) {
+  uint8_t result = acquire(fields, true);
+
+  #ifdef ENABLE_JSON
+    if (result == Success) {
+      holdingJson(json, size);
     }
-    if (setcounter == 1) {      //register 64 -127
-      modbussettings.gridvoltlowconnlimit = growattInterface.getResponseBuffer(64 - 64) * 0.1;
-      modbussettings.gridvolthighconnlimit = growattInterface.getResponseBuffer(65 - 64) * 0.1;
-      modbussettings.gridfreqlowconnlimit = growattInterface.getResponseBuffer(66 - 64) * 0.01;
-      modbussettings.gridfreqhighconnlimit = growattInterface.getResponseBuffer(67 - 64) * 0.01;
-
-      modbussettings.modul = growattInterface.getResponseBuffer(121 - 64);
-      setcounter ++;
-      return Continue;
+  #endif
+  return result;
+}
+
+// Modbus RTU CRC-16 (polynomial 0xA001, init 0xFFFF); the CRC of a frame including its CRC is 0
+static uint16_t crcUpdate(uint16_t crc, uint8_t data) {
+  crc ^= data;
+  for (int b = 0; b < 8; b++) {
+    crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+  }
+  return crc;
+}
+
+static uint16_t modbusCrc(const uint8_t *data, size_t size) {
+  uint16_t crc = 0xFFFF;
+
+  for (size_t i = 0; i < size; i++) {
+    crc = crcUpdate(crc, data[i]);
+  }
+  return crc;
+}
+
+// Modbus RTU inter-frame gap: 3.5 characters of 11 bits, fixed 1750 µs above 19200 baud
+uint32_t growattIF::frameGap() const {
+  return (baudRate > 19200) ? 1750 : 38500000UL / baudRate;
+}
+
+// Time [ms] for transmission of <bytes>, at least 1 ms
+static uint32_t wireTime(uint32_t bytes, uint32_t baudRate) {
+  return bytes * 11000UL / baudRate + 1;
+}
+
+uint8_t growattIF::planRead(uint32_t fields, bool holding, GrowattRange *ranges) {
+  if (holding) {
+    return growatt_plan(holdingMap.reg, holdingMap.size, fields, GROWATT_READ_MAX, GROWATT_READ_GAP, ranges, GW_MAX_RANGES);
+  }
+  return growatt_plan(inputMap.reg, inputMap.size, fields & GROWATT_INPUT_FIELDS, GROWATT_READ_MAX, GROWATT_READ_GAP, ranges, GW_MAX_RANGES);
+}
+
+void growattIF::startAcquire(uint32_t fields, uint8_t retries, bool holding) {
+  acqHolding = holding;
+  acqRetries = retries;
+  acqResult = Success;
+  setcounter = 0;
+  carry.count = 0;
+
+  if (holding) {
+    loadSettings();
+    planFields = growatt_stale(holdingMap.reg, holdingMap.size, fields, holdingCache[slaveIndex].age);
+    planSize = growatt_plan(holdingMap.reg, holdingMap.size, planFields, GROWATT_READ_MAX, GROWATT_READ_GAP, plan, GW_MAX_RANGES);
+  } else {
+    fields &= GROWATT_INPUT_FIELDS;
+    cacheLoad(inputCache[slaveIndex], modbusdata);
+    planFields = growatt_stale(inputMap.reg, inputMap.size, fields, inputCache[slaveIndex].age);
+    planSize = growatt_plan(inputMap.reg, inputMap.size, planFields, GROWATT_READ_MAX, GROWATT_READ_GAP, plan, GW_MAX_RANGES);
+  }
+  acqFields = fields;
+  if (planSize == 0) {
+    finishAcquire(Success);
+    return;
+  }
+  acqProbe = breakerOpen();
+  if (acqProbe) {
+    // Single request with short timeout; the acquisition is continued normally if the inverter responds
+    log_d("Circuit breaker open (slave %u) - probing", slaveId);
+    probeRetries = acqRetries;
+    acqRetries = 0;
+  }
+
+  // Line must have been idle for at least one frame gap (and the interface settled after initGrowatt())
+  uint32_t settled = initTime + MODBUS_SETTLE_TIME * 1000UL;
+  deadline = micros() + frameGap();
+  if ((int32_t)(settled - deadline) > 0) {
+    deadline = settled;
+  }
+  acqState = AcqSettle;
+}
+
+uint32_t growattIF::poll() {
+  uint32_t now = micros();
+
+  switch (acqState) {
+    case AcqSettle:
+    case AcqGap:
+    case AcqBackoff:
+      if ((int32_t)(deadline - now) > 0) {
+        return (deadline - now + 999) / 1000;
+      }
+      sendRequest();
+      return wireTime(rxExpected, baudRate);
+
+    case AcqReceive:
+#if defined(MODBUS_UART_EVENTS)
+    {
+      RX_LOCK();
+      bool done = rxDone;
+      bool expired = !done && ((int32_t)(now - deadline) >= 0);
+      if (expired) {
+        rxSeq++;                                 // reject a response handed over from now on
+      }
+      RX_UNLOCK();
+      if (done) {
+        finishTransaction(checkResponse());
+        return 0;
+      }
+      if (expired) {
+        finishTransaction(ModbusMaster::ku8MBResponseTimedOut);
+        return 0;
+      }
     }
-    if (setcounter == 2) {      //register 128-191
-      //          //          modbussettings.modul = growattInterface.getResponseBuffer(130 - 128);
-      setcounter = 0;
+#else
+      while ((rxSize < rxExpected) && (serial->available() > 0)) {
+        uint8_t c = serial->read();
+        rxFrame[rxSize++] = c;
+        rxCrc = crcUpdate(rxCrc, c);
+        if ((rxSize == 2) && (c & 0x80)) {
+          rxExpected = 5;                        // exception response
+        }
+#if defined(MODBUS_CAPTURE)
+        capture[captureHead].rxLast = micros();
+        if (rxSize == 1) {
+          capture[captureHead].rxFirst = capture[captureHead].rxLast;
+        }
+#endif
+      }
+      if (rxSize >= rxExpected) {
+        finishTransaction(checkResponse());
+        return 0;
+      }
+      if ((int32_t)(now - deadline) >= 0) {
+        finishTransaction(ModbusMaster::ku8MBResponseTimedOut);
+        return 0;
+      }
+#endif
+#if defined(MODBUS_UART_EVENTS) && defined(ESP32)
+      return (deadline - now + 999) / 1000;      // wait() returns at end of frame
+#else
+      return min(wireTime(rxExpected - rxSize, baudRate), (deadline - now + 999) / 1000);
+#endif
+
+    default:
+      return 0;
+  }
+}
+
+void growattIF::sendRequest() {
+  const GrowattRange &range = plan[setcounter];
+  uint8_t req[8];
+
+  req[0] = slaveId;
+  req[1] = acqHolding ? 0x03 : 0x04;             // read holding / input registers
+  req[2] = range.start >> 8;
+  req[3] = range.start & 0xff;
+  req[4] = range.count >> 8;
+  req[5] = range.count & 0xff;
+  uint16_t crc = modbusCrc(req, 6);
+  req[6] = crc & 0xff;
+  req[7] = crc >> 8;
+
+  // Discard unsolicited data, e.g. late response to a timed out request
+  while (serial->read() >= 0) {
+  }
+  RX_LOCK();
+  rxSize = 0;
+  rxExpected = 5 + 2 * range.count;
+  rxCrc = 0xFFFF;
+  rxDone = false;
+  rxSeq++;                                       // reject a late handoff of the previous response
+  acqState = AcqReceive;
+  RX_UNLOCK();
+#if defined(MODBUS_UART_EVENTS) && defined(ESP32)
+  xSemaphoreTake(rxEvent, 0);                    // discard stale event
+#endif
+
+  txTime = micros();
+  preTransmission();
+  serial->write(req, sizeof(req));
+  serial->flush();
+  postTransmission();
+#if defined(MODBUS_CAPTURE)
+  ModbusCapture &cap = capture[captureHead];
+  cap.txStart = txTime;
+  cap.txEnd = micros();
+  cap.rxFirst = 0;
+  cap.rxLast = 0;
+  cap.reqSize = sizeof(req);
+  memcpy(cap.req, req, sizeof(req));
+#endif
+  if (acqProbe) {
+    deadline = micros() + (wireTime(rxExpected, baudRate) + MODBUS_PROBE_TIMEOUT) * 1000UL;
+  } else {
+    deadline = micros() + MODBUS_RESPONSE_TIMEOUT * 1000UL;
+  }
+}
+
+#if defined(MODBUS_UART_EVENTS)
+// Called in UART event task context at the end of a frame (RX timeout);
+// the frame is read into a local buffer and handed over to poll() in a critical section
+void growattIF::onUartReceive() {
+  RX_LOCK();
+  bool waiting = (acqState == AcqReceive) && !rxDone;
+  uint8_t seq = rxSeq;
+  RX_UNLOCK();
+  if (!waiting) {
+    // Not waiting for a response - leave the data to the blocking ModbusMaster functions
+    // (e.g. readRegister(), writeRegister()); sendRequest() discards unsolicited data
+    return;
+  }
+  uint8_t frame[sizeof(rxFrame)];
+  uint8_t size = 0;
+  uint16_t crc = 0xFFFF;
+  while ((serial->available() > 0) && (size < sizeof(frame))) {
+    uint8_t c = serial->read();
+    frame[size++] = c;
+    crc = crcUpdate(crc, c);
+  }
+  if (size == 0) {
+    return;
+  }
+#if defined(MODBUS_CAPTURE)
+  uint32_t rxTime = micros();
+#endif
+  RX_LOCK();
+  // poll() may have timed out (or sendRequest() started the next transaction) meanwhile
+  bool handoff = (seq == rxSeq) && (acqState == AcqReceive) && !rxDone;
+  if (handoff) {
+    memcpy(rxFrame, frame, size);
+    rxSize = size;
+    rxCrc = crc;
+#if defined(MODBUS_CAPTURE)
+    capture[captureHead].rxFirst = capture[captureHead].rxLast = rxTime;
+#endif
+    rxDone = true;
+  }
+  RX_UNLOCK();
+#if defined(ESP32)
+  if (handoff) {
+    xSemaphoreGive(rxEvent);
+  }
+#endif
+}
+#else
+void growattIF::onUartReceive() {
+}
+#endif
+
+void growattIF::wait(uint32_t ms) {
+#if defined(MODBUS_UART_EVENTS) && defined(ESP32)
+  if (acqState == AcqReceive) {
+    xSemaphoreTake(rxEvent, pdMS_TO_TICKS(ms));
+    return;
+  }
+#endif
+  delay(ms);
+}
+
+uint8_t growattIF::checkResponse() {
+  uint8_t function = acqHolding ? 0x03 : 0x04;
+  uint8_t count = 2 * plan[setcounter].count;
+
+  if ((rxSize < 5) || (rxCrc != 0)) {
+    return ModbusMaster::ku8MBInvalidCRC;
+  }
+  if (rxFrame[0] != slaveId) {
+    return ModbusMaster::ku8MBInvalidSlaveID;
+  }
+  if (rxFrame[1] == (function | 0x80)) {
+    return rxFrame[2];                           // exception code
+  }
+  if ((rxFrame[1] != function) || (rxFrame[2] != count) || (rxSize != 5 + count)) {
+    return ModbusMaster::ku8MBInvalidFunction;
+  }
+  return Success;
+}
+
+void growattIF::finishTransaction(uint8_t result) {
+  if (transactionCallback) {
+    transactionCallback(result, (micros() - txTime) / 1000);
+  }
+#if defined(MODBUS_CAPTURE)
+  ModbusCapture &cap = capture[captureHead];
+  cap.result = result;
+  cap.rspSize = rxSize;
+  memcpy(cap.rsp, rxFrame, rxSize);
+  captureHead = (captureHead + 1) % MODBUS_CAPTURE_SIZE;
+  if (capturePending < MODBUS_CAPTURE_SIZE) {
+    capturePending++;
+  } else {
+    captureOverrun++;
+  }
+#endif
+  updateBreaker(result);
+  if (acqProbe && (result != ModbusMaster::ku8MBResponseTimedOut)) {
+    acqProbe = false;
+    acqRetries = probeRetries;
+  }
+
+  if (result == Success) {
+    const GrowattRange &range = plan[setcounter];
+    uint16_t regs[GROWATT_READ_MAX];
+
+    for (uint16_t i = 0; i < range.count; i++) {
+      regs[i] = (rxFrame[3 + 2 * i] << 8) | rxFrame[4 + 2 * i];
+    }
+    if (acqHolding) {
+      growatt_decode(holdingMap.reg, holdingMap.size, planFields, range.start, range.count, regs, &modbussettings, carry);
+    } else {
+      growatt_decode(inputMap.reg, inputMap.size, planFields, range.start, range.count, regs, &modbusdata, carry);
+    }
+    if (++setcounter < planSize) {
+      acqState = AcqGap;
+      deadline = micros() + frameGap();
+    } else {
+      finishAcquire(Success);
     }
+  } else if (acqRetries > 0) {
+    acqRetries--;
+    acqState = AcqBackoff;
+    deadline = micros() + max(frameGap(), (uint32_t)(MODBUS_BACKOFF * 1000UL));
   } else {
-    return result;
+    finishAcquire(result);
   }
-  
-  #ifdef ENABLE_JSON
-    // Generate the modbus JSON string
-    sprintf(json, "{", json);
-    sprintf(json, "%s \"enable\":%d,", json, modbussettings.enable);
-    sprintf(json, "%s \"safetyfuncen\":%d,", json, modbussettings.safetyfuncen);
-    sprintf(json, "%s \"maxoutputactivepp\":%d,", json, modbussettings.maxoutputactivepp);
-    sprintf(json, "%s \"maxoutputreactivepp\":%d,", json, modbussettings.maxoutputreactivepp);
-
-    sprintf(json, "%s \"maxpower\":%.1f,", json, modbussettings.maxpower);
-    sprintf(json, "%s \"voltnormal\":%.1f,", json, modbussettings.voltnormal);
-    sprintf(json, "%s \"startvoltage\":%.1f,", json, modbussettings.startvoltage);
-    sprintf(json, "%s \"gridvoltlowlimit\":%.1f,", json, modbussettings.gridvoltlowlimit);
-    sprintf(json, "%s \"gridvolthighlimit\":%.1f,", json, modbussettings.gridvolthighlimit);
-    sprintf(json, "%s \"gridfreqlowlimit\":%.1f,", json, modbussettings.gridfreqlowlimit);
-    sprintf(json, "%s \"gridfreqhighlimit\":%.1f,", json, modbussettings.gridfreqhighlimit);
-    sprintf(json, "%s \"gridvoltlowconnlimit\":%.1f,", json, modbussettings.gridvoltlowconnlimit);
-    sprintf(json, "%s \"gridvolthighconnlimit\":%.1f,", json, modbussettings.gridvolthighconnlimit);
-    sprintf(json, "%s \"gridfreqlowconnlimit\":%.1f,", json, modbussettings.gridfreqlowconnlimit);
-    sprintf(json, "%s \"gridfreqhighconnlimit\":%.1f,", json, modbussettings.gridfreqhighconnlimit);
-
-    sprintf(json, "%s \"firmware\":\"%s\",", json, modbussettings.firmware);
-    sprintf(json, "%s \"controlfirmware\":\"%s\",", json, modbussettings.controlfirmware);
-    sprintf(json, "%s \"serial\":\"%s\",", json, modbussettings.serial);
-    sprintf(json, "%s \"modulPower\":\"%04X\" }", json, modbussettings.modul);
-  #endif
-  return result;
 }
 
+void growattIF::finishAcquire(uint8_t result) {
+  acqResult = result;
+  acqState = AcqDone;
+  setcounter = 0;
+  if (result != Success) {
+    return;
+  }
+  if (acqHolding) {
+    cacheStore(holdingCache[slaveIndex], modbussettings, acqFields, planFields);
+    storeSettings();
+  } else {
+    checkSettingsHint();
+    cacheStore(inputCache[slaveIndex], modbusdata, acqFields, planFields);
+  }
+}
+
+#if defined(MODBUS_CAPTURE)
+unsigned growattIF::dumpCapture(Print &out) {
+  static const char hex[] = "0123456789ABCDEF";
+  // "MODBUS: " + (header + request + response) x "XX " + "\r\n"
+  char line[8 + 3 * (19 + sizeof(ModbusCapture::req) + sizeof(ModbusCapture::rsp)) + 2];
+  unsigned count = capturePending;
+  unsigned idx = (captureHead + MODBUS_CAPTURE_SIZE - count) % MODBUS_CAPTURE_SIZE;
+
+  memcpy(line, "MODBUS: ", 8);
+  for (unsigned i = 0; i < count; i++) {
+    const ModbusCapture &cap = capture[idx];
+    uint8_t header[19];
+    const uint32_t times[] = {cap.txStart, cap.txEnd, cap.rxFirst, cap.rxLast};
+
+    for (size_t t = 0; t < 4; t++) {
+      for (size_t b = 0; b < 4; b++) {
+        header[4 * t + b] = (times[t] >> (8 * b)) & 0xff;
+      }
+    }
+    header[16] = cap.result;
+    header[17] = cap.reqSize;
+    header[18] = cap.rspSize;
+
+    const uint8_t *parts[] = {header, cap.req, cap.rsp};
+    const size_t sizes[] = {sizeof(header), cap.reqSize, cap.rspSize};
+    char *p = &line[8];
+    for (size_t n = 0; n < 3; n++) {
+      for (size_t b = 0; b < sizes[n]; b++) {
+        *p++ = hex[parts[n][b] >> 4];
+        *p++ = hex[parts[n][b] & 0xF];
+        *p++ = ' ';
+      }
+    }
+    *p++ = '\r';
+    *p++ = '\n';
+    out.write(reinterpret_cast<const uint8_t *>(line), p - line);
+    idx = (idx + 1) % MODBUS_CAPTURE_SIZE;
+  }
+  capturePending = 0;
+  return count;
+}
+#endif
+
 String growattIF::sendModbusError(uint8_t result) {
   String message = "";
   if (result == growattInterface.ku8MBIllegalFunction) {
@@ -4,29 +4,109 @@
 //
 // 20230313 matthias-bs Replaced SoftwareSerial by HardwareSerial
 // 20230408 Added different Modbus data rates for RS485 and USB
+// 20261017 Added register map decoding (see growattRegisters.h)
+//          Added field set parameter to ReadInputRegisters()/ReadHoldingRegisters()
+//          Added register cache in RTC memory
+//          Added non-blocking acquisition startAcquire()/poll()/isDone()
+//          Added event-driven reception (MODBUS_UART_EVENTS) and wait()
+//          Added RS485 direction control by the UART (MODBUS_RS485_HALF_DUPLEX)
+//          Added selectSlave() for multiple inverters on the RS485 bus
+//          Added family specific input registers (GROWATT_FAMILY)
+//          Added settings snapshot loadSettings()/settingsChanged()
+//          Added circuit breaker breakerOpen()
+//          Added inputJson()/holdingJson() and JSON buffer size parameter
+//          Added readRegister() with result code
+//          Added raw Modbus transaction capture (MODBUS_CAPTURE)
+//          ReadInputRegisters()/ReadHoldingRegisters() based on startAcquire()/poll()
+//          Added rxSeq (response handoff from the UART event task)
 #ifndef GROWATTINTERFACE_H
 #define GROWATTINTERFACE_H
 
 #include "Arduino.h"
 #include <ModbusMaster.h>            // Modbus master library for ESP8266 by Doc Walker (https://github.com/4-20ma/ModbusMaster)
+#include "growattRegisters.h"
 #define SLAVE_ID                 1   // Default slave ID of Growatt
 #define MODBUS_RATE_RS485     9600   // Growatt Modbus data rate over RS485
 #define MODBUS_RATE_USB     115200   // Growatt Modbus data rate over USB 
 
+#if defined(MODBUS_CAPTURE) && !defined(MODBUS_CAPTURE_SIZE)
+#define MODBUS_CAPTURE_SIZE 16               // no. of captured transactions (~160 bytes each) in RAM
+#endif
+
 class growattIF {
 
   private:
     ModbusMaster growattInterface;
     //SoftwareSerial *serial;
-    HardwareSerial *serial;
+    HardwareSerial *serial = nullptr;
     void preTransmission();
     void postTransmission();
     int PinMAX485_RE_NEG;
     int PinMAX485_DE;
     int PinMAX485_RX;
     int PinMAX485_TX;
+    bool hwDirection = false;   // RS485 direction controlled by the UART (RTS)
+    uint8_t slaveId = SLAVE_ID;
+    uint8_t slaveIndex = 0;     // index of the inverter's register cache
     int setcounter = 0;
-    int overflow;
+    GrowattRange plan[GW_MAX_RANGES];
+    uint8_t planSize = 0;
+    uint32_t planFields = 0;
+    GrowattCarry carry = {};
+
+    // Non-blocking acquisition
+    enum AcqState : uint8_t { AcqIdle, AcqSettle, AcqSend, AcqReceive, AcqGap, AcqBackoff, AcqDone };
+    AcqState acqState = AcqIdle;
+    bool acqHolding = false;
+    uint8_t acqResult = Success;
+    uint8_t acqRetries = 0;
+    bool acqProbe = false;             // circuit breaker open - probe request
+    uint8_t probeRetries = 0;          // retries after successful probe
+    uint32_t acqFields = 0;
+    uint32_t baudRate = MODBUS_RATE_RS485;
+    uint32_t initTime = 0;
+    uint32_t deadline = 0;             // end of current wait [µs]
+    uint32_t txTime = 0;               // start of current transaction [µs]
+    uint8_t rxFrame[5 + 2 * GROWATT_READ_MAX];
+    uint8_t rxSize = 0;
+    uint8_t rxExpected = 0;
+    uint16_t rxCrc = 0;                // CRC of data received so far
+    volatile bool rxDone = false;      // frame end detected (MODBUS_UART_EVENTS)
+    uint8_t rxSeq = 0;                 // transaction sequence - rejects late handoffs (MODBUS_UART_EVENTS)
+    void onUartReceive();
+    void (*transactionCallback)(uint8_t result, uint32_t duration) = nullptr;
+    uint32_t frameGap() const;
+    void sendRequest();
+    uint8_t checkResponse();
+    void finishTransaction(uint8_t result);
+    void finishAcquire(uint8_t result);
+    uint8_t acquire(uint32_t fields, bool holding);
+#if defined(MODBUS_CAPTURE)
+    struct ModbusCapture
+    {
+      uint32_t txStart;                        // request transmission started [µs]
+      uint32_t txEnd;                          // request transmitted (UART flushed) [µs]
+      uint32_t rxFirst;                        // first response byte read [µs]
+      uint32_t rxLast;                         // last response byte read [µs]
+      uint8_t result;                          // Success or Modbus error code
+      uint8_t reqSize;
+      uint8_t rspSize;
+      uint8_t req[8];
+      uint8_t rsp[5 + 2 * GROWATT_READ_MAX];
+    };
+    ModbusCapture capture[MODBUS_CAPTURE_SIZE];  // RAM ring, lost in deep sleep
+    uint8_t captureHead = 0;                   // next record to be written
+    uint8_t capturePending = 0;                // records not dumped yet
+    uint32_t captureOverrun = 0;
+#endif
+
+    // Settings snapshot
+    uint16_t changedSettings = 0;      // bit n: snapshot of inverter n has changed
+    void storeSettings();
+    void checkSettingsHint();
+
+    // Circuit breaker
+    void updateBreaker(uint8_t result);
 
   public:
     struct modbus_input_registers
@@ -36,6 +116,12 @@ class growattIF {
       float energytoday, energytotal, totalworktime, pv1energytoday, pv1energytotal, pv2energytoday, pv2energytotal, opfullpower;
       float tempinverter, tempipm, tempboost;
       int ipf, realoppercent, deratingmode, faultcode, faultbitcode, warningbitcode;
+#if GROWATT_FAMILY == GW_FAMILY_MOD
+      float gridvoltage2, gridvoltage3;
+#elif GROWATT_FAMILY == GW_FAMILY_SPH
+      float dischargepower, chargepower, batteryvoltage;
+      int soc;
+#endif
     };
     struct modbus_input_registers modbusdata;
 
@@ -51,12 +137,194 @@ class growattIF {
 
     growattIF(int _PinMAX485_RE_NEG, int _PinMAX485_DE, int _PinMAX485_RX, int _PinMAX485_TX);
     void initGrowatt();
+
+    /*!
+     * \brief Select the inverter addressed by the following requests
+     *
+     * Several inverters with different slave IDs can share the RS485 bus;
+     * each one has its own register cache. The UART is not re-initialized,
+     * so the inverters can be read back-to-back.
+     *
+     * \param index  inverter index (0...GROWATT_MAX_INVERTERS-1)
+     * \param id     Modbus slave ID
+     */
+    void selectSlave(uint8_t index, uint8_t id);
+
+    /*!
+     * \brief Load the settings snapshot of the selected inverter into modbussettings
+     *
+     * Without Modbus traffic - from the register cache or, after power-on,
+     * from NVS (GROWATT_SETTINGS_NVS). The snapshot (GROWATT_SETTINGS_FIELDS)
+     * is updated by each acquisition of holding registers.
+     *
+     * \returns true if a snapshot is available
+     */
+    bool loadSettings();
+
+    /*!
+     * \brief Check if the settings snapshot of the selected inverter has changed
+     *
+     * Set by an acquisition of holding registers which has changed the
+     * snapshot, cleared by this call.
+     */
+    bool settingsChanged();
+
     uint8_t writeRegister(uint16_t reg, uint16_t message);
     uint16_t readRegister(uint16_t reg);
-    uint8_t ReadInputRegisters(char* json);
-    uint8_t ReadHoldingRegisters(char* json);
+
+    /*!
+     * \brief Read a single holding register
+     *
+     * \param reg    register address
+     * \param value  register value (only valid on success)
+     *
+     * \returns Modbus result code
+     */
+    uint8_t readRegister(uint16_t reg, uint16_t &value);
+
+    /*!
+     * \brief Read input registers (blocking)
+     *
+     * Runs startAcquire() (without retries) and poll()/wait() until isDone().
+     * Never returns Continue - kept for callers which repeat the call until
+     * the result is not Continue.
+     *
+     * \param json    output buffer (ENABLE_JSON)
+     * \param size    size of <json>
+     * \param fields  field set (GrowattInputField bits)
+     *
+     * \returns Modbus result code
+     */
+    uint8_t ReadInputRegisters(char* json, size_t size, uint32_t fields = GW_INPUT_ALL);
+
+    /*!
+     * \brief Read holding registers (blocking, see ReadInputRegisters())
+     */
+    uint8_t ReadHoldingRegisters(char* json, size_t size, uint32_t fields = GW_HOLDING_ALL);
+
+    /*!
+     * \brief Write modbusdata as JSON object (ReadInputRegisters() with ENABLE_JSON)
+     *
+     * Single pass, bounded by <size> (see utils/jsonwriter.h)
+     *
+     * \param json  output buffer
+     * \param size  size of <json>
+     *
+     * \returns length of the JSON string (0: buffer too small)
+     */
+    size_t inputJson(char *json, size_t size) const;
+
+    /*!
+     * \brief Write modbussettings as JSON object (ReadHoldingRegisters() with ENABLE_JSON)
+     *
+     * \param json  output buffer
+     * \param size  size of <json>
+     *
+     * \returns length of the JSON string (0: buffer too small)
+     */
+    size_t holdingJson(char *json, size_t size) const;
     String sendModbusError(uint8_t result);
 
+    /*!
+     * \brief Start non-blocking acquisition of input (or holding) registers
+     *
+     * Reads all stale fields of <fields> (see register cache) with the planned
+     * requests; a failed request is repeated up to <retries> times in total.
+     * Call poll() until isDone(), then get the result with acquireResult().
+     *
+     * \param fields   field set (GrowattInputField or GrowattHoldingField bits)
+     * \param retries  max. no. of repeated requests
+     * \param holding  false: input registers, true: holding registers
+     */
+    void startAcquire(uint32_t fields, uint8_t retries, bool holding = false);
+
+    /*!
+     * \brief Advance the acquisition
+     *
+     * Never waits except for the transmission of a request frame.
+     *
+     * \returns time until the next event [ms] - the caller may do other work
+     *          or sleep that long before calling poll() again
+     */
+    uint32_t poll();
+
+    /*!
+     * \brief Wait for the next acquisition event
+     *
+     * With MODBUS_UART_EVENTS on ESP32, returns as soon as a response frame
+     * has been received, otherwise after <ms>.
+     *
+     * \param ms  max. time to wait [ms] (return value of poll())
+     */
+    void wait(uint32_t ms);
+
+    /*!
+     * \brief Check if the acquisition is complete
+     */
+    bool isDone() const { return (acqState == AcqDone) || (acqState == AcqIdle); }
+
+    /*!
+     * \brief Check if the circuit breaker of the selected inverter is open
+     *
+     * The breaker opens after MODBUS_BREAKER_THRESHOLD consecutive response
+     * timeouts (kept in RTC memory) and closes on the next response. While it
+     * is open, an acquisition only sends a single probe request with a short
+     * timeout (MODBUS_PROBE_TIMEOUT) and is continued normally if the inverter
+     * responds.
+     */
+    bool breakerOpen() const;
+
+#if defined(MODBUS_CAPTURE)
+    /*!
+     * \brief Dump captured Modbus transactions which have not been dumped yet
+     *
+     * Each request/response pair of an acquisition is captured in a RAM ring
+     * of MODBUS_CAPTURE_SIZE records. One line per transaction:
+     * "MODBUS: <hex>" with
+     *
+     * | txStart | txEnd | rxFirst | rxLast | result | reqSize | rspSize | request | response |
+     * |---------|-------|---------|--------|--------|---------|---------|---------|----------|
+     * | 4       | 4     | 4       | 4      | 1      | 1       | 1       | reqSize | rspSize  |
+     *
+     * Times are micros() (esp_timer on ESP32) since wake-up, little endian.
+     * Response bytes are read by poll(), so rxFirst/rxLast are the times
+     * of the first/last read; with MODBUS_UART_EVENTS, both are the time of
+     * the end of frame event. Use extras/host/tools/gw_modbus to analyze a
+     * dump or gw_transmitter_host --replay to replay it.
+     *
+     * \param out  output stream
+     *
+     * \returns number of transactions dumped
+     */
+    unsigned dumpCapture(Print &out);
+
+    /// Get number of transactions lost due to ring buffer overrun (not dumped in time)
+    uint32_t captureLost() const { return captureOverrun; }
+#endif
+
+    /*!
+     * \brief Get the result of the acquisition (Success or Modbus error code)
+     */
+    uint8_t acquireResult() const { return acqResult; }
+
+    /*!
+     * \brief Set callback invoked after each Modbus transaction of an acquisition
+     *
+     * \param callback  function(result, duration [ms])
+     */
+    void onTransaction(void (*callback)(uint8_t result, uint32_t duration)) { transactionCallback = callback; }
+
+    /*!
+     * \brief Get the read requests for a field set (without register cache)
+     *
+     * \param fields   field set
+     * \param holding  false: input registers, true: holding registers
+     * \param ranges   planned ranges, at least GW_MAX_RANGES entries
+     *
+     * \returns no. of ranges
+     */
+    static uint8_t planRead(uint32_t fields, bool holding, GrowattRange *ranges);
+
     // Error codes
     static const uint8_t Success    = 0x00;
     static const uint8_t Continue   = 0xFF;
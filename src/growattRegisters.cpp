@@ -0,0 +1,203 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// growattRegisters.cpp
+//
+// Declarative Growatt Modbus register map and generic register decoder
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//          Added read planner growatt_plan()
+//          Added per-field TTL (growatt_stale()/growatt_age())
+//          Fields of the map entries given by GrowattRegister::field (see growatt_select())
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include "growattRegisters.h"
+
+uint32_t growatt_stale(const GrowattRegister *map, size_t size, uint32_t fields, const uint8_t *age)
+{
+    uint32_t stale = 0;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        uint8_t f = map[i].field;
+        if ((fields & GW_FIELD(f)) && ((age[f] == GW_AGE_UNKNOWN) || (age[f] >= map[i].ttl)))
+        {
+            stale |= GW_FIELD(f);
+        }
+    }
+    return stale;
+}
+
+void growatt_age(size_t size, uint32_t fields, uint32_t refreshed, uint8_t *age)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if (refreshed & GW_FIELD(i))
+        {
+            age[i] = 0;
+        }
+        else if ((fields & GW_FIELD(i)) && (age[i] < GW_AGE_UNKNOWN - 1))
+        {
+            age[i]++;
+        }
+    }
+}
+
+uint8_t growatt_plan(const GrowattRegister *map, size_t size, uint32_t fields,
+                     uint16_t maxCount, uint16_t maxGap,
+                     GrowattRange *ranges, uint8_t maxRanges)
+{
+    uint8_t order[32];
+    uint8_t n = 0;
+
+    // Selected fields sorted by address (insertion sort, the maps are mostly sorted)
+    for (size_t i = 0; (i < size) && (i < 32); i++)
+    {
+        if (!(fields & GW_FIELD(map[i].field)))
+        {
+            continue;
+        }
+        uint8_t k = n++;
+        while ((k > 0) && (map[order[k - 1]].addr > map[i].addr))
+        {
+            order[k] = order[k - 1];
+            k--;
+        }
+        order[k] = i;
+    }
+
+    uint8_t count = 0;
+    for (uint8_t j = 0; j < n; j++)
+    {
+        const GrowattRegister &reg = map[order[j]];
+        uint16_t end = reg.addr + reg.words;
+        if (count > 0)
+        {
+            GrowattRange &r = ranges[count - 1];
+            uint16_t rangeEnd = r.start + r.count;
+            if (end <= rangeEnd)
+            {
+                continue;
+            }
+            if ((reg.addr <= rangeEnd + maxGap) && (end - r.start <= maxCount))
+            {
+                r.count = end - r.start;
+                continue;
+            }
+        }
+        if (count == maxRanges)
+        {
+            log_e("Read plan exceeds %u requests", maxRanges);
+            break;
+        }
+        ranges[count].start = reg.addr;
+        ranges[count].count = reg.words;
+        count++;
+    }
+    return count;
+}
+
+void growatt_decode(const GrowattRegister *map, size_t size, uint32_t fields,
+                    uint16_t start, uint16_t count, const uint16_t *regs,
+                    void *record, GrowattCarry &carry)
+{
+    const uint32_t end = (uint32_t)start + count;
+    uint8_t *rec = static_cast<uint8_t *>(record);
+
+    for (size_t i = 0; i < size; i++)
+    {
+        const GrowattRegister &reg = map[i];
+        if (!(fields & GW_FIELD(reg.field)))
+        {
+            continue;
+        }
+        if ((reg.addr + reg.words <= start) || (reg.addr >= end))
+        {
+            continue;
+        }
+
+        uint16_t w[GW_MAX_FIELD_WORDS];
+        uint8_t n = 0;
+        if (reg.addr < start)
+        {
+            // Continued from the previous block
+            if ((carry.count == 0) || (carry.addr != reg.addr) || (reg.addr + carry.count != start))
+            {
+                continue;
+            }
+            memcpy(w, carry.regs, carry.count * sizeof(uint16_t));
+            n = carry.count;
+            carry.count = 0;
+        }
+        for (uint32_t a = reg.addr + n; (n < reg.words) && (a < end); a++)
+        {
+            w[n++] = regs[a - start];
+        }
+        if (n < reg.words)
+        {
+            // Continued in the next block
+            carry.addr = reg.addr;
+            carry.count = n;
+            memcpy(carry.regs, w, n * sizeof(uint16_t));
+            continue;
+        }
+
+        uint8_t *target = rec + reg.offset;
+        int32_t s32 = (int32_t)(((uint32_t)w[0] << 16) | (reg.words > 1 ? w[1] : 0));
+        switch (reg.type)
+        {
+        case GW_U16:
+            *reinterpret_cast<int *>(target) = w[0];
+            break;
+        case GW_S32:
+            *reinterpret_cast<int *>(target) = s32;
+            break;
+        case GW_U16F:
+            *reinterpret_cast<float *>(target) = w[0] * reg.scale;
+            break;
+        case GW_S32F:
+            *reinterpret_cast<float *>(target) = s32 * reg.scale;
+            break;
+        case GW_STR:
+            for (uint8_t k = 0; k < reg.words; k++)
+            {
+                target[2 * k] = w[k] >> 8;
+                target[2 * k + 1] = w[k] & 0xff;
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,350 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// growattRegisters.h
+//
+// Declarative Growatt Modbus register map and generic register decoder
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//          Added read planner growatt_plan()
+//          Added per-field TTL (growatt_stale()/growatt_age())
+//          Added family specific input register fields (GROWATT_FAMILY)
+//          Added growatt_select(): map entries of unused fields dropped at compile time
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(GROWATTREGISTERS_H)
+#define GROWATTREGISTERS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "growatt_cfg.h"
+
+/*!
+ * \brief Input register fields (index into growattIF input register map)
+ *
+ * The order must match the map in growattInterface.cpp.
+ * All families share the layout of input registers 0...124; the fields
+ * following GW_WARNINGBITCODE only exist in the selected GROWATT_FAMILY.
+ */
+enum GrowattInputField : uint8_t
+{
+    GW_STATUS,
+    GW_SOLARPOWER,
+    GW_PV1VOLTAGE,
+    GW_PV1CURRENT,
+    GW_PV1POWER,
+    GW_PV2VOLTAGE,
+    GW_PV2CURRENT,
+    GW_PV2POWER,
+    GW_OUTPUTPOWER,
+    GW_GRIDFREQUENCY,
+    GW_GRIDVOLTAGE,
+    GW_ENERGYTODAY,
+    GW_ENERGYTOTAL,
+    GW_TOTALWORKTIME,
+    GW_PV1ENERGYTODAY,
+    GW_PV1ENERGYTOTAL,
+    GW_PV2ENERGYTODAY,
+    GW_PV2ENERGYTOTAL,
+    GW_TEMPINVERTER,
+    GW_TEMPIPM,
+    GW_TEMPBOOST,
+    GW_IPF,
+    GW_REALOPPERCENT,
+    GW_OPFULLPOWER,
+    GW_DERATINGMODE,
+    GW_FAULTCODE,
+    GW_FAULTBITCODE,
+    GW_WARNINGBITCODE,
+#if GROWATT_FAMILY == GW_FAMILY_MOD
+    GW_GRIDVOLTAGE2,   //!< phase 2 grid voltage
+    GW_GRIDVOLTAGE3,   //!< phase 3 grid voltage
+#elif GROWATT_FAMILY == GW_FAMILY_SPH
+    GW_DISCHARGEPOWER, //!< battery discharge power
+    GW_CHARGEPOWER,    //!< battery charge power
+    GW_BATTERYVOLTAGE, //!< battery voltage
+    GW_SOC,            //!< battery state of charge
+#endif
+    GW_NUM_INPUT_FIELDS
+};
+
+/*!
+ * \brief Holding register fields (index into growattIF holding register map)
+ *
+ * The order must match the map in growattInterface.cpp.
+ */
+enum GrowattHoldingField : uint8_t
+{
+    GW_ENABLE,
+    GW_SAFETYFUNCEN,
+    GW_MAXOUTPUTACTIVEPP,
+    GW_MAXOUTPUTREACTIVEPP,
+    GW_MAXPOWER,
+    GW_VOLTNORMAL,
+    GW_FIRMWARE,
+    GW_CONTROLFIRMWARE,
+    GW_STARTVOLTAGE,
+    GW_SERIAL,
+    GW_GRIDVOLTLOWLIMIT,
+    GW_GRIDVOLTHIGHLIMIT,
+    GW_GRIDFREQLOWLIMIT,
+    GW_GRIDFREQHIGHLIMIT,
+    GW_GRIDVOLTLOWCONNLIMIT,
+    GW_GRIDVOLTHIGHCONNLIMIT,
+    GW_GRIDFREQLOWCONNLIMIT,
+    GW_GRIDFREQHIGHCONNLIMIT,
+    GW_MODUL,
+    GW_NUM_HOLDING_FIELDS
+};
+
+//! Field set bit of a GrowattInputField/GrowattHoldingField
+#define GW_FIELD(f) (1UL << (f))
+
+static_assert(GW_NUM_INPUT_FIELDS <= 32, "Input register field set exceeds 32 bits");
+
+//! All input register fields
+#define GW_INPUT_ALL (0xFFFFFFFFUL >> (32 - GW_NUM_INPUT_FIELDS))
+
+//! All holding register fields
+#define GW_HOLDING_ALL (0xFFFFFFFFUL >> (32 - GW_NUM_HOLDING_FIELDS))
+
+//! Max. width of a field [registers]
+#define GW_MAX_FIELD_WORDS 5
+
+//! Max. no. of registers per read request
+//! (Modbus allows 125, limited by the ModbusMaster response buffer)
+#if !defined(GROWATT_READ_MAX)
+#define GROWATT_READ_MAX 64
+#endif
+
+//! Max. no. of unused registers between two fields which are still read in one request
+//! (at 9600 baud, a register costs ~2.3 ms on the wire, a separate request
+//! costs ~15 ms of framing plus inverter turnaround plus the pause between requests)
+#if !defined(GROWATT_READ_GAP)
+#define GROWATT_READ_GAP 40
+#endif
+
+//! Max. no. of read requests in a plan
+#define GW_MAX_RANGES 8
+
+/*!
+ * \brief Register data type
+ *
+ * Multi-register values are big-endian (high word first), strings
+ * carry two characters per register (first character in the high byte).
+ */
+enum GrowattRegType : uint8_t
+{
+    GW_U16,  //!< unsigned 16 bit -> int
+    GW_S32,  //!< signed 32 bit -> int
+    GW_U16F, //!< unsigned 16 bit, scaled -> float
+    GW_S32F, //!< signed 32 bit, scaled -> float
+    GW_STR   //!< ASCII characters -> char[2 * words]
+};
+
+/*!
+ * \brief Register map entry
+ */
+struct GrowattRegister
+{
+    uint16_t addr;   //!< first register address
+    uint8_t words;   //!< width [registers]
+    uint8_t type;    //!< GrowattRegType
+    uint8_t ttl;     //!< max. age of a cached value [acquisitions] (0: read every time)
+    uint8_t field;   //!< field (bit in field sets, index of field ages; set by growatt_select())
+    double scale;    //!< scale factor (GW_U16F/GW_S32F)
+    uint16_t offset; //!< offset of the target field in the record
+};
+
+//! Age of a field which has not been read yet
+#define GW_AGE_UNKNOWN 0xFF
+
+//! Numeric field (GW_U16/GW_S32) - width is implied by the type
+constexpr GrowattRegister gwInt(uint16_t addr, GrowattRegType type, size_t offset, uint8_t ttl = 0)
+{
+    return GrowattRegister{addr, (uint8_t)(type == GW_S32 ? 2 : 1), (uint8_t)type, ttl, 0, 1.0, (uint16_t)offset};
+}
+
+//! Scaled numeric field (GW_U16F/GW_S32F) - width is implied by the type
+constexpr GrowattRegister gwFloat(uint16_t addr, GrowattRegType type, double scale, size_t offset, uint8_t ttl = 0)
+{
+    return GrowattRegister{addr, (uint8_t)(type == GW_S32F ? 2 : 1), (uint8_t)type, ttl, 0, scale, (uint16_t)offset};
+}
+
+//! String field of <chars> characters
+constexpr GrowattRegister gwString(uint16_t addr, uint8_t chars, size_t offset, uint8_t ttl = 0)
+{
+    return GrowattRegister{addr, (uint8_t)((chars + 1) / 2), (uint8_t)GW_STR, ttl, 0, 0.0, (uint16_t)offset};
+}
+
+/*!
+ * \brief Register map of the fields in a field set
+ *
+ * Generated at compile time by growatt_select(); the entries of all
+ * other fields are not part of the firmware.
+ */
+template <size_t N>
+struct GrowattMap
+{
+    static constexpr size_t size = N; //!< no. of map entries
+    GrowattRegister reg[N];           //!< map entries (in the order of the full map)
+};
+
+//! No. of fields in a field set of a map with <size> entries
+constexpr size_t growatt_count(uint32_t fields, size_t size)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        n += (fields >> i) & 1;
+    }
+    return n;
+}
+
+/*!
+ * \brief Select the entries of the fields in a field set (at compile time)
+ *
+ * \tparam N    no. of selected fields (growatt_count(fields, Size))
+ * \param map    full register map (entry n: field n)
+ * \param fields field set (bit n: map entry n)
+ *
+ * \returns map of the selected entries, each with its field index
+ */
+template <size_t N, size_t Size>
+constexpr GrowattMap<N> growatt_select(const GrowattRegister (&map)[Size], uint32_t fields)
+{
+    static_assert(N > 0, "Empty register map");
+    GrowattMap<N> selected{};
+    size_t n = 0;
+    for (size_t i = 0; (i < Size) && (n < N); i++)
+    {
+        if (fields & GW_FIELD(i))
+        {
+            selected.reg[n] = map[i];
+            selected.reg[n].field = (uint8_t)i;
+            n++;
+        }
+    }
+    return selected;
+}
+
+/*!
+ * \brief Field which spans the end of a register block
+ *
+ * Keeps the part of the field already received until the next block
+ * (replaces decoding by hand across block boundaries).
+ */
+struct GrowattCarry
+{
+    uint16_t addr;                      //!< first register address of the field
+    uint8_t count;                      //!< no. of registers received (0: none)
+    uint16_t regs[GW_MAX_FIELD_WORDS];  //!< registers received
+};
+
+/*!
+ * \brief Get the fields which have to be read
+ *
+ * A field is stale if its age has reached its TTL or if it has not been read yet.
+ *
+ * \param map    register map (see growatt_select())
+ * \param size   no. of map entries
+ * \param fields field set (bit n: field n)
+ * \param age    age of each field [acquisitions]
+ *
+ * \returns stale fields of <fields>
+ */
+uint32_t growatt_stale(const GrowattRegister *map, size_t size, uint32_t fields, const uint8_t *age);
+
+/*!
+ * \brief Update the field ages after an acquisition
+ *
+ * \param size      no. of fields
+ * \param fields    field set of the acquisition
+ * \param refreshed fields read by the acquisition
+ * \param age       age of each field [acquisitions]
+ */
+void growatt_age(size_t size, uint32_t fields, uint32_t refreshed, uint8_t *age);
+
+/*!
+ * \brief Contiguous register range read in a single request
+ */
+struct GrowattRange
+{
+    uint16_t start; //!< first register address
+    uint16_t count; //!< no. of registers
+};
+
+/*!
+ * \brief Plan the read requests for a field set
+ *
+ * Merges the registers of all fields in <fields> into as few contiguous ranges
+ * as possible, each at most <maxCount> registers long; fields separated by
+ * more than <maxGap> unused registers are read by separate requests.
+ *
+ * \param map       register map (see growatt_select())
+ * \param size      no. of map entries
+ * \param fields    field set (bit n: field n)
+ * \param maxCount  max. no. of registers per range
+ * \param maxGap    max. no. of unused registers within a range
+ * \param ranges    planned ranges (ascending addresses)
+ * \param maxRanges size of <ranges>
+ *
+ * \returns no. of ranges
+ */
+uint8_t growatt_plan(const GrowattRegister *map, size_t size, uint32_t fields,
+                     uint16_t maxCount, uint16_t maxGap,
+                     GrowattRange *ranges, uint8_t maxRanges);
+
+/*!
+ * \brief Decode a block of registers into a record
+ *
+ * Decodes all fields in <fields> which overlap the registers [start, start + count).
+ * A field continued in the next block is kept in <carry> and completed when
+ * the next call provides its remaining registers.
+ *
+ * \param map     register map (see growatt_select())
+ * \param size    no. of map entries
+ * \param fields  field set (bit n: field n)
+ * \param start   register address of regs[0]
+ * \param count   no. of registers
+ * \param regs    register values
+ * \param record  target record
+ * \param carry   state for fields spanning block boundaries
+ */
+void growatt_decode(const GrowattRegister *map, size_t size, uint32_t fields,
+                    uint16_t start, uint16_t count, const uint16_t *regs,
+                    void *record, GrowattCarry &carry);
+
+#endif // GROWATTREGISTERS_H
@@ -35,11 +35,38 @@
 //
 // 20240709 Copied from growatt2lorawan-v2
 // 20240710 Added support for Seeed Studio XIAO ESP32S3 & Wio-SX1262
+// 20261017 Added ENABLE_TRACE
+//          Added TIMING_INTERVAL and DIAG_INTERVAL
+//          Added GROWATT_INPUT_FIELDS
+//          Added GROWATT_TTL_SLOW and GROWATT_TTL_STATIC
+//          Added MODBUS_SETTLE_TIME, MODBUS_RESPONSE_TIMEOUT and MODBUS_BACKOFF
+//          Added MODBUS_UART_EVENTS
+//          Added MODBUS_RS485_HALF_DUPLEX
+//          Added GROWATT_SLAVE_IDS and GROWATT_MAX_INVERTERS
+//          Added GROWATT_FAMILY and GROWATT_FAMILY_FIELDS
+//          Added GROWATT_SETTINGS_NVS and GROWATT_SETTINGS_FIELDS
+//          Added MODBUS_BREAKER_THRESHOLD and MODBUS_PROBE_TIMEOUT
+//          Added EXPORT_LIMIT_TARGET, EXPORT_LIMIT_HYSTERESIS and EXPORT_LIMIT_MAXPOWER
+//          Added MODBUS_CAPTURE
+//          Added PAYLOAD_FORMAT
+//          Added PAYLOAD_FORMAT 3 and PAYLOAD_KEYFRAME_INTERVAL
+//          MODBUS_SETTLE_TIME and MODBUS_BACKOFF defaults restored to the former delays (500/1000 ms)
+//          Added PAYLOAD_ACK_TIMEOUT
+//          GROWATT_INPUT_FIELDS selects the input register map entries at compile time
+//          Added RTC_DATA_ATTR fallback for ESP8266
 //
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <stdint.h>
 
+// State kept across deep sleep (register caches, circuit breaker, keyframes, timing/diag statistics,
+// trace ring) is placed in RTC memory by RTC_DATA_ATTR (ESP32). The ESP8266 core has no such
+// attribute and restarts from reset after deep sleep - the state is kept in normal RAM and is
+// lost, i.e. each wake cycle starts cold.
+#if defined(ESP8266) && !defined(RTC_DATA_ATTR)
+#define RTC_DATA_ATTR
+#endif
+
 //#define useModulPower   1
 
 //#define ENABLE_JSON
@@ -47,10 +74,116 @@
 //#define SERIAL_RATE     115200    // Serial speed for status info
 //#define MODBUS_RATE     9600      // Modbus speed of Growatt, do not change
 
+// Slave IDs of the inverters sharing the RS485 bus, e.g. {1, 2, 3};
+// each inverter's data is sent in a separate frame (see FrameCodec::dataPort())
+#if !defined(GROWATT_SLAVE_IDS)
+#define GROWATT_SLAVE_IDS     {1}
+#endif
+#define GROWATT_MAX_INVERTERS 4   // max. no. of inverters (register caches in RTC memory; max. 16)
+
 #define UPDATE_MODBUS   2         // Modbus device is read every <n> seconds
 #define MODBUS_RETRIES  5         // no. of modbus retries
+#define MODBUS_SETTLE_TIME      500   // min. time from Modbus interface init to first request [ms]
+#define MODBUS_RESPONSE_TIMEOUT 2000  // max. time from end of request to complete response [ms]
+#define MODBUS_BACKOFF         1000   // pause before repeating a failed request [ms]
+#define MODBUS_BREAKER_THRESHOLD  2   // consecutive response timeouts which open the circuit breaker
+                                      // (0: disabled); while open, a single probe request is sent
+#define MODBUS_PROBE_TIMEOUT    100   // max. time from end of probe request to start of response [ms]
+//#define MODBUS_UART_EVENTS            // ESP32: end of response detected by UART RX timeout,
+                                        // frame handled in UART event task (instead of polling)
+//#define MODBUS_RS485_HALF_DUPLEX      // ESP32: RS485 transceiver DE and RE switched by the UART (RTS)
+                                        // on the stop bit (instead of digitalWrite() around each request)
+//#define MODBUS_CAPTURE                // raw Modbus transactions with µs timestamps in a RAM ring, dumped
+                                        // before deep sleep (see growattIF::dumpCapture())
 //#define EMULATE_SENSORS
 
+// Inverter family - selects the register map (see growattRegisters.h) and payload
+#define GW_FAMILY_MIC 1               // MIC/MIN single-phase
+#define GW_FAMILY_MOD 2               // MOD/MAX three-phase
+#define GW_FAMILY_SPH 3               // SPH hybrid with battery
+#if !defined(GROWATT_FAMILY)
+#define GROWATT_FAMILY GW_FAMILY_MIC
+#endif
+
+// Family specific input register fields, encoded by AppLayer::getFamilyPayload()
+// and sent in a separate frame following the data frame (FrameCodec::PortFamily)
+#if GROWATT_FAMILY == GW_FAMILY_MOD
+#define GROWATT_FAMILY_FIELDS (GW_FIELD(GW_GRIDVOLTAGE2) | GW_FIELD(GW_GRIDVOLTAGE3))
+#elif GROWATT_FAMILY == GW_FAMILY_SPH
+#define GROWATT_FAMILY_FIELDS (GW_FIELD(GW_DISCHARGEPOWER) | GW_FIELD(GW_CHARGEPOWER) | \
+                               GW_FIELD(GW_BATTERYVOLTAGE) | GW_FIELD(GW_SOC))
+#else
+#define GROWATT_FAMILY_FIELDS 0
+#endif
+
+// Input register fields encoded by AppLayer::getPayloadStage2() (see growattRegisters.h)
+#define GROWATT_PORT1_FIELDS (GW_FIELD(GW_STATUS) | GW_FIELD(GW_FAULTCODE) | GW_FIELD(GW_ENERGYTODAY) | \
+                              GW_FIELD(GW_ENERGYTOTAL) | GW_FIELD(GW_TOTALWORKTIME) | GW_FIELD(GW_OUTPUTPOWER) | \
+                              GW_FIELD(GW_GRIDVOLTAGE) | GW_FIELD(GW_GRIDFREQUENCY) | GW_FIELD(GW_TEMPINVERTER))
+#define GROWATT_PORT2_FIELDS (GW_FIELD(GW_PV1VOLTAGE) | GW_FIELD(GW_PV1CURRENT) | GW_FIELD(GW_PV1POWER) | \
+                              GW_FIELD(GW_TEMPINVERTER) | GW_FIELD(GW_TEMPIPM) | GW_FIELD(GW_PV1ENERGYTODAY) | \
+                              GW_FIELD(GW_PV1ENERGYTOTAL))
+
+// Data frame payload format (see AppLayer::getPayloadStage2())
+// 1: values as float (29 bytes)
+// 2: values as scaled integers with the register's resolution, led by FrameCodec::FormatV2 (23 bytes)
+// 3: as 2, but the frames contain the differences to a keyframe (absolute values, see PayloadCodec.h)
+//    acknowledged by the receiver; a keyframe is sent until the receiver has acknowledged it and
+//    at least every PAYLOAD_KEYFRAME_INTERVAL'th frame
+// The receiver decodes all formats.
+#if !defined(PAYLOAD_FORMAT)
+#define PAYLOAD_FORMAT 2
+#endif
+#define PAYLOAD_KEYFRAME_INTERVAL 10
+
+// Payload format 3: time the transmitter listens for the receiver's keyframe acknowledgement after
+// its last frame [ms]; only while a keyframe is unacknowledged. The receiver sends the
+// acknowledgement RX_FOLLOWUP_TIMEOUT (1000 ms) after the last data frame of the wake cycle
+// (the follow-up timeout is restarted by each new data frame).
+#define PAYLOAD_ACK_TIMEOUT 1500
+
+// Input register fields decoded by growattIF::ReadInputRegisters();
+// the register map entries of all other fields are dropped at compile time, these fields remain 0
+#if defined(ENABLE_JSON)
+#define GROWATT_INPUT_FIELDS GW_INPUT_ALL
+#else
+#define GROWATT_INPUT_FIELDS (GROWATT_PORT1_FIELDS | GROWATT_PORT2_FIELDS | GROWATT_FAMILY_FIELDS)
+#endif
+
+// Register cache in RTC memory: max. age of cached values [Modbus acquisitions, i.e. wake cycles]
+// (0: read every cycle)
+// slow-changing values - energy totals, total work time, power limits
+#define GROWATT_TTL_SLOW   10
+// (almost) constant values - firmware, serial number, grid limits
+#define GROWATT_TTL_STATIC 240
+
+// Holding register snapshot (firmware, serial no., grid limits) in NVS - survives power loss,
+// written only if it has changed; the settings are re-read at power-on, every GROWATT_TTL_STATIC
+// cycles and if the inverter's fault code or derating mode has changed (ESP32 Preferences)
+#define GROWATT_SETTINGS_NVS
+// Holding register fields of the snapshot
+#define GROWATT_SETTINGS_FIELDS (GW_HOLDING_ALL & ~(GW_FIELD(GW_ENABLE) | GW_FIELD(GW_MAXOUTPUTACTIVEPP) | \
+                                                   GW_FIELD(GW_MAXOUTPUTREACTIVEPP)))
+
+// Export limiter (see ExportLimiter.h) - closed-loop limitation of the power fed into the grid
+// by writing the inverter's active power limit (holding register maxoutputactivepp)
+#define EXPORT_LIMIT_TARGET     0     // default max. export [W] (0: zero export)
+#define EXPORT_LIMIT_HYSTERESIS 2     // min. change of the power limit which is written [%]
+#define EXPORT_LIMIT_MAXPOWER   0     // nominal power [W] (0: from the inverter's settings snapshot)
+
+// Timing telemetry (see utils/timing.h): summary of the last <n> wake cycles
+// is sent on port 3 (FrameCodec::PortTiming) every <n> cycles (0: disabled)
+#define TIMING_INTERVAL 10
+
+// Heap/stack diagnostics (see utils/diag.h): minimum values of the last <n> wake cycles
+// are sent on port 4 (FrameCodec::PortDiag) by the transmitter and published
+// to <hostname>/diag by the receiver every <n> cycles (0: disabled)
+#define DIAG_INTERVAL 10
+
+// Binary trace of the wake cycle in RTC memory (see utils/trace.h),
+// dumped before deep sleep; decode with extras/host/tools/gw_trace
+//#define ENABLE_TRACE
+
 // Debug printing
 // To enable debug mode (debug messages via serial port):
 // Arduino IDE: Tools->Core Debug Level: "Debug|Verbose"
@@ -0,0 +1,163 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// diag.cpp
+//
+// Heap, stack and static RAM diagnostics
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "diag.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#define DIAG_MAGIC 0x44494731 // "DIG1"
+
+// Start and end of .data and .bss (provided by the linker)
+#if defined(ESP32) || defined(ESP8266)
+extern "C" char _data_start[], _bss_end[];
+#define STATIC_RAM_START _data_start
+#define STATIC_RAM_END _bss_end
+#else
+extern "C" char __data_start[], _end[];
+#define STATIC_RAM_START __data_start
+#define STATIC_RAM_END _end
+#endif
+
+struct DiagStore
+{
+    uint32_t magic;
+    DiagRecord rec;
+};
+
+RTC_DATA_ATTR static DiagStore diagStore;
+
+const char *diag_point_name(uint8_t point)
+{
+    static const char *const names[DIAG_NUM_POINTS] = {
+        "wake", "modbus", "radio", "decode", "mqtt", "sleep"};
+
+    return (point < DIAG_NUM_POINTS) ? names[point] : "?";
+}
+
+void diag_begin(void)
+{
+    if (diagStore.magic != DIAG_MAGIC)
+    {
+        diag_reset();
+        diagStore.magic = DIAG_MAGIC;
+    }
+    diagStore.rec.cycles++;
+    diagStore.rec.staticRam = STATIC_RAM_END - STATIC_RAM_START;
+    diag_sample(DIAG_WAKE);
+}
+
+void diag_sample(DiagPoint point)
+{
+    DiagRecord &rec = diagStore.rec;
+    uint32_t minFreeHeap;
+    uint32_t maxAlloc;
+    uint32_t stackFree;
+
+#if defined(ESP32)
+    rec.freeHeap = ESP.getFreeHeap();
+    minFreeHeap = ESP.getMinFreeHeap();
+    maxAlloc = ESP.getMaxAllocHeap();
+    stackFree = uxTaskGetStackHighWaterMark(NULL);
+#elif defined(ESP8266)
+    rec.freeHeap = ESP.getFreeHeap();
+    minFreeHeap = rec.freeHeap;
+    maxAlloc = ESP.getMaxFreeBlockSize();
+    stackFree = ESP.getFreeContStack();
+#else
+    rec.freeHeap = ESP.getFreeHeap();
+    minFreeHeap = ESP.getMinFreeHeap();
+    maxAlloc = ESP.getMaxAllocHeap();
+    stackFree = UINT32_MAX; // not available (reported as 0)
+#endif
+
+    if (minFreeHeap < rec.minFreeHeap)
+    {
+        rec.minFreeHeap = minFreeHeap;
+    }
+    if (maxAlloc < rec.minMaxAlloc)
+    {
+        rec.minMaxAlloc = maxAlloc;
+        rec.minPoint = point;
+    }
+    if (stackFree < rec.minStackFree)
+    {
+        rec.minStackFree = stackFree;
+    }
+    log_d("Diag @%s: heap %lu, min %lu, block %lu, stack %lu", diag_point_name(point), (unsigned long)rec.freeHeap,
+          (unsigned long)minFreeHeap, (unsigned long)maxAlloc, (unsigned long)stackFree);
+}
+
+bool diag_report_due(void)
+{
+    return (DIAG_INTERVAL > 0) && (diagStore.rec.cycles >= DIAG_INTERVAL);
+}
+
+const DiagRecord &diag_record(void)
+{
+    return diagStore.rec;
+}
+
+void diag_reset(void)
+{
+    DiagRecord &rec = diagStore.rec;
+    rec.minFreeHeap = UINT32_MAX;
+    rec.minMaxAlloc = UINT32_MAX;
+    rec.minStackFree = UINT32_MAX;
+    rec.minPoint = DIAG_WAKE;
+    rec.cycles = 0;
+}
+
+size_t diag_json(const DiagRecord &rec, char *buf, size_t size)
+{
+    int n = snprintf(buf, size,
+                     "{\"cycles\":%u,\"heap\":%lu,\"heap_min\":%lu,\"block_min\":%lu,\"at\":\"%s\","
+                     "\"stack_min\":%lu,\"static\":%lu}",
+                     rec.cycles, (unsigned long)rec.freeHeap, (unsigned long)rec.minFreeHeap,
+                     (unsigned long)rec.minMaxAlloc, diag_point_name(rec.minPoint),
+                     (rec.minStackFree == UINT32_MAX) ? 0UL : (unsigned long)rec.minStackFree,
+                     (unsigned long)rec.staticRam);
+    return (n < 0) ? 0 : min((size_t)n, size - 1);
+}
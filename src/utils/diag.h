@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// diag.h
+//
+// Heap, stack and static RAM diagnostics
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#if !defined(DIAG_H)
+#define DIAG_H
+
+#include <Arduino.h>
+#include "../growatt_cfg.h"
+
+/*!
+ * \brief Sampling points
+ *
+ * Append new points only - the receiver decodes transmitter records by number.
+ */
+enum DiagPoint : uint8_t
+{
+    DIAG_WAKE,    //!< wake-up
+    DIAG_MODBUS,  //!< after Modbus acquisition (transmitter)
+    DIAG_RADIO,   //!< after radio init (transmitter) / reception (receiver)
+    DIAG_DECODE,  //!< after decoding and JSON serialization (receiver)
+    DIAG_MQTT,    //!< after WiFi/MQTT setup (receiver)
+    DIAG_SLEEP,   //!< before deep sleep
+    DIAG_NUM_POINTS
+};
+
+/*!
+ * \brief Diagnostic record
+ *
+ * Minimum values since the last report; kept in RTC memory across deep sleep.
+ */
+struct DiagRecord
+{
+    uint32_t freeHeap;     //!< free heap at last sample [bytes]
+    uint32_t minFreeHeap;  //!< min. free heap [bytes]
+    uint32_t minMaxAlloc;  //!< min. largest free heap block [bytes]
+    uint32_t minStackFree; //!< min. unused stack of the current (loop) task [bytes]
+    uint32_t staticRam;    //!< static RAM (.data + .bss) [bytes]
+    uint8_t minPoint;      //!< DiagPoint with min. largest free block
+    uint8_t cycles;        //!< wake cycles since last report
+};
+
+/*!
+ * \brief Get sampling point name
+ *
+ * \param point sampling point
+ *
+ * \returns name or "?"
+ */
+const char *diag_point_name(uint8_t point);
+
+/*!
+ * \brief Start diagnostics after wake-up
+ *
+ * Initializes the record in RTC memory after power-on and samples DIAG_WAKE.
+ */
+void diag_begin(void);
+
+/*!
+ * \brief Sample heap and stack usage
+ *
+ * \param point sampling point
+ */
+void diag_sample(DiagPoint point);
+
+/*!
+ * \brief Check if a diagnostic report is due
+ *
+ * \returns true if DIAG_INTERVAL cycles have been started since the last report
+ */
+bool diag_report_due(void);
+
+/// Get diagnostic record
+const DiagRecord &diag_record(void);
+
+/// Reset record (after report)
+void diag_reset(void);
+
+/*!
+ * \brief Write record as JSON string
+ *
+ * Example:
+ * {"cycles":10,"heap":241112,"heap_min":239880,"block_min":110580,"at":"mqtt","stack_min":5120,"static":25640}
+ *
+ * \param rec diagnostic record
+ * \param buf output buffer
+ * \param size output buffer size
+ *
+ * \returns number of characters written (excl. terminating null)
+ */
+size_t diag_json(const DiagRecord &rec, char *buf, size_t size);
+
+#endif // DIAG_H
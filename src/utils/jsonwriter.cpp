@@ -0,0 +1,201 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// jsonwriter.cpp
+//
+// Single-pass JSON object writer into a caller-provided buffer
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//          Fixed point values rounded in single precision by llroundf()
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include "jsonwriter.h"
+
+static const uint32_t pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+JsonWriter::JsonWriter(char *buf, size_t size)
+    : _buf(buf), _size(size), _len(0), _first(true), _overflow(false)
+{
+    put('{');
+}
+
+void JsonWriter::put(char c)
+{
+    // Keep space for the terminating NUL
+    if (_len + 1 < _size)
+    {
+        _buf[_len++] = c;
+    }
+    else
+    {
+        _overflow = true;
+    }
+}
+
+void JsonWriter::putKey(const char *key)
+{
+    if (!_first)
+    {
+        put(',');
+    }
+    _first = false;
+    put('"');
+    while (*key)
+    {
+        put(*key++);
+    }
+    put('"');
+    put(':');
+}
+
+void JsonWriter::putUint(uint64_t value, uint8_t minDigits)
+{
+    char digits[20];
+    uint8_t n = 0;
+
+    do
+    {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value || n < minDigits);
+    while (n)
+    {
+        put(digits[--n]);
+    }
+}
+
+void JsonWriter::add(const char *key, int32_t value)
+{
+    putKey(key);
+    if (value < 0)
+    {
+        put('-');
+    }
+    putUint(value < 0 ? -(int64_t)value : value, 1);
+}
+
+void JsonWriter::add(const char *key, float value, uint8_t decimals)
+{
+    putKey(key);
+    if (decimals > 6)
+    {
+        decimals = 6;
+    }
+    // Single precision only (the ESP32's FPU has no double arithmetic);
+    // llroundf() since long is only 32 bits wide
+    float scaled = value * pow10[decimals];
+    if (!(fabsf(scaled) < 1e18f))
+    {
+        // NaN, infinite or out of range
+        put('n');
+        put('u');
+        put('l');
+        put('l');
+        return;
+    }
+    int64_t rounded = llroundf(scaled);
+    if (rounded < 0)
+    {
+        put('-');
+    }
+    uint64_t fixed = (rounded < 0) ? -rounded : rounded;
+    putUint(fixed / pow10[decimals], 1);
+    if (decimals)
+    {
+        put('.');
+        putUint(fixed % pow10[decimals], decimals);
+    }
+}
+
+void JsonWriter::add(const char *key, const char *str, size_t maxLen)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    putKey(key);
+    put('"');
+    for (size_t i = 0; (i < maxLen) && str[i]; i++)
+    {
+        uint8_t c = str[i];
+        if ((c == '"') || (c == '\\'))
+        {
+            put('\\');
+            put(c);
+        }
+        else if (c < 0x20)
+        {
+            put('\\');
+            put('u');
+            put('0');
+            put('0');
+            put(hex[c >> 4]);
+            put(hex[c & 0xF]);
+        }
+        else
+        {
+            put(c);
+        }
+    }
+    put('"');
+}
+
+void JsonWriter::addHex(const char *key, uint32_t value, uint8_t digits)
+{
+    static const char hex[] = "0123456789ABCDEF";
+
+    putKey(key);
+    put('"');
+    for (int i = ((digits > 8) ? 8 : digits) - 1; i >= 0; i--)
+    {
+        put(hex[(value >> (4 * i)) & 0xF]);
+    }
+    put('"');
+}
+
+size_t JsonWriter::end(void)
+{
+    put('}');
+    if (_size == 0)
+    {
+        return 0;
+    }
+    if (_overflow)
+    {
+        _buf[0] = '\0';
+        return 0;
+    }
+    _buf[_len] = '\0';
+    return _len;
+}
@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// jsonwriter.h
+//
+// Single-pass JSON object writer into a caller-provided buffer
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(JSONWRITER_H)
+#define JSONWRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*!
+ * \brief Flat JSON object writer
+ *
+ * Appends the members to the buffer in a single pass - never writes beyond
+ * the buffer and does not allocate memory. Numbers are formatted as fixed
+ * point values without printf().
+ *
+ * Example:
+ *
+ *   JsonWriter writer(buf, sizeof(buf));
+ *   writer.add("status", 1);
+ *   writer.add("outputpower", 600.0f, 1);
+ *   writer.end(); // {"status":1,"outputpower":600.0}
+ */
+class JsonWriter
+{
+public:
+    /*!
+     * \brief Start a JSON object
+     *
+     * \param buf  output buffer
+     * \param size size of <buf> incl. terminating NUL
+     */
+    JsonWriter(char *buf, size_t size);
+
+    /*!
+     * \brief Add integer member
+     */
+    void add(const char *key, int32_t value);
+
+    /*!
+     * \brief Add fixed point member
+     *
+     * \param key      key
+     * \param value    value (NaN, infinite or |value * 10^decimals| >= 1e18: null)
+     * \param decimals no. of decimal places (max. 6)
+     */
+    void add(const char *key, float value, uint8_t decimals);
+
+    /*!
+     * \brief Add string member
+     *
+     * \param key    key
+     * \param str    characters (need not be NUL terminated if <maxLen> is given)
+     * \param maxLen max. no. of characters
+     */
+    void add(const char *key, const char *str, size_t maxLen = SIZE_MAX);
+
+    /*!
+     * \brief Add hexadecimal string member, e.g. "0006"
+     *
+     * \param key    key
+     * \param value  value
+     * \param digits no. of hex digits (max. 8)
+     */
+    void addHex(const char *key, uint32_t value, uint8_t digits);
+
+    /*!
+     * \brief End the JSON object
+     *
+     * \returns length of the JSON string or 0 if the buffer was too small
+     *          (the buffer then contains an empty string)
+     */
+    size_t end(void);
+
+    /*!
+     * \brief Check if the buffer was too small
+     */
+    bool overflow(void) const
+    {
+        return _overflow;
+    };
+
+private:
+    char *_buf;
+    size_t _size;
+    size_t _len;
+    bool _first;
+    bool _overflow;
+
+    void put(char c);
+    void putKey(const char *key);
+    void putUint(uint64_t value, uint8_t minDigits);
+};
+
+#endif // JSONWRITER_H
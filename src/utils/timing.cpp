@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// timing.cpp
+//
+// Wake cycle phase timing statistics in RTC memory
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "timing.h"
+
+#define TIMING_MAGIC 0x54494D31 // "TIM1"
+
+// Statistics of completed cycles; kept in RTC memory across deep sleep
+struct TimingStore
+{
+    uint32_t magic;
+    uint16_t cycles;
+    uint16_t retries;
+    TimingStat stat[TIMING_NUM_PHASES];
+};
+
+RTC_DATA_ATTR static TimingStore timingStore;
+
+// Current cycle
+static TimingStat timingCur[TIMING_NUM_PHASES];
+static uint16_t timingCurRetries;
+
+static void timing_merge(TimingStat &dst, const TimingStat &src)
+{
+    dst.sum += src.sum;
+    if (src.max > dst.max)
+    {
+        dst.max = src.max;
+    }
+    dst.count += src.count;
+}
+
+void timing_begin(void)
+{
+    if (timingStore.magic != TIMING_MAGIC)
+    {
+        timing_reset();
+        timingStore.magic = TIMING_MAGIC;
+    }
+    memset(timingCur, 0, sizeof(timingCur));
+    timingCurRetries = 0;
+}
+
+void timing_add(TimingPhase phase, uint32_t ms)
+{
+    TimingStat &s = timingCur[phase];
+    s.sum += ms;
+    if (ms > s.max)
+    {
+        s.max = (ms > UINT16_MAX) ? UINT16_MAX : ms;
+    }
+    s.count++;
+}
+
+void timing_retry(void)
+{
+    timingCurRetries++;
+}
+
+void timing_end(void)
+{
+    timing_add(TIMING_AWAKE, millis());
+    for (int i = 0; i < TIMING_NUM_PHASES; i++)
+    {
+        timing_merge(timingStore.stat[i], timingCur[i]);
+    }
+    timingStore.retries += timingCurRetries;
+    timingStore.cycles++;
+}
+
+bool timing_report_due(void)
+{
+    return (TIMING_INTERVAL > 0) && (timingStore.cycles >= TIMING_INTERVAL);
+}
+
+uint16_t timing_cycles(void)
+{
+    return timingStore.cycles;
+}
+
+uint16_t timing_retries(void)
+{
+    return timingStore.retries;
+}
+
+const TimingStat &timing_stat(TimingPhase phase)
+{
+    return timingStore.stat[phase];
+}
+
+void timing_reset(void)
+{
+    timingStore.cycles = 0;
+    timingStore.retries = 0;
+    memset(timingStore.stat, 0, sizeof(timingStore.stat));
+}
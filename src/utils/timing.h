@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// timing.h
+//
+// Wake cycle phase timing statistics in RTC memory
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//          Updated Modbus phase descriptions for non-blocking acquisition
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#if !defined(TIMING_H)
+#define TIMING_H
+
+#include <Arduino.h>
+#include "../growatt_cfg.h"
+
+/*!
+ * \brief Wake cycle phases
+ *
+ * Append new phases only - the receiver decodes the timing payload by position.
+ */
+enum TimingPhase : uint8_t
+{
+    TIMING_MODBUS_INIT, //!< initGrowatt()
+    TIMING_MODBUS_READ, //!< single Modbus transaction
+    TIMING_MODBUS,      //!< Modbus acquisition incl. init, back-off and retries
+    TIMING_RADIO_INIT,  //!< radio beginFSK()
+    TIMING_TX,          //!< radio transmit()
+    TIMING_AWAKE,       //!< wake-up until deep sleep
+    TIMING_NUM_PHASES
+};
+
+/*!
+ * \brief Statistics of a phase
+ */
+struct TimingStat
+{
+    uint32_t sum;   //!< sum of durations [ms]
+    uint16_t max;   //!< max. duration [ms]
+    uint16_t count; //!< no. of durations
+};
+
+/*!
+ * \brief Start timing after wake-up
+ *
+ * Initializes the statistics in RTC memory after power-on.
+ */
+void timing_begin(void);
+
+/*!
+ * \brief Add duration of a phase in the current wake cycle
+ *
+ * \param phase phase
+ * \param ms duration [ms]
+ */
+void timing_add(TimingPhase phase, uint32_t ms);
+
+/// Count Modbus read retry in the current wake cycle
+void timing_retry(void);
+
+/*!
+ * \brief End wake cycle
+ *
+ * Adds TIMING_AWAKE (millis()) and merges the current cycle into the statistics.
+ * Call immediately before deep sleep.
+ */
+void timing_end(void);
+
+/*!
+ * \brief Check if a timing report is due
+ *
+ * \returns true if TIMING_INTERVAL cycles have been completed since the last report
+ */
+bool timing_report_due(void);
+
+/// Get no. of completed cycles since the last report
+uint16_t timing_cycles(void);
+
+/// Get no. of Modbus read retries since the last report
+uint16_t timing_retries(void);
+
+/// Get statistics of a phase since the last report
+const TimingStat &timing_stat(TimingPhase phase);
+
+/// Reset statistics (after report)
+void timing_reset(void);
+
+#endif // TIMING_H
@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// trace.cpp
+//
+// Binary trace ring buffer in RTC memory
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "trace.h"
+
+const char *trace_event_name(uint8_t id)
+{
+    static const char *const names[TRACE_NUM_EVENTS] = {
+        "NONE", "WAKE", "MODBUS_INIT", "MODBUS_READ", "PAYLOAD", "RADIO_INIT",
+        "TX_FRAME", "TX_DONE", "RX_FRAME", "DECODE", "SLEEP"};
+
+    return (id < TRACE_NUM_EVENTS) ? names[id] : "?";
+}
+
+#if defined(ENABLE_TRACE)
+
+#define TRACE_MAGIC 0x54524331 // "TRC1"
+
+// Ring buffer; kept in RTC memory across deep sleep
+struct TraceRing
+{
+    uint32_t magic;
+    uint32_t wakeCount;
+    uint32_t lost;
+    uint16_t head;    // next record to be written
+    uint16_t pending; // records not dumped yet
+    TraceRecord rec[TRACE_RING_SIZE];
+};
+
+RTC_DATA_ATTR static TraceRing traceRing;
+
+void trace_begin(void)
+{
+    if (traceRing.magic != TRACE_MAGIC)
+    {
+        memset(&traceRing, 0, sizeof(traceRing));
+        traceRing.magic = TRACE_MAGIC;
+    }
+    traceRing.wakeCount++;
+    trace_record(TRACE_WAKE, &traceRing.wakeCount, sizeof(traceRing.wakeCount));
+}
+
+void trace_record(uint8_t id, const void *data, uint8_t size)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    uint32_t time = micros();
+
+    do
+    {
+        TraceRecord &rec = traceRing.rec[traceRing.head];
+        uint8_t n = (size > TraceRecord::DataSize) ? TraceRecord::DataSize : size;
+
+        rec.time = time;
+        rec.id = id;
+        rec.info = n | ((size > n) ? TraceRecord::More : 0);
+        memcpy(rec.data, p, n);
+        p += n;
+        size -= n;
+
+        traceRing.head = (traceRing.head + 1) % TRACE_RING_SIZE;
+        if (traceRing.pending < TRACE_RING_SIZE)
+        {
+            traceRing.pending++;
+        }
+        else
+        {
+            traceRing.lost++;
+        }
+    } while (size);
+}
+
+unsigned trace_dump(Print &out)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    // "TRACE: " + 12 x "XX " + "\r\n"
+    char line[7 + 3 * sizeof(TraceRecord) + 2];
+    unsigned count = traceRing.pending;
+    unsigned idx = (traceRing.head + TRACE_RING_SIZE - count) % TRACE_RING_SIZE;
+
+    memcpy(line, "TRACE: ", 7);
+    for (unsigned i = 0; i < count; i++)
+    {
+        const uint8_t *rec = reinterpret_cast<const uint8_t *>(&traceRing.rec[idx]);
+        char *p = &line[7];
+        for (size_t b = 0; b < sizeof(TraceRecord); b++)
+        {
+            *p++ = hex[rec[b] >> 4];
+            *p++ = hex[rec[b] & 0xF];
+            *p++ = ' ';
+        }
+        *p++ = '\r';
+        *p++ = '\n';
+        out.write(reinterpret_cast<const uint8_t *>(line), p - line);
+        idx = (idx + 1) % TRACE_RING_SIZE;
+    }
+    traceRing.pending = 0;
+    return count;
+}
+
+uint32_t trace_lost(void)
+{
+    return traceRing.lost;
+}
+
+#endif // ENABLE_TRACE
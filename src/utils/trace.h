@@ -0,0 +1,165 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// trace.h
+//
+// Binary trace ring buffer in RTC memory
+//
+// https://github.com/matthias-bs/growatt2radio
+//
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2026 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(TRACE_H)
+#define TRACE_H
+
+#include <Arduino.h>
+#include "../growatt_cfg.h"
+
+/*!
+ * \brief Trace event IDs
+ *
+ * Append new IDs only - the host side decoder (extras/host/tools/gw_trace)
+ * relies on the numbering.
+ */
+enum TraceEventId : uint8_t
+{
+    TRACE_NONE = 0,
+    TRACE_WAKE,        //!< wake-up; data: wake count (uint32)
+    TRACE_MODBUS_INIT, //!< Modbus interface initialized
+    TRACE_MODBUS_READ, //!< register block read; data: result (uint8), retry (uint8)
+    TRACE_PAYLOAD,     //!< payload encoded; data: port (uint8), size (uint8)
+    TRACE_RADIO_INIT,  //!< radio initialized; data: RadioLib state (int16)
+    TRACE_TX_FRAME,    //!< frame to be transmitted; data: frame bytes
+    TRACE_TX_DONE,     //!< transmission completed; data: RadioLib state (int16)
+    TRACE_RX_FRAME,    //!< frame received; data: frame bytes
+    TRACE_DECODE,      //!< frame decoded; data: DecodeStatus (uint8)
+    TRACE_SLEEP,       //!< entering deep sleep; data: sleep time in s (uint32)
+    TRACE_NUM_EVENTS
+};
+
+/*!
+ * \brief Trace record (12 bytes)
+ *
+ * Data exceeding TraceRecord::DataSize bytes is split into several records;
+ * all but the last one have TraceRecord::More set in info.
+ */
+struct TraceRecord
+{
+    static const uint8_t DataSize = 6;    //!< max. data size per record
+    static const uint8_t SizeMask = 0x0F; //!< info: data size in this record
+    static const uint8_t More = 0x80;     //!< info: data continues in next record
+
+    uint32_t time; //!< micros() since wake-up, little endian
+    uint8_t id;    //!< TraceEventId
+    uint8_t info;  //!< data size and flags
+    uint8_t data[DataSize];
+};
+static_assert(sizeof(TraceRecord) == 12, "TraceRecord layout must not change");
+
+/*!
+ * \brief Get trace event name
+ *
+ * \param id event ID
+ *
+ * \returns event name or "?"
+ */
+const char *trace_event_name(uint8_t id);
+
+#if defined(ENABLE_TRACE)
+
+#if !defined(TRACE_RING_SIZE)
+#define TRACE_RING_SIZE 128 // no. of records (12 bytes each) in RTC memory
+#endif
+
+/*!
+ * \brief Start tracing after wake-up
+ *
+ * Initializes the ring buffer after power-on and records TRACE_WAKE.
+ */
+void trace_begin(void);
+
+/*!
+ * \brief Record event
+ *
+ * \param id event ID
+ * \param data event data
+ * \param size data size in bytes (split into several records if required)
+ */
+void trace_record(uint8_t id, const void *data, uint8_t size);
+
+/*!
+ * \brief Dump records which have not been dumped yet
+ *
+ * One line per record: "TRACE: <12 bytes hex>"
+ * Use extras/host/tools/gw_trace to convert the dump to text.
+ *
+ * \param out output stream
+ *
+ * \returns number of records dumped
+ */
+unsigned trace_dump(Print &out);
+
+/// Get number of records lost due to ring buffer overrun (not dumped in time)
+uint32_t trace_lost(void);
+
+#define TRACE_BEGIN() trace_begin()
+#define TRACE(id) trace_record(id, nullptr, 0)
+#define TRACE_VAL(id, val)                                  \
+    do                                                      \
+    {                                                       \
+        const auto _trace_val = (val);                      \
+        trace_record(id, &_trace_val, sizeof(_trace_val));  \
+    } while (0)
+#define TRACE_BYTES(id, ...)                                \
+    do                                                      \
+    {                                                       \
+        const uint8_t _trace_data[] = {__VA_ARGS__};        \
+        trace_record(id, _trace_data, sizeof(_trace_data)); \
+    } while (0)
+#define TRACE_DATA(id, data, size) trace_record(id, data, size)
+#define TRACE_DUMP(out) trace_dump(out)
+
+#else
+
+// Trace points compile to nothing
+#define TRACE_BEGIN() do {} while (0)
+#define TRACE(id) do {} while (0)
+#define TRACE_VAL(id, val) do {} while (0)
+#define TRACE_BYTES(id, ...) do {} while (0)
+#define TRACE_DATA(id, data, size) do {} while (0)
+#define TRACE_DUMP(out) do {} while (0)
+
+#endif // ENABLE_TRACE
+
+#endif // TRACE_H
@@ -35,6 +35,8 @@
 // History:
 //
 // 20250709 Created from https://github.com/matthias-bs/growatt2lorawan-v2
+// 20261017 Kept bit-serial lfsr_digest16() as reference for table-driven variant
+//          log_message(): build lines in a single pass instead of sprintf()/strlen() per byte
 //
 // ToDo:
 // -
@@ -72,36 +74,46 @@ uint16_t lfsr_digest16(uint8_t const message[], unsigned bytes, uint16_t gen, ui
 
 #if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
 // Log message payload
+// Each line is built in a single pass; bytes exceeding the line buffer are omitted.
 void log_message(const char *descr, const uint8_t *msg, uint8_t msgSize)
 {
+    static const char hex[] = "0123456789ABCDEF";
     char buf[255];
+    char *const end = &buf[sizeof(buf)];
     const char txt[] = "Byte #: ";
-    int offs;
-    int len1 = strlen(txt);
+    int len1 = sizeof(txt) - 1;
     int len2 = strlen(descr) + 2; // add colon and space
     int prefix_len = max(len1, len2);
+    char *p;
+    size_t n;
 
-    memset(buf, ' ', prefix_len);
-    buf[prefix_len] = '\0';
-    offs = (len1 < len2) ? (len2 - len1) : 0;
-    strcpy(&buf[offs], txt);
+    if (prefix_len > (int)sizeof(buf) - 1)
+    {
+        return;
+    }
 
-    // Print byte index
-    for (size_t i = 0; i < msgSize; i++)
+    // Print byte index (the index line is at least as long as the data line)
+    memset(buf, ' ', prefix_len - len1);
+    p = &buf[prefix_len - len1];
+    memcpy(p, txt, len1);
+    p += len1;
+    for (n = 0; (n < msgSize) && (end - p > 4); n++)
     {
-        sprintf(&buf[strlen(buf)], "%02d ", i);
+        p += snprintf(p, end - p, "%02u ", (unsigned)n);
     }
+    *p = '\0';
     log_d("%s", buf);
 
-    memset(buf, ' ', prefix_len);
-    buf[prefix_len] = '\0';
-    offs = (len1 > len2) ? (len1 - len2) : 0;
-    sprintf(&buf[offs], "%s: ", descr);
-
-    for (size_t i = 0; i < msgSize; i++)
+    memset(buf, ' ', prefix_len - len2);
+    p = &buf[prefix_len - len2];
+    p += snprintf(p, end - p, "%s: ", descr);
+    for (size_t i = 0; i < n; i++)
     {
-        sprintf(&buf[strlen(buf)], "%02X ", msg[i]);
+        *p++ = hex[msg[i] >> 4];
+        *p++ = hex[msg[i] & 0xF];
+        *p++ = ' ';
     }
+    *p = '\0';
     log_d("%s", buf);
 }
 #else
@@ -35,6 +35,7 @@
 // History:
 //
 // 20250709 Created from https://github.com/matthias-bs/growatt2lorawan-v2
+// 20261017 Added table-driven lfsr_digest16<gen, key>() with compile-time generated tables
 //
 // ToDo:
 // -
@@ -45,8 +46,146 @@
 #define UTILS_H 
 #include <Arduino.h>
 
+/*!
+ * \brief LFSR-16 digest (bit-serial reference implementation)
+ *
+ * From rtl_433 project - https://github.com/merbanan/rtl_433/blob/master/src/util.c
+ *
+ * Kept as reference for lfsr_digest16<gen, key>(); both must yield identical results.
+ *
+ * \param message  Message buffer.
+ * \param bytes    Number of bytes.
+ * \param gen      Generator polynomial.
+ * \param key      Initial key.
+ *
+ * \returns digest
+ */
 uint16_t lfsr_digest16(uint8_t const message[], unsigned bytes, uint16_t gen, uint16_t key);
 
+/*!
+ * \brief Lookup table for table-driven LFSR-16 digest
+ */
+struct Lfsr16Table
+{
+    uint16_t v[256];
+};
+
+/*!
+ * \brief Roll LFSR-16 key by one bit
+ *
+ * The lsb is dropped and the generator is applied (needs to include the dropped lsb as msb).
+ */
+constexpr uint16_t lfsr16_roll(uint16_t key, uint16_t gen)
+{
+    return (key & 1) ? static_cast<uint16_t>((key >> 1) ^ gen) : static_cast<uint16_t>(key >> 1);
+}
+
+/*!
+ * \brief Generate digest contribution of a single byte for each byte value
+ *
+ * Entry d is lfsr_digest16(&d, 1, gen, key).
+ */
+constexpr Lfsr16Table lfsr16_data_table(uint16_t gen, uint16_t key)
+{
+    Lfsr16Table t{};
+    for (unsigned d = 0; d < 256; ++d)
+    {
+        uint16_t sum = 0;
+        uint16_t k = key;
+        for (int i = 7; i >= 0; --i)
+        {
+            if ((d >> i) & 1)
+                sum ^= k;
+            k = lfsr16_roll(k, gen);
+        }
+        t.v[d] = sum;
+    }
+    return t;
+}
+
+/*!
+ * \brief Generate table for rolling a digest by 8 bits
+ *
+ * Rolling the key is linear, so a digest can be rolled by 8 bits by combining
+ * the entries for its low byte (shift = 0) and high byte (shift = 8).
+ */
+constexpr Lfsr16Table lfsr16_roll8_table(uint16_t gen, unsigned shift)
+{
+    Lfsr16Table t{};
+    for (unsigned b = 0; b < 256; ++b)
+    {
+        uint16_t k = static_cast<uint16_t>(b << shift);
+        for (int i = 0; i < 8; ++i)
+        {
+            k = lfsr16_roll(k, gen);
+        }
+        t.v[b] = k;
+    }
+    return t;
+}
+
+/*!
+ * \brief Table-driven LFSR-16 digest for a fixed (gen, key) pair
+ *
+ * The digest is the XOR of the keys rolled to each set message bit's position.
+ * Evaluating this Horner-style from the last byte to the first gives one
+ * data table lookup and one 8-bit roll (two lookups) per byte:
+ *
+ * sum(k) = data[msg[k]] ^ roll8(sum(k + 1))
+ *
+ * All tables are generated at compile time and placed in flash (3 x 512 bytes).
+ */
+template <uint16_t gen, uint16_t key>
+struct LfsrDigest16
+{
+    static constexpr Lfsr16Table data = lfsr16_data_table(gen, key);
+    static constexpr Lfsr16Table roll8Lo = lfsr16_roll8_table(gen, 0);
+    static constexpr Lfsr16Table roll8Hi = lfsr16_roll8_table(gen, 8);
+
+    /*!
+     * \brief Prepend a byte to a partial digest
+     *
+     * \param sum  Digest of the bytes following b.
+     * \param b    Message byte.
+     *
+     * \returns digest of b and the bytes following it
+     */
+    static inline uint16_t step(uint16_t sum, uint8_t b)
+    {
+        return data.v[b] ^ roll8Lo.v[sum & 0xFF] ^ roll8Hi.v[sum >> 8];
+    }
+};
+
+template <uint16_t gen, uint16_t key>
+constexpr Lfsr16Table LfsrDigest16<gen, key>::data;
+template <uint16_t gen, uint16_t key>
+constexpr Lfsr16Table LfsrDigest16<gen, key>::roll8Lo;
+template <uint16_t gen, uint16_t key>
+constexpr Lfsr16Table LfsrDigest16<gen, key>::roll8Hi;
+
+/*!
+ * \brief LFSR-16 digest (table-driven)
+ *
+ * Yields the same result as lfsr_digest16(message, bytes, gen, key).
+ *
+ * \tparam gen      Generator polynomial.
+ * \tparam key      Initial key.
+ * \param message   Message buffer.
+ * \param bytes     Number of bytes.
+ *
+ * \returns digest
+ */
+template <uint16_t gen, uint16_t key>
+inline uint16_t lfsr_digest16(uint8_t const message[], unsigned bytes)
+{
+    uint16_t sum = 0;
+    while (bytes--)
+    {
+        sum = LfsrDigest16<gen, key>::step(sum, message[bytes]);
+    }
+    return sum;
+}
+
 /*!
  * \brief Log message payload
  *